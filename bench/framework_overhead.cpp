@@ -0,0 +1,324 @@
+#define FUZZ_TEST_SCHEMA_ALLOCATION_TRACKING
+#include "FuzzTestSchema.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <functional>
+#include <memory>
+
+/**
+ * 框架开销基准：所有执行者都是空的，测得的时间、内存分配和输出全部来自框架本身。
+ *
+ * - ProceedTest：由 `depth - 1` 层容器和一层叶子组成的测试树，从根容器的 `ProceedTest()` 开始完整执行；
+ * - appendSubTestResult：向一个叶子节点的父节点逐个追加叶子结果；
+ * - refreshOutput：为一个完成了一半的叶子节点的父节点绘制一帧进度，按帧计算；
+ * - finishSubtestBatch：汇总一个所有叶子都已完成的叶子节点的父节点。
+ *
+ * 每一行报告每个叶子（refreshOutput 为每一帧）的纳秒数、内存分配次数、分配的字节数和控制台输出的字节数。
+ * 框架的控制台输出写入内存中的环形缓冲区，只统计字节数；基准结果直接打印到标准输出。
+ *
+ * 用法：FuzzTestSchemaOverheadBenchmark [--max-leaves <N>] [--min-time-ms <N>] [--threads <N>] [--interactive]
+ * - `--max-leaves`：最大的叶子数量，默认为 10^7；
+ * - `--min-time-ms`：每一行至少测量的时间，默认为 200 毫秒，取各次重复的中位数；
+ * - `--threads`：并行执行，此时其他线程中的内存分配不被统计，分配列显示为 `-`；
+ * - `--interactive`：以终端模式绘制进度（重绘进度区域），默认以非终端模式打印进度摘要。
+ */
+
+/// @brief 空的叶子测试。
+class EmptyExecutorClass : public TestExecutorClass
+{
+public:
+    using TestExecutorClass::TestExecutorClass;
+
+    TestResult RunTest(NameType testName) override
+    {
+        (void)testName;
+        this->testResult.isLeaf = true;
+        this->testResult.testIndex = this->testIndex;
+        return this->testResult;
+    }
+};
+
+/// @brief 测试树的形状：第 i 层容器有 `fanouts[i]` 个子节点，最后一项为每个叶子节点的父节点下的叶子数量。
+struct TreeShape
+{
+    std::vector<size_t> fanouts;
+
+    size_t leaves() const
+    {
+        size_t count = 1;
+        for (size_t fanout : fanouts)
+        {
+            count *= fanout;
+        }
+        return count;
+    }
+};
+
+/// @brief 生成约有 leaves 个叶子、共 depth 层（包括叶子）的测试树，各层的扇出尽量相等。
+TreeShape makeShape(size_t leaves, size_t depth)
+{
+    TreeShape shape;
+    double remaining = static_cast<double>(leaves);
+    for (size_t levelsLeft = depth - 1; levelsLeft > 0; levelsLeft--)
+    {
+        size_t fanout = std::max<size_t>(1, static_cast<size_t>(std::llround(std::pow(remaining, 1.0 / static_cast<double>(levelsLeft)))));
+        shape.fanouts.push_back(fanout);
+        remaining /= static_cast<double>(fanout);
+    }
+    return shape;
+}
+
+/// @brief 按 `TreeShape` 递归构造的空容器。
+class LevelContainerClass : public TestContainerClass
+{
+public:
+    LevelContainerClass(const TreeShape& shape, size_t level)
+        : TestContainerClass(level + 1 == shape.fanouts.size(), nullptr), shape(shape), level(level)
+    {
+    }
+
+    TestResult RunTest(NameType testName) override
+    {
+        size_t count = shape.fanouts[level];
+        this->testResult = TestResult(count, isParentOfLeaf, testName);
+        if (isParentOfLeaf)
+        {
+            this->RunSubTests(count, [&](size_t i)
+            {
+                EmptyExecutorClass executor(nullptr, i);
+                return executor.ProceedTest(testName);
+            });
+        }
+        else
+        {
+            this->RunSubTests(count, [&](size_t i)
+            {
+                LevelContainerClass child(shape, level + 1);
+                return child.ProceedTest(testName + "." + std::to_string(i));
+            });
+        }
+        return this->testResult;
+    }
+
+private:
+    const TreeShape& shape;
+    size_t level;
+};
+
+/// @brief 一行测量结果，均为每个单位（叶子或帧）的平均值。
+struct Measurement
+{
+    double nanoseconds = 0;
+    double allocations = NAN;
+    double bytes = NAN;
+    double outputBytes = 0;
+};
+
+/// @brief 测量的配置。
+struct Options
+{
+    size_t maxLeaves = 10000000;
+    uint64_t minTime = 200000000;
+    bool parallel = false;
+};
+
+/**
+ * @brief 重复执行 run 直到累计时间超过 `minTime`，返回每个单位的中位数时间和平均输出字节数；
+ * 单线程时再额外执行一次以统计内存分配。
+ *
+ * @param units 每次执行包含的单位数量。
+ * @param prepare 返回一次执行所需的状态，不计入测量；状态在测量结束后才析构。
+ * @param run 被测量的操作。
+ */
+template <typename State>
+Measurement measure(const Options& options, size_t units, const std::function<std::unique_ptr<State>()>& prepare,
+                    const std::function<void(State&)>& run)
+{
+    Measurement measurement;
+    std::vector<uint64_t> times;
+    uint64_t total = 0;
+    uint64_t outputBytes = 0;
+    while (total < options.minTime && times.size() < 10000)
+    {
+        std::unique_ptr<State> state = prepare();
+        uint64_t outputStart = OutputSink::instance().bytesWritten();
+        START_TIMER;
+        run(*state);
+        uint64_t time = FINISH_TIMER;
+        OutputSink::instance().flush();
+        outputBytes += OutputSink::instance().bytesWritten() - outputStart;
+        times.push_back(time);
+        total += time;
+    }
+    std::sort(times.begin(), times.end());
+    measurement.nanoseconds = static_cast<double>(times[times.size() / 2]) / static_cast<double>(units);
+    measurement.outputBytes = static_cast<double>(outputBytes) / static_cast<double>(units * times.size());
+
+    if (!options.parallel)
+    {
+        std::unique_ptr<State> state = prepare();
+        AllocationStats stats;
+        AllocationTracker::enable();
+        AllocationTracker::Snapshot snapshot = AllocationTracker::start();
+        run(*state);
+        AllocationTracker::finish(snapshot, stats);
+        AllocationTracker::enable(false);
+        measurement.allocations = static_cast<double>(stats.allocations) / static_cast<double>(units);
+        measurement.bytes = static_cast<double>(stats.bytesAllocated) / static_cast<double>(units);
+    }
+    return measurement;
+}
+
+void printHeader(const char* title, const char* unit)
+{
+    std::printf("\n%s\n", title);
+    std::printf("%6s %10s %12s %12s %12s %12s\n", "depth", "leaves", (std::string("ns/") + unit).c_str(), (std::string("allocs/") + unit).c_str(),
+                (std::string("B/") + unit).c_str(), (std::string("out B/") + unit).c_str());
+}
+
+void printRow(const std::string& depth, size_t leaves, const Measurement& measurement)
+{
+    char allocations[32] = "-";
+    char bytes[32] = "-";
+    if (!std::isnan(measurement.allocations))
+    {
+        std::snprintf(allocations, sizeof(allocations), "%.2f", measurement.allocations);
+        std::snprintf(bytes, sizeof(bytes), "%.1f", measurement.bytes);
+    }
+    std::printf("%6s %10zu %12.1f %12s %12s %12.2f\n", depth.c_str(), leaves, measurement.nanoseconds, allocations, bytes, measurement.outputBytes);
+    std::fflush(stdout);
+}
+
+/// @brief 一次执行所需的叶子结果存储，执行期间作为当前的 `TestContext`。
+struct StoreState
+{
+    std::shared_ptr<ResultStore> store = std::make_shared<ResultStore>();
+
+    TestContext context() const
+    {
+        TestContext context = TestContext::current();
+        context.resultStore = store;
+        return context;
+    }
+};
+
+/// @brief 一个叶子节点的父节点，构造时追加前 appended 个叶子的结果。
+struct ContainerState : StoreState
+{
+    TestResult result;
+
+    ContainerState(size_t leaves, size_t appended)
+    {
+        TestContext::Scope scope(context());
+        result = TestResult(static_cast<ssize_t>(leaves), true, "Overhead");
+        appendLeaves(result, 0, appended);
+    }
+
+    static void appendLeaves(TestResult& result, size_t begin, size_t end)
+    {
+        for (size_t i = begin; i < end; i++)
+        {
+            TestResult leaf;
+            leaf.isLeaf = true;
+            leaf.testIndex = static_cast<ssize_t>(i);
+            result.appendSubTestResult(std::move(leaf));
+        }
+    }
+};
+
+std::vector<size_t> leafCounts(const Options& options)
+{
+    std::vector<size_t> counts;
+    for (size_t leaves = 10; leaves <= options.maxLeaves; leaves *= 10)
+    {
+        counts.push_back(leaves);
+    }
+    return counts;
+}
+
+int main(int argc, char** argv)
+{
+    Options options;
+    bool interactive = false;
+    for (int i = 1; i < argc; i++)
+    {
+        std::string argument = argv[i];
+        if (argument == "--interactive")
+        {
+            interactive = true;
+        }
+        else if (i + 1 < argc && argument == "--max-leaves")
+        {
+            options.maxLeaves = std::stoull(argv[++i]);
+        }
+        else if (i + 1 < argc && argument == "--min-time-ms")
+        {
+            options.minTime = std::stoull(argv[++i]) * 1000000;
+        }
+        else if (i + 1 < argc && argument == "--threads")
+        {
+            TestScheduler::enableParallel(std::stoul(argv[++i]));
+            options.parallel = true;
+        }
+    }
+
+    OutputSink::instance().toRingBuffer(64 * 1024);
+    ProgressRenderer::instance().setInteractive(interactive);
+    std::printf("Framework overhead with empty executors (%s, progress %s)\n", options.parallel ? "parallel" : "1 thread",
+                interactive ? "redrawn as on a terminal" : "printed as summary lines");
+
+    printHeader("ProceedTest", "leaf");
+    for (size_t depth = 2; depth <= 6; depth++)
+    {
+        for (size_t requested : leafCounts(options))
+        {
+            TreeShape shape = makeShape(requested, depth);
+            size_t leaves = shape.leaves();
+            Measurement measurement = measure<StoreState>(options, leaves, [] { return std::make_unique<StoreState>(); }, [&](StoreState& state)
+            {
+                TestContext::Scope scope(state.context());
+                LevelContainerClass root(shape, 0);
+                root.ProceedTest("Overhead");
+            });
+            printRow(std::to_string(depth), leaves, measurement);
+        }
+    }
+
+    printHeader("appendSubTestResult", "leaf");
+    for (size_t leaves : leafCounts(options))
+    {
+        Measurement measurement = measure<ContainerState>(options, leaves, [&] { return std::make_unique<ContainerState>(leaves, 0); }, [&](ContainerState& state)
+        {
+            ContainerState::appendLeaves(state.result, 0, leaves);
+        });
+        printRow("-", leaves, measurement);
+    }
+
+    printHeader("refreshOutput", "frame");
+    const size_t frames = 100;
+    for (size_t leaves : leafCounts(options))
+    {
+        // 绘制不改变容器，所有重复共用同一个完成了一半的容器
+        ContainerState container(leaves, leaves / 2);
+        Measurement measurement = measure<ContainerState*>(options, frames, [&] { return std::make_unique<ContainerState*>(&container); }, [&](ContainerState*& state)
+        {
+            for (size_t frame = 0; frame < frames; frame++)
+            {
+                state->result.refreshOutput();
+            }
+        });
+        printRow("-", leaves, measurement);
+    }
+
+    printHeader("finishSubtestBatch", "leaf");
+    for (size_t leaves : leafCounts(options))
+    {
+        Measurement measurement = measure<ContainerState>(options, leaves, [&] { return std::make_unique<ContainerState>(leaves, leaves); }, [&](ContainerState& state)
+        {
+            state.result.finishSubtestBatch();
+        });
+        printRow("-", leaves, measurement);
+    }
+    return 0;
+}
@@ -0,0 +1,160 @@
+#include "FuzzTestSchema.h"
+#include <random>
+
+using BaseType = std::string;
+using ContainerDatatype = std::vector<BaseType>;
+using ContainerType = std::pair<ContainerDatatype, NameType>;
+using DriverDatatype = std::vector<ContainerType>;
+
+/**
+ * @brief 逐个执行的字符串长度测试执行者类，用于与批处理执行者比较。
+ */
+class LengthTestExecutorClass : public TestExecutorClass
+{
+public:
+    using TestExecutorClass::TestExecutorClass;
+
+    TestResult RunTest(NameType testName) override
+    {
+        (void)testName;
+        this->testResult.isLeaf = true;
+        this->testResult.testIndex = this->testIndex;
+        this->testResult.assertNE("string length", DATA_PTR(BaseType)->length(), size_t(0));
+        return this->testResult;
+    }
+};
+
+/**
+ * @brief 批处理的字符串长度测试执行者类。
+ *
+ * 先以无分支的循环一次写入 64 个叶子的通过位，再只为（很少的）失败叶子生成错误信息。
+ */
+class LengthBatchExecutorClass : public BatchTestExecutorClass<BaseType>
+{
+public:
+    void RunBatch(Span<const BaseType> inputs, BatchResult& result) override
+    {
+        uint64_t* words = result.maskWords();
+        for (size_t w = 0; w < result.maskWordCount(); ++w)
+        {
+            size_t begin = w * 64;
+            size_t end = begin + 64 < inputs.size() ? begin + 64 : inputs.size();
+            uint64_t bits = 0;
+            for (size_t i = begin; i < end; ++i)
+            {
+                bits |= uint64_t(inputs[i].size() != 0) << (i - begin);
+            }
+            words[w] = bits;
+        }
+        for (size_t i = 0; i < inputs.size(); ++i)
+        {
+            if (!result.passed(i))
+            {
+                result.fail(i, "Expect string length ≠ 0, but get: 0.");
+            }
+        }
+    }
+};
+
+/**
+ * @brief 字符串长度测试容器类。
+ *
+ * 默认以批的方式执行叶子，传入 `--per-leaf` 时改为为每个输入构造一个执行者。
+ */
+class LengthTestContainerClass : public TestContainerClass
+{
+public:
+    LengthTestContainerClass(void* dataPtr, bool perLeaf) : TestContainerClass(true, dataPtr), perLeaf(perLeaf) {}
+
+    TestResult RunTest(NameType testName) override
+    {
+        const ContainerType* group = DATA_PTR(const ContainerType);
+        NameType fullName = testName + "." + group->second;
+        this->testResult = TestResult(group->first.size(), true, fullName);
+        if (perLeaf)
+        {
+            this->RunSubTests(group->first.size(), [&](size_t i)
+            {
+                BaseType subData = group->first.at(i);
+                LengthTestExecutorClass subClass(&subData, i);
+                return subClass.ProceedTest(fullName);
+            });
+        }
+        else
+        {
+            LengthBatchExecutorClass executor;
+            this->RunSubTestBatches(Span<const BaseType>(group->first), executor);
+        }
+        return this->testResult;
+    }
+
+private:
+    bool perLeaf;
+};
+
+/**
+ * @brief 字符串长度测试驱动类，每个分组包含大量很短的输入，其中混有少量空字符串。
+ */
+class LengthTestDriverClass : public TestDriverClass
+{
+public:
+    explicit LengthTestDriverClass(bool perLeaf) : perLeaf(perLeaf) {}
+
+protected:
+    void SetUp() override
+    {
+        DriverDatatype* data = new DriverDatatype(8);
+        this->dataPtr = data;
+        std::mt19937 engine(3);
+        std::uniform_int_distribution<size_t> length(0, 400);
+        for (size_t i = 0; i < data->size(); ++i)
+        {
+            (*data)[i].second = "group-" + std::to_string(i);
+            for (size_t j = 0; j < 20000; ++j)
+            {
+                (*data)[i].first.push_back(std::string(length(engine), 'x'));
+            }
+        }
+    }
+
+    TestResult RunTest(NameType testName) override
+    {
+        this->RunSubTests(DATA_PTR(DriverDatatype)->size(), [&](size_t i)
+        {
+            LengthTestContainerClass subClass(&DATA_PTR(DriverDatatype)->at(i), perLeaf);
+            return subClass.ProceedTest(testName);
+        });
+        return this->testResult;
+    }
+
+    void TearDown() override
+    {
+        delete DATA_PTR(DriverDatatype);
+    }
+
+private:
+    bool perLeaf;
+};
+
+int main(int argc, char **argv)
+{
+    // 传入 `--threads <N>` 以使用 N 个线程并行执行测试，传入 `--per-leaf` 以逐个执行叶子进行比较
+    bool perLeaf = false;
+    for (int i = 1; i < argc; i++)
+    {
+        if (std::string(argv[i]) == "--threads" && i + 1 < argc)
+        {
+            TestScheduler::enableParallel(std::stoul(argv[i + 1]));
+        }
+        else if (std::string(argv[i]) == "--per-leaf")
+        {
+            perLeaf = true;
+        }
+    }
+
+    LengthTestDriverClass rootClass(perLeaf);
+    START_TIMER;
+    rootClass.ProceedTest("Batch");
+    printStyledText("Total time " + formatTime(FINISH_TIMER) + ".", TextColor::CYAN, TextStyle::NORMAL, true);
+    return 0;
+}
@@ -0,0 +1,118 @@
+#include "FuzzTestSchema.h"
+#include <cstdlib>
+
+using BaseType = std::string;
+using ContainerDatatype = std::vector<BaseType>;
+using ContainerType = std::pair<ContainerDatatype, NameType>;
+
+/// @brief 逐字符解析十进制整数。
+long parseManually(const std::string& text)
+{
+    long value = 0;
+    for (char c : text)
+    {
+        value = value * 10 + (c - '0');
+    }
+    return value;
+}
+
+/// @brief 使用 `std::strtol` 解析十进制整数。
+long parseWithStrtol(const std::string& text)
+{
+    return std::strtol(text.c_str(), nullptr, 10);
+}
+
+/**
+ * @brief 示例基准测试执行者类。
+ *
+ * 数据指针指向一个十进制整数的字符串，`Parse` 为被比较的解析函数。
+ * `RunTest()` 先检查解析结果与 `std::stol` 一致，再由基类进行测量。
+ */
+template <long (*Parse)(const std::string&)>
+class ParseBenchmarkClass : public BenchmarkExecutorClass
+{
+public:
+    using BenchmarkExecutorClass::BenchmarkExecutorClass;
+
+    TestResult RunTest(NameType testName) override
+    {
+        (void)testName;
+        const std::string& input = *DATA_PTR(std::string);
+        this->testResult.assertEQ("parsed value", std::stol(input), Parse(input));
+        return this->testResult;
+    }
+
+protected:
+    void RunIteration() override
+    {
+        long value = Parse(*DATA_PTR(std::string));
+        DoNotOptimize(value);
+    }
+
+    uint64_t BytesProcessed() const override
+    {
+        return DATA_PTR(std::string)->size();
+    }
+};
+
+/**
+ * @brief 示例基准测试容器类。
+ *
+ * 对同一组输入分别测量一种解析函数。
+ */
+template <typename Benchmark>
+class ParseBenchmarkContainerClass : public TestContainerClass
+{
+public:
+    ParseBenchmarkContainerClass(void* dataPtr, BenchmarkOptions options) : TestContainerClass(true, dataPtr), options(options) {}
+
+    TestResult RunTest(NameType testName) override
+    {
+        ContainerType* data = DATA_PTR(ContainerType);
+        this->testResult = TestResult(data->first.size(), true, testName + "." + data->second);
+        this->RunSubTests(data->first.size(), [&](size_t i)
+        {
+            Benchmark benchmark(&data->first.at(i), i, options);
+            return benchmark.ProceedTest(testName + "." + data->second);
+        });
+        return this->testResult;
+    }
+
+private:
+    BenchmarkOptions options;
+};
+
+class ParseBenchmarkDriverClass : public TestDriverClass
+{
+protected:
+    void SetUp() override
+    {
+        this->dataPtr = new std::vector<ContainerType>{
+            {{"7", "4096", "123456789", "9223372036854775807"}, "manual"},
+            {{"7", "4096", "123456789", "9223372036854775807"}, "strtol"},
+        };
+    }
+
+    TestResult RunTest(NameType testName) override
+    {
+        BenchmarkOptions options;
+        options.measureTime = std::chrono::milliseconds(200);
+        auto* data = DATA_PTR(std::vector<ContainerType>);
+        ParseBenchmarkContainerClass<ParseBenchmarkClass<parseManually>> manual(&data->at(0), options);
+        ParseBenchmarkContainerClass<ParseBenchmarkClass<parseWithStrtol>> strtol(&data->at(1), options);
+        this->testResult.appendSubTestResult(manual.ProceedTest(testName));
+        this->testResult.appendSubTestResult(strtol.ProceedTest(testName));
+        return this->testResult;
+    }
+
+    void TearDown() override
+    {
+        delete DATA_PTR(std::vector<ContainerType>);
+    }
+};
+
+int main()
+{
+    ParseBenchmarkDriverClass rootClass;
+    rootClass.ProceedTest("ParseBenchmark");
+}
@@ -0,0 +1,119 @@
+#include "FuzzTestSchema.h"
+#include <cstdlib>
+
+using BaseType = std::string;
+using ContainerDatatype = std::vector<BaseType>;
+using ContainerType = std::pair<ContainerDatatype, NameType>;
+using DriverDatatype = std::vector<ContainerType>;
+
+/// @brief 使用 `std::strtol` 解析十进制整数，作为基准实现。
+long parseWithStrtol(const std::string& text)
+{
+    return std::strtol(text.c_str(), nullptr, 10);
+}
+
+/// @brief 逐字符解析十进制整数，作为候选实现。不支持符号，因此在带符号的输入上输出不同。
+long parseManually(const std::string& text)
+{
+    long value = 0;
+    for (char c : text)
+    {
+        value = value * 10 + (c - '0');
+    }
+    return value;
+}
+
+/**
+ * @brief 示例 A/B 比较执行者类。
+ *
+ * 在同一个输入上比较 `parseWithStrtol` 和 `parseManually` 的输出和速度。
+ */
+class ParseComparisonClass : public ComparisonExecutorClass<BaseType>
+{
+public:
+    ParseComparisonClass(void* dataPtr, ssize_t testIndex, ComparisonOptions options) : ComparisonExecutorClass(dataPtr, testIndex, options)
+    {
+        Compare([](const std::string& text) { return parseWithStrtol(text); },
+                [](const std::string& text) { return parseManually(text); });
+    }
+};
+
+/**
+ * @brief 示例 A/B 比较容器类。
+ */
+class ParseComparisonContainerClass : public TestContainerClass
+{
+public:
+    ParseComparisonContainerClass(void* dataPtr, ComparisonOptions options) : TestContainerClass(true, dataPtr), options(options) {}
+
+    TestResult RunTest(NameType testName) override
+    {
+        ContainerType* data = DATA_PTR(ContainerType);
+        this->testResult = TestResult(data->first.size(), true, testName + "." + data->second);
+        this->RunSubTests(data->first.size(), [&](size_t i)
+        {
+            ParseComparisonClass comparison(&data->first.at(i), i, options);
+            return comparison.ProceedTest(testName + "." + data->second);
+        });
+        return this->testResult;
+    }
+
+private:
+    ComparisonOptions options;
+};
+
+/**
+ * @brief 示例 A/B 比较驱动类。
+ *
+ * 生成短整数、长整数和带符号整数三组输入，其中带符号的一组用于演示输出不同时的失败。
+ */
+class ParseComparisonDriverClass : public TestDriverClass
+{
+protected:
+    void SetUp() override
+    {
+        auto* data = new DriverDatatype{{{}, "short"}, {{}, "long"}, {{}, "signed"}};
+        Xoshiro256 rng(7);
+        for (int i = 0; i < 16; i++)
+        {
+            data->at(0).first.push_back(std::to_string(rng() % 1000));
+            data->at(1).first.push_back(std::to_string(rng() % 1000000000000000000ULL));
+        }
+        data->at(2).first = {"42", "+42", "-7"};
+        this->dataPtr = data;
+    }
+
+    TestResult RunTest(NameType testName) override
+    {
+        ComparisonOptions options;
+        options.warmupTime = std::chrono::milliseconds(5);
+        for (ContainerType& group : *DATA_PTR(DriverDatatype))
+        {
+            ParseComparisonContainerClass container(&group, options);
+            this->testResult.appendSubTestResult(container.ProceedTest(testName));
+        }
+        return this->testResult;
+    }
+
+    void TearDown() override
+    {
+        delete DATA_PTR(DriverDatatype);
+    }
+};
+
+int main(int argc, char** argv)
+{
+    // 传入 `--report-jsonl <文件>` 以查看每一层容器的比较数据
+    for (int i = 1; i + 1 < argc; i++)
+    {
+        if (std::string(argv[i]) == "--report-jsonl")
+        {
+            ResultReporter::instance().writeJsonLines(argv[i + 1]);
+        }
+    }
+
+    ParseComparisonDriverClass rootClass;
+    TestResult result = rootClass.ProceedTest("ParseComparison");
+    printStyledText("Overall: " + result.comparison.summary(), TextColor::CYAN, TextStyle::BOLD, true);
+    ResultReporter::instance().close();
+}
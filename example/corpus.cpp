@@ -0,0 +1,114 @@
+#include "FuzzTestSchema.h"
+#include <cstdio>
+#include <filesystem>
+
+// 与 main.cpp 中相同的内存数据类型，用于演示如何将已有数据转换为语料文件。
+using BaseType = std::string;
+using ContainerDatatype = std::vector<BaseType>;
+using ContainerType = std::pair<ContainerDatatype, NameType>;
+using DriverDatatype = std::vector<ContainerType>;
+using DriverType = std::pair<DriverDatatype, NameType>;
+
+/**
+ * @brief 语料测试执行者类。
+ *
+ * 数据指针指向一个 `std::string_view`，它直接引用映射到内存中的语料记录，不发生任何拷贝。
+ */
+class CorpusTestExecutorClass : public TestExecutorClass
+{
+public:
+    using TestExecutorClass::TestExecutorClass;
+
+    TestResult RunTest(NameType testName) override
+    {
+        (void)testName;
+        this->testResult.isLeaf = true;
+        this->testResult.testIndex = this->testIndex;
+
+        // 记录内容直接位于映射的文件中
+        std::string_view input = *DATA_PTR(std::string_view);
+        this->testResult.assertNE("string length", input.length(), size_t(0));
+        return this->testResult;
+    }
+};
+
+/**
+ * @brief 语料测试容器类。
+ *
+ * 数据指针指向一个 `CorpusGroup`，即语料文件中的一个分组。
+ */
+class CorpusTestContainerClass : public TestContainerClass
+{
+public:
+    using TestContainerClass::TestContainerClass;
+
+    TestResult RunTest(NameType testName) override
+    {
+        CorpusGroup* group = DATA_PTR(CorpusGroup);
+        NameType subTestName(group->name());
+        this->testResult = TestResult(group->size(), true, testName + "." + subTestName);
+        this->RunSubTests(group->size(), [&](size_t i)
+        {
+            std::string_view input = group->record(i);
+            CorpusTestExecutorClass subClass(&input, i);
+            return subClass.ProceedTest(testName + "." + subTestName);
+        });
+        return this->testResult;
+    }
+};
+
+/**
+ * @brief 语料测试驱动类。
+ *
+ * 逐个分组地从映射的语料文件中读取数据，每个分组交给一个 `CorpusTestContainerClass` 执行。
+ */
+class CorpusTestDriverClass : public StreamingTestDriverClass<CorpusGroup>
+{
+public:
+    explicit CorpusTestDriverClass(std::string path) : path(std::move(path)) {}
+
+protected:
+    std::unique_ptr<ChunkSource<CorpusGroup>> OpenSource() override
+    {
+        return std::unique_ptr<ChunkSource<CorpusGroup>>(new CorpusSource(std::make_shared<CorpusReader>(path)));
+    }
+
+    TestResult RunChunk(CorpusGroup& group, size_t chunkIndex, NameType testName) override
+    {
+        (void)chunkIndex;
+        CorpusTestContainerClass subClass(true, &group);
+        return subClass.ProceedTest(testName);
+    }
+
+private:
+    std::string path;
+};
+
+int main(int argc, char **argv)
+{
+    // 未指定路径时写入临时目录，运行结束后删除
+    bool temporary = argc <= 1;
+    std::string path = temporary ? (std::filesystem::temp_directory_path() / ("fuzz_test_schema_corpus_" + std::to_string(getpid()) + ".bin")).string()
+                                 : argv[1];
+
+    // 将内存中的 DriverType 数据转换为语料文件
+    DriverType data;
+    for (int i = 0; i < 20; ++i)
+    {
+        ContainerDatatype row;
+        for (int j = 0; j < 50; ++j)
+        {
+            row.push_back("String " + std::to_string(i * 3 + j));
+        }
+        data.first.push_back(ContainerType(row, "test-" + std::to_string(i)));
+    }
+    data.second = "ExampleTest";
+    writeCorpus(path, data);
+
+    CorpusTestDriverClass rootClass(path);
+    rootClass.ProceedTest("CorpusShowCase");
+    if (temporary)
+    {
+        std::remove(path.c_str());
+    }
+}
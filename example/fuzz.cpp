@@ -0,0 +1,94 @@
+#define FUZZ_TEST_SCHEMA_COVERAGE
+#include "FuzzTestSchema.h"
+
+/**
+ * @brief 模糊测试目标。
+ *
+ * 数据指针指向一个由模糊测试容器生成的 `std::string`。这里模拟一个简单的消息头解析函数，
+ * 其中埋有一个只有特定前缀才能触发的错误，随机输入几乎不可能直接命中，需要依靠覆盖率逐字节地接近。
+ */
+class HeaderParserExecutorClass : public TestExecutorClass
+{
+public:
+    using TestExecutorClass::TestExecutorClass;
+
+    TestResult RunTest(NameType testName) override
+    {
+        (void)testName;
+        this->testResult.isLeaf = true;
+        this->testResult.testIndex = this->testIndex;
+
+        const std::string& input = *DATA_PTR(std::string);
+        size_t headerLength = 0;
+        if (input.size() >= 4 && input[0] == 'F')
+        {
+            if (input[1] == 'T')
+            {
+                if (input[2] == 'S')
+                {
+                    // 埋下的错误：版本号为 '!' 时头部长度计算错误
+                    headerLength = input[3] == '!' ? input.size() + 1 : 4;
+                }
+            }
+        }
+        this->testResult.assertEQ("header length within input", true, headerLength <= input.size());
+        return this->testResult;
+    }
+};
+
+/**
+ * @brief 模糊测试驱动类。
+ *
+ * 数据指针指向初始输入，下层只有一个 `CoverageFuzzerClass`。
+ */
+class FuzzTestDriverClass : public TestDriverClass
+{
+public:
+    explicit FuzzTestDriverClass(FuzzOptions options) : options(std::move(options)) {}
+
+protected:
+    FuzzOptions options;
+
+    void SetUp() override
+    {
+        this->dataPtr = new std::vector<std::string>{"hello", "FT"};
+    }
+
+    TestResult RunTest(NameType testName) override
+    {
+        this->RunSubTests(1, [&](size_t)
+        {
+            CoverageFuzzerClass<HeaderParserExecutorClass> fuzzer(this->dataPtr, options);
+            return fuzzer.ProceedTest(testName);
+        });
+        return this->testResult;
+    }
+
+    void TearDown() override
+    {
+        delete DATA_PTR(std::vector<std::string>);
+    }
+};
+
+int main(int argc, char **argv)
+{
+    FuzzOptions options;
+    options.name = "HeaderParser";
+    options.maxTime = std::chrono::seconds(10);
+
+    // 传入 `--corpus <目录>` 以保存语料，传入 `--seconds <N>` 以设置最长执行时间
+    for (int i = 1; i + 1 < argc; i++)
+    {
+        if (std::string(argv[i]) == "--corpus")
+        {
+            options.corpusDirectory = argv[i + 1];
+        }
+        else if (std::string(argv[i]) == "--seconds")
+        {
+            options.maxTime = std::chrono::seconds(std::stoul(argv[i + 1]));
+        }
+    }
+
+    FuzzTestDriverClass rootClass(options);
+    rootClass.ProceedTest("FuzzShowCase");
+}
@@ -0,0 +1,147 @@
+#include "FuzzTestSchema.h"
+#include <atomic>
+#include <random>
+
+using BaseType = std::string;
+using ContainerDatatype = std::vector<BaseType>;
+using ContainerType = std::pair<ContainerDatatype, NameType>;
+using DriverDatatype = std::vector<ContainerType>;
+
+/// @brief 每个区域包含的分组数量。
+static constexpr size_t GROUPS_PER_REGION = 4;
+
+/// @brief 区域数量。
+static constexpr size_t REGION_COUNT = 3;
+
+/**
+ * @brief 生成所有区域共用的数据集。
+ *
+ * 在实际使用中这通常是读取并解析一个很大的文件，因此只希望构造一次。
+ */
+static std::unique_ptr<DriverDatatype> buildDataset()
+{
+    std::unique_ptr<DriverDatatype> dataset(new DriverDatatype(REGION_COUNT * GROUPS_PER_REGION));
+    std::mt19937 engine(7);
+    std::uniform_int_distribution<size_t> length(1, 32);
+    for (size_t i = 0; i < dataset->size(); ++i)
+    {
+        (*dataset)[i].second = "group-" + std::to_string(i);
+        for (size_t j = 0; j < 40; ++j)
+        {
+            (*dataset)[i].first.push_back(std::string(length(engine), 'x'));
+        }
+    }
+    return dataset;
+}
+
+/**
+ * @brief 记录测试执行者类。
+ */
+class RecordTestExecutorClass : public TestExecutorClass
+{
+public:
+    using TestExecutorClass::TestExecutorClass;
+
+    TestResult RunTest(NameType testName) override
+    {
+        (void)testName;
+        this->testResult.isLeaf = true;
+        this->testResult.testIndex = this->testIndex;
+        this->testResult.assertNE("string length", DATA_PTR(BaseType)->length(), size_t(0));
+        return this->testResult;
+    }
+};
+
+/**
+ * @brief 记录测试容器类，数据指针指向一个分组。
+ */
+class RecordTestContainerClass : public TestContainerClass
+{
+public:
+    using TestContainerClass::TestContainerClass;
+
+    TestResult RunTest(NameType testName) override
+    {
+        const ContainerType* group = DATA_PTR(const ContainerType);
+        this->testResult = TestResult(group->first.size(), true, testName + "." + group->second);
+        this->RunSubTests(group->first.size(), [&](size_t i)
+        {
+            BaseType subData = group->first.at(i);
+            RecordTestExecutorClass subClass(&subData, i);
+            return subClass.ProceedTest(testName + "." + group->second);
+        });
+        return this->testResult;
+    }
+};
+
+/**
+ * @brief 区域测试驱动类。
+ *
+ * 位于测试图的中间，所有区域共享同一个数据集夹具：无论哪个区域先执行，数据集都只构造一次，
+ * 并在最后一个区域结束时释放。
+ */
+class RegionTestDriverClass : public TestDriverClass
+{
+public:
+    RegionTestDriverClass(SharedFixture<DriverDatatype>& dataset, size_t region) : dataset(dataset.share()), region(region) {}
+
+protected:
+    void SetUp() override
+    {
+        this->dataPtr = &dataset.get();
+    }
+
+    TestResult RunTest(NameType testName) override
+    {
+        NameType regionName = testName + ".region-" + std::to_string(region);
+        this->testResult = TestResult(GROUPS_PER_REGION, false, regionName);
+        this->RunSubTests(GROUPS_PER_REGION, [&](size_t i)
+        {
+            RecordTestContainerClass subClass(true, &DATA_PTR(DriverDatatype)->at(region * GROUPS_PER_REGION + i));
+            return subClass.ProceedTest(regionName);
+        });
+        return this->testResult;
+    }
+
+    void TearDown() override
+    {
+        dataset.release();
+    }
+
+private:
+    SharedFixture<DriverDatatype>::Handle dataset;
+    size_t region;
+};
+
+int main(int argc, char **argv)
+{
+    // 传入 `--threads <N>` 以使用 N 个线程并行执行测试，互不依赖的子树会同时执行
+    for (int i = 1; i + 1 < argc; i++)
+    {
+        if (std::string(argv[i]) == "--threads")
+        {
+            TestScheduler::enableParallel(std::stoul(argv[i + 1]));
+        }
+    }
+
+    std::atomic<size_t> teardowns(0);
+    SharedFixture<DriverDatatype> dataset(buildDataset, [&](DriverDatatype&) { teardowns++; });
+
+    // Graph
+    // ├── Regions：三个共享数据集的驱动类
+    // └── Smoke
+    //     └── Nested：一个额外的分组层，演示任意深度
+    TestGroupClass root("Graph");
+    TestGroupClass& regions = root.AddSubTest<TestGroupClass>("Regions");
+    for (size_t region = 0; region < REGION_COUNT; ++region)
+    {
+        regions.AddSubTest<RegionTestDriverClass>(dataset, region);
+    }
+    ContainerType smokeData(ContainerDatatype{"a", "bb", "ccc"}, "smoke");
+    root.AddSubTest<TestGroupClass>("Smoke").AddSubTest<TestGroupClass>("Nested").AddSubTest<RecordTestContainerClass>(true, &smokeData);
+
+    TestResult result = root.ProceedTest("Suite");
+    printStyledText("Dataset built " + std::to_string(dataset.builds()) + " time(s), torn down " + std::to_string(teardowns.load()) + " time(s).",
+                    TextColor::CYAN, TextStyle::NORMAL, true);
+    return result.success ? 0 : 1;
+}
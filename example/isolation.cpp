@@ -0,0 +1,179 @@
+#include "FuzzTestSchema.h"
+#include <cstdlib>
+#include <csignal>
+
+using BaseType = std::string;
+using ContainerDatatype = std::vector<BaseType>;
+using ContainerType = std::pair<ContainerDatatype, NameType>;
+using DriverDatatype = std::vector<ContainerType>;
+using DriverType = std::pair<DriverDatatype, NameType>;
+
+/**
+ * @brief 一个有缺陷的解析函数。
+ *
+ * 以 `!` 开头的输入会触发空指针解引用，以 `#` 开头的输入会调用 `abort()`（与 sanitizer 报错时的行为相同），
+ * 以 `$` 开头的输入会直接退出进程，以 `%` 开头的输入会陷入死循环。
+ */
+static size_t parseRecord(const std::string& input)
+{
+    if (!input.empty() && input[0] == '!')
+    {
+        volatile int* pointer = nullptr;
+        return static_cast<size_t>(*pointer);
+    }
+    if (!input.empty() && input[0] == '#')
+    {
+        std::abort();
+    }
+    if (!input.empty() && input[0] == '$')
+    {
+        std::exit(3);
+    }
+    while (!input.empty() && input[0] == '%')
+    {
+    }
+    return input.size();
+}
+
+/**
+ * @brief 解析测试执行者类。
+ *
+ * 与普通的执行者没有任何区别，隔离执行由容器类中的 `IsolatedExecutorClass` 负责。
+ */
+class ParserTestExecutorClass : public TestExecutorClass
+{
+public:
+    using TestExecutorClass::TestExecutorClass;
+
+    TestResult RunTest(NameType testName) override
+    {
+        (void)testName;
+        this->testResult.isLeaf = true;
+        this->testResult.testIndex = this->testIndex;
+        std::string* input = DATA_PTR(std::string);
+        this->testResult.assertEQ("parsed length", parseRecord(*input), input->size());
+        return this->testResult;
+    }
+};
+
+/**
+ * @brief 解析测试容器类。
+ *
+ * 每个叶子测试都通过 `IsolatedExecutorClass` 在工作进程中执行，崩溃只会使对应的叶子测试失败。
+ */
+class ParserTestContainerClass : public TestContainerClass
+{
+public:
+    using TestContainerClass::TestContainerClass;
+
+    TestResult RunTest(NameType testName) override
+    {
+        NameType subTestName = DATA_PTR(ContainerType)->second;
+        this->testResult = TestResult(DATA_PTR(ContainerType)->first.size(), true, testName + "." + subTestName);
+        this->RunSubTests(DATA_PTR(ContainerType)->first.size(), [&](size_t i)
+        {
+            BaseType subData = DATA_PTR(ContainerType)->first.at(i);
+            IsolatedExecutorClass<ParserTestExecutorClass> subClass(&subData, i);
+            return subClass.ProceedTest(testName + "." + subTestName);
+        });
+        return this->testResult;
+    }
+};
+
+/**
+ * @brief 解析测试驱动类。
+ *
+ * `SetUp()` 中生成的数据会被 fork 服务器继承，工作进程无需重新生成。
+ */
+class ParserTestDriverClass : public TestDriverClass
+{
+protected:
+    void SetUp() override
+    {
+        DriverType* matrix = new DriverType();
+        this->dataPtr = matrix;
+        matrix->first.resize(4);
+        for (size_t i = 0; i < matrix->first.size(); ++i)
+        {
+            matrix->first[i].second = "group-" + std::to_string(i);
+            for (size_t j = 0; j < 25; ++j)
+            {
+                matrix->first[i].first.push_back("record-" + std::to_string(i) + "-" + std::to_string(j));
+            }
+        }
+        // 在部分分组中混入会导致崩溃的输入
+        matrix->first[1].first[7] = "!null";
+        matrix->first[2].first[3] = "#abort";
+        matrix->first[2].first[19] = std::string("$exit\0\x01", 7);
+        matrix->first[3].first[11] = "%hang";
+        matrix->second = "Parser";
+    }
+
+    TestResult RunTest(NameType testName) override
+    {
+        this->RunSubTests(DATA_PTR(DriverType)->first.size(), [&](size_t i)
+        {
+            ContainerType subData = DATA_PTR(DriverType)->first.at(i);
+            ParserTestContainerClass subClass(true, &subData);
+            return subClass.ProceedTest(testName + "." + DATA_PTR(DriverType)->second);
+        });
+        return this->testResult;
+    }
+
+    void TearDown() override
+    {
+        delete DATA_PTR(DriverType);
+    }
+};
+
+int main(int argc, char **argv)
+{
+    // 传入 `--threads <N>` 以使用 N 个线程（以及 N 个工作进程）并行执行测试
+    for (int i = 1; i + 1 < argc; i++)
+    {
+        if (std::string(argv[i]) == "--threads")
+        {
+            TestScheduler::enableParallel(std::stoul(argv[i + 1]));
+        }
+    }
+
+    // 传入 `--crash-dir <目录>` 以将导致崩溃的输入保存到目录中，默认只写入错误信息
+    ForkServerOptions options;
+    for (int i = 1; i + 1 < argc; i++)
+    {
+        if (std::string(argv[i]) == "--crash-dir")
+        {
+            options.crashDirectory = argv[i + 1];
+        }
+    }
+    ForkServer::enable(options);
+
+    // 死循环的测试由看门狗在超出预算后杀死，传入 `--leaf-budget-ms <N>` 以修改每个叶子测试的预算
+    uint64_t leafBudget = 500;
+    for (int i = 1; i + 1 < argc; i++)
+    {
+        if (std::string(argv[i]) == "--leaf-budget-ms")
+        {
+            leafBudget = std::stoull(argv[i + 1]);
+        }
+    }
+    Watchdog::instance().setLeafBudget(std::chrono::milliseconds(leafBudget));
+
+    // 传入 `--report-junit <文件>` 或 `--report-jsonl <文件>` 以写入机器可读的报告，崩溃和退出的工作进程不会写入其中
+    for (int i = 1; i + 1 < argc; i++)
+    {
+        if (std::string(argv[i]) == "--report-junit")
+        {
+            ResultReporter::instance().writeJUnit(argv[i + 1]);
+        }
+        else if (std::string(argv[i]) == "--report-jsonl")
+        {
+            ResultReporter::instance().writeJsonLines(argv[i + 1]);
+        }
+    }
+
+    ParserTestDriverClass rootClass;
+    rootClass.ProceedTest("Isolation");
+    ResultReporter::instance().close();
+    return 0;
+}
@@ -1,4 +1,6 @@
+#define FUZZ_TEST_SCHEMA_ALLOCATION_TRACKING
 #include "FuzzTestSchema.h"
+#include <random>
 #include <unistd.h>
 
 // 使用 BaseType 来替代 std::string，使得代码更具语义化。
@@ -109,21 +111,18 @@ public:
         // 设置当前测试的结果为新创建的测试结果
         this->testResult = result;
 
-        // 遍历当前容器中的所有子数据
-        for (size_t i = 0; i < DATA_PTR(ContainerType)->first.size(); i++)
+        // 遍历当前容器中的所有子数据，执行子测试并将结果合并到当前测试结果中
+        this->RunSubTests(DATA_PTR(ContainerType)->first.size(), [&](size_t i)
         {
             // 获取当前子数据
             BaseType subData = DATA_PTR(ContainerType)->first.at(i);
 
-            // 创建一个新的 `ExampleTestExecutorClass` 实例
-            ExampleTestExecutorClass subClass(&subData, i);
+            // 创建一个新的 `ExampleTestExecutorClass` 实例，启用结果缓存时跳过此前已经通过的输入
+            CachedExecutorClass<ExampleTestExecutorClass> subClass(&subData, i);
 
             // 执行子测试
-            TestResult subTestResult = subClass.ProceedTest(testName + "." + subTestName);
-
-            // 将子测试的结果附加到当前测试结果中
-            this->testResult.appendSubTestResult(subTestResult);
-        }
+            return subClass.ProceedTest(testName + "." + subTestName);
+        });
 
         // 返回当前测试的结果
         return this->testResult;
@@ -132,22 +131,30 @@ public:
 
 class ExampleTestDriverClass : public TestDriverClass
 {
+public:
+    /// @brief 构造函数。
+    /// @param seed 生成测试数据使用的种子，相同的种子总是生成相同的数据。
+    explicit ExampleTestDriverClass(uint64_t seed) : seed(seed) {}
+
 protected:
+    /// @brief 生成测试数据使用的种子。
+    uint64_t seed;
+
     void fillData()
     {
         DriverType* matrix = DATA_PTR(DriverType);
-        DriverDatatype data;
 
-        for (int i = 0; i < 20; ++i)
+        // 每个字符串包含 1 到 16 个随机的 UTF-8 码点
+        Utf8Generator generator(1, 16);
+
+        // 第 i 个测试集的第 j 个字符串可以通过 regenerate(generator, seed, i, j) 重新生成
+        matrix->first.resize(20);
+        for (size_t i = 0; i < matrix->first.size(); ++i)
         {
-            ContainerDatatype row;
-            for (int j = 0; j < 50; ++j)
-            {
-                row.push_back("String " + std::to_string(i * 3 + j));
-            }
-            data.push_back(ContainerType(row, "test-" + std::to_string(i)));
+            matrix->first[i].first.resize(50);
+            matrix->first[i].second = "test-" + std::to_string(i);
+            fillBatch(generator, this->seed, i, matrix->first[i].first);
         }
-        matrix->first = data;
         matrix->second = "ExampleTest";
     }
 
@@ -159,14 +166,13 @@ protected:
 
     TestResult RunTest(NameType testName) override
     {
-        for (size_t i = 0; i < DATA_PTR(DriverType)->first.size(); i++)
+        this->RunSubTests(DATA_PTR(DriverType)->first.size(), [&](size_t i)
         {
             ContainerType subData = DATA_PTR(DriverType)->first.at(i);
             NameType subTestName = DATA_PTR(DriverType)->second;
-            ExampleTestContainerClass subClass(true, &subData);                            
-            TestResult result = subClass.ProceedTest(testName + "." + subTestName); 
-            this->testResult.appendSubTestResult(result);   
-        }
+            ExampleTestContainerClass subClass(true, &subData);
+            return subClass.ProceedTest(testName + "." + subTestName);
+        });
         return this->testResult;
     }
 
@@ -178,6 +184,119 @@ protected:
 
 int main(int argc, char **argv)
 {
-    ExampleTestDriverClass rootClass;
+    // 命令行选项：
+    // - `--threads <N>`：使用 N 个线程并行执行测试；
+    // - `--perf-counters`：统计每个叶子测试的性能计数器；`--track-allocations`：统计每个叶子测试的内存分配；
+    // - `--output <文件>`：将控制台输出写入文件；`--output-tail <字节数>`：只在内存中保留最后若干字节的输出并在结束时打印；
+    // - `--seed <N>`：复现某一次运行生成的测试数据；
+    // - `--baseline-save <文件>`：保存运行时间基线；`--baseline-compare <文件>`：与此前保存的基线比较；
+    // - `--report-jsonl <文件>`、`--report-junit <文件>`：写入机器可读的测试报告；
+    // - `--leaf-budget-ms <N>`、`--container-budget-ms <N>`、`--run-budget-ms <N>`：限制叶子、容器或整次运行的时间；
+    // - `--shard-index <i> --shard-count <n>`（或环境变量 FUZZ_TEST_SHARD_INDEX 和 FUZZ_TEST_SHARD_COUNT）：只执行第 i 个分片，
+    //   `--shard-output <文件>`：写入部分结果文件，之后用 FuzzTestSchemaShardMerge 合并；
+    // - `--cache <文件>`：跳过此前已经通过的输入；`--build-id <标识>`：指定构建标识（默认为编译时间），构建标识变化后缓存失效。
+    //   缓存按输入内容查找，而未指定 `--seed` 时种子默认随机，每次生成的输入都不同，
+    //   因此使用 `--cache` 且未指定 `--seed` 时，种子由构建标识导出，同一个构建的多次运行生成相同的输入。
+    size_t outputTail = 0;
+    bool seedGiven = false;
+    uint64_t seed = 0;
+    std::string cachePath;
+    std::string buildId = __DATE__ " " __TIME__;
+    // `--shard-output` 写入的文件记录分片参数，因此先读取分片参数
+    Sharding::configure(argc, argv);
+    for (int i = 1; i < argc; i++)
+    {
+        std::string argument = argv[i];
+        if (argument == "--perf-counters")
+        {
+            PerfCounters::enable();
+        }
+        else if (argument == "--track-allocations")
+        {
+            AllocationTracker::enable();
+        }
+        else if (i + 1 < argc && argument == "--threads")
+        {
+            TestScheduler::enableParallel(std::stoul(argv[++i]));
+        }
+        else if (i + 1 < argc && argument == "--output")
+        {
+            OutputSink::instance().toFile(argv[++i]);
+        }
+        else if (i + 1 < argc && argument == "--output-tail")
+        {
+            outputTail = std::stoul(argv[++i]);
+            OutputSink::instance().toRingBuffer(outputTail);
+        }
+        else if (i + 1 < argc && argument == "--seed")
+        {
+            seed = std::stoull(argv[++i]);
+            seedGiven = true;
+        }
+        else if (i + 1 < argc && argument == "--baseline-save")
+        {
+            PerformanceBaseline::instance().recordTo(argv[++i]);
+        }
+        else if (i + 1 < argc && argument == "--baseline-compare")
+        {
+            PerformanceBaseline::instance().compareWith(argv[++i]);
+        }
+        else if (i + 1 < argc && argument == "--report-jsonl")
+        {
+            ResultReporter::instance().writeJsonLines(argv[++i]);
+        }
+        else if (i + 1 < argc && argument == "--report-junit")
+        {
+            ResultReporter::instance().writeJUnit(argv[++i]);
+        }
+        else if (i + 1 < argc && argument == "--leaf-budget-ms")
+        {
+            Watchdog::instance().setLeafBudget(std::chrono::milliseconds(std::stoull(argv[++i])));
+        }
+        else if (i + 1 < argc && argument == "--container-budget-ms")
+        {
+            Watchdog::instance().setContainerBudget(std::chrono::milliseconds(std::stoull(argv[++i])));
+        }
+        else if (i + 1 < argc && argument == "--run-budget-ms")
+        {
+            Watchdog::instance().setRunBudget(std::chrono::milliseconds(std::stoull(argv[++i])));
+        }
+        else if (i + 1 < argc && argument == "--shard-output")
+        {
+            Sharding::writePartialResults(argv[++i]);
+        }
+        else if (i + 1 < argc && argument == "--cache")
+        {
+            cachePath = argv[++i];
+        }
+        else if (i + 1 < argc && argument == "--build-id")
+        {
+            buildId = argv[++i];
+        }
+    }
+    if (!seedGiven)
+    {
+        seed = cachePath.empty() ? std::random_device()() : fnv1aHash(buildId);
+    }
+    OutputSink::instance().write("Seed: " + std::to_string(seed) + "\n");
+    if (!cachePath.empty())
+    {
+        ResultCache::instance().open(cachePath, buildId);
+    }
+
+    ExampleTestDriverClass rootClass(seed);
     rootClass.ProceedTest("ShowCase");
+
+    ResultReporter::instance().close();
+    ResultCache::instance().save();
+    PerformanceBaseline::instance().save();
+    if (outputTail != 0)
+    {
+        OutputSink::instance().flush();
+        std::string tail = OutputSink::instance().ringBufferContents();
+        OutputSink::instance().toStdout();
+        OutputSink::instance().write(tail);
+        OutputSink::instance().flush();
+    }
+    return PerformanceBaseline::instance().exitCode();
 }
\ No newline at end of file
@@ -0,0 +1,72 @@
+#include "FuzzTestSchema.h"
+#include <random>
+
+using BaseType = std::string;
+using ContainerDatatype = std::vector<BaseType>;
+using ContainerType = std::pair<ContainerDatatype, NameType>;
+
+/// @brief 分组数量在编译期已知，驱动层级的子测试结果保存在 `std::array` 中。
+static constexpr size_t GROUP_COUNT = 8;
+
+using DriverDatatype = std::array<ContainerType, GROUP_COUNT>;
+
+/**
+ * @brief 驱动层级：生成固定数量的分组。
+ *
+ * 没有提供 `Elements`，因此直接遍历 `SetUp()` 返回的 `std::array`。
+ */
+struct RecordSuite
+{
+    DriverDatatype SetUp()
+    {
+        DriverDatatype data;
+        std::mt19937 engine(42);
+        std::uniform_int_distribution<size_t> length(0, 16);
+        for (size_t i = 0; i < data.size(); ++i)
+        {
+            data[i].second = "group-" + std::to_string(i);
+            for (size_t j = 0; j < 50; ++j)
+            {
+                data[i].first.push_back(std::string(length(engine) + 1, 'a' + static_cast<char>(i)));
+            }
+        }
+        return data;
+    }
+};
+
+/**
+ * @brief 容器层级：遍历分组中的记录，并以分组名称作为测试集名称。
+ */
+struct RecordGroup
+{
+    const ContainerDatatype& Elements(const ContainerType& group) { return group.first; }
+    NameType Name(const ContainerType& group) { return group.second; }
+};
+
+/**
+ * @brief 叶子层级：检查单条记录。
+ */
+struct RecordCase
+{
+    void RunTest(const BaseType& input, TestResult& result)
+    {
+        result.assertNE("string length", input.length(), size_t(0));
+    }
+};
+
+int main(int argc, char **argv)
+{
+    // 传入 `--threads <N>` 以使用 N 个线程并行执行测试
+    for (int i = 1; i + 1 < argc; i++)
+    {
+        if (std::string(argv[i]) == "--threads")
+        {
+            TestScheduler::enableParallel(std::stoul(argv[i + 1]));
+        }
+    }
+
+    // 层级在编译期声明：驱动 -> 分组 -> 记录
+    Schema<RecordSuite, ContainerLevel<RecordGroup>, ExecutorLevel<RecordCase>> schema;
+    TestResult result = schema.ProceedTest("Schema");
+    return result.success ? 0 : 1;
+}
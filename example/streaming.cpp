@@ -0,0 +1,132 @@
+#include "FuzzTestSchema.h"
+#include <iterator>
+#include <sstream>
+
+using BaseType = std::string;
+using ContainerDatatype = std::vector<BaseType>;
+using ContainerType = std::pair<ContainerDatatype, NameType>;
+
+/**
+ * @brief 流式测试执行者类，检查字符串非空。
+ */
+class StreamingTestExecutorClass : public TestExecutorClass
+{
+public:
+    using TestExecutorClass::TestExecutorClass;
+
+    TestResult RunTest(NameType testName) override
+    {
+        (void)testName;
+        this->testResult.isLeaf = true;
+        this->testResult.testIndex = this->testIndex;
+        this->testResult.assertNE("string length", DATA_PTR(BaseType)->length(), size_t(0));
+        return this->testResult;
+    }
+};
+
+/**
+ * @brief 流式测试容器类，数据指针指向一个数据块中的字符串。
+ */
+class StreamingTestContainerClass : public TestContainerClass
+{
+public:
+    /// @brief 构造函数。
+    /// @param elements 数据块中的字符串。
+    /// @param name 测试集的名称。
+    StreamingTestContainerClass(ContainerDatatype* elements, NameType name) : TestContainerClass(true, elements), name(std::move(name)) {}
+
+    TestResult RunTest(NameType testName) override
+    {
+        ContainerDatatype* elements = DATA_PTR(ContainerDatatype);
+        this->testResult = TestResult(elements->size(), true, testName + "." + name);
+        this->RunSubTests(elements->size(), [&](size_t i)
+        {
+            StreamingTestExecutorClass subClass(&elements->at(i), i);
+            return subClass.ProceedTest(testName + "." + name);
+        });
+        return this->testResult;
+    }
+
+private:
+    NameType name;
+};
+
+/**
+ * @brief 由生成函数逐块产出数据的流式测试驱动类。
+ *
+ * 每一块数据只在被预取时生成，测试结束后立即释放，整个数据集从不同时存在于内存中。
+ */
+class GeneratedTestDriverClass : public StreamingTestDriverClass<ContainerType>
+{
+protected:
+    std::unique_ptr<ChunkSource<ContainerType>> OpenSource() override
+    {
+        size_t next = 0;
+        return std::unique_ptr<ChunkSource<ContainerType>>(new GeneratorSource<ContainerType>([next](ContainerType& chunk) mutable
+        {
+            if (next == 20)
+            {
+                return false;
+            }
+            chunk.second = "test-" + std::to_string(next);
+            for (size_t j = 0; j < 50; ++j)
+            {
+                chunk.first.push_back("String " + std::to_string(next * 50 + j));
+            }
+            ++next;
+            return true;
+        }));
+    }
+
+    TestResult RunChunk(ContainerType& chunk, size_t chunkIndex, NameType testName) override
+    {
+        (void)chunkIndex;
+        StreamingTestContainerClass subClass(&chunk.first, chunk.second);
+        return subClass.ProceedTest(testName);
+    }
+};
+
+/**
+ * @brief 从输入流中逐个读取单词、按固定大小切分为数据块的流式测试驱动类。
+ *
+ * `IteratorSource` 只要求输入迭代器，因此可以直接包装 `std::istream_iterator`，无需先把整个流读入内存。
+ */
+class StreamTestDriverClass : public StreamingTestDriverClass<ContainerDatatype>
+{
+public:
+    /// @brief 构造函数。
+    /// @param text 被切分的文本，在驱动类的生命周期内读取。
+    explicit StreamTestDriverClass(std::string text) : stream(std::move(text)) {}
+
+protected:
+    std::unique_ptr<ChunkSource<ContainerDatatype>> OpenSource() override
+    {
+        using Iterator = std::istream_iterator<BaseType>;
+        return std::unique_ptr<ChunkSource<ContainerDatatype>>(new IteratorSource<Iterator>(Iterator(stream), Iterator(), 16));
+    }
+
+    TestResult RunChunk(ContainerDatatype& chunk, size_t chunkIndex, NameType testName) override
+    {
+        StreamingTestContainerClass subClass(&chunk, "chunk-" + std::to_string(chunkIndex));
+        return subClass.ProceedTest(testName);
+    }
+
+private:
+    std::istringstream stream;
+};
+
+int main()
+{
+    GeneratedTestDriverClass generated;
+    TestResult generatedResult = generated.ProceedTest("Generated");
+
+    std::string text;
+    for (int i = 0; i < 100; ++i)
+    {
+        text += "word-" + std::to_string(i) + (i % 10 == 9 ? "\n" : " ");
+    }
+    StreamTestDriverClass streamed(text);
+    TestResult streamedResult = streamed.ProceedTest("Streamed");
+
+    return generatedResult.success && streamedResult.success ? 0 : 1;
+}
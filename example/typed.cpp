@@ -0,0 +1,94 @@
+#include "FuzzTestSchema.h"
+#include <list>
+
+using BaseType = std::string;
+using ContainerDatatype = std::vector<BaseType>;
+using ContainerType = std::pair<ContainerDatatype, NameType>;
+
+/// @brief 驱动持有的数据，`std::list` 不支持随机访问，按索引访问元素仍然是 O(1)。
+using DriverDatatype = std::list<ContainerType>;
+
+/**
+ * @brief 类型化测试执行者：检查单个字符串的长度。
+ */
+class LengthExecutor : public TestExecutor<LengthExecutor, BaseType>
+{
+public:
+    void RunTest(const BaseType& input, TestResult& result)
+    {
+        result.assertNE("string length", input.length(), size_t(0));
+    }
+};
+
+/**
+ * @brief 类型化测试容器：遍历分组中的字符串，并以分组名称作为测试集名称。
+ */
+class LengthContainer : public TestContainer<LengthContainer, LengthExecutor, ContainerType>
+{
+public:
+    const ContainerDatatype& Elements(const ContainerType& input) { return input.first; }
+    NameType Name(const ContainerType& input) { return input.second; }
+};
+
+/**
+ * @brief 类型化测试驱动：生成数据并遍历其中的每个分组。
+ */
+class LengthDriver : public TestDriver<LengthDriver, LengthContainer, DriverDatatype>
+{
+public:
+    DriverDatatype SetUp()
+    {
+        DriverDatatype data(10);
+        size_t i = 0;
+        for (ContainerType& group : data)
+        {
+            group.second = "test-" + std::to_string(i);
+            for (size_t j = 0; j < 50; ++j)
+            {
+                group.first.push_back("String " + std::to_string(i * 50 + j));
+            }
+            ++i;
+        }
+        // 一个空字符串，用于演示失败的断言
+        std::next(data.begin(), 3)->first[7].clear();
+        return data;
+    }
+};
+
+/**
+ * @brief 基于 `void* dataPtr` 的测试容器类，通过 `TypedExecutorAdapter` 逐个调度类型化的执行者。
+ */
+class AdaptedTestContainerClass : public TestContainerClass
+{
+public:
+    using TestContainerClass::TestContainerClass;
+
+    TestResult RunTest(NameType testName) override
+    {
+        ContainerType* group = DATA_PTR(ContainerType);
+        this->testResult = TestResult(group->first.size(), true, testName + "." + group->second);
+        this->RunSubTests(group->first.size(), [&](size_t i)
+        {
+            TypedExecutorAdapter<LengthExecutor> subClass(&group->first[i], i);
+            return subClass.ProceedTest(testName + "." + group->second);
+        });
+        return this->testResult;
+    }
+};
+
+int main()
+{
+    LengthDriver driver;
+    TestResult typed = driver.ProceedTest("Typed");
+
+    // 在测试图中混合使用两种适配器：类型化的容器和调度类型化执行者的容器类
+    ContainerType first{ContainerDatatype(20, "abc"), "adapted-container"};
+    ContainerType second{ContainerDatatype(20, "xyz"), "adapted-executor"};
+    TestGroupClass root("Adapted");
+    root.AddSubTest<TypedContainerAdapter<LengthContainer>>(false, &first);
+    root.AddSubTest<AdaptedTestContainerClass>(true, &second);
+    TestResult adapted = root.ProceedTest("Mixed");
+
+    // 第一个驱动中包含一个故意失败的叶子
+    return !typed.success && adapted.success ? 0 : 1;
+}
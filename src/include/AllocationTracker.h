@@ -0,0 +1,484 @@
+#ifndef ALLOCATION_TRACKER_H
+#define ALLOCATION_TRACKER_H
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <string>
+#include <fcntl.h>
+#include <malloc.h>
+#include <unistd.h>
+
+/**
+ * 统计内存分配需要替换全局的 `operator new` 和 `operator delete`，而替换函数只能定义一次：
+ * 请在**恰好一个**源文件中先定义宏 `FUZZ_TEST_SCHEMA_ALLOCATION_TRACKING`，再包含本头文件。
+ * 替换后的函数直接转发给 `malloc` 和 `free`，未启用 `AllocationTracker` 时只多一次原子读取。
+ */
+
+/**
+ * @brief 内存分配的统计结果。
+ *
+ * 叶子结果记录单次运行期间本线程的分配情况，追加到父节点时逐层累加；
+ * 常驻内存（RSS）由容器在开始和结束时各采样一次，不参与累加。
+ */
+struct AllocationStats {
+    /// @brief 被统计的测试数量。
+    uint64_t tests = 0;
+
+    /// @brief 分配次数。
+    uint64_t allocations = 0;
+
+    /// @brief 释放次数，只包括统计期间分配的内存块。
+    uint64_t frees = 0;
+
+    /// @brief 分配的总字节数（按 `malloc_usable_size` 计算）。
+    uint64_t bytesAllocated = 0;
+
+    /// @brief 单个测试运行期间比开始时多占用的最大字节数；累加时取最大值。
+    uint64_t peakLiveBytes = 0;
+
+    /// @brief 容器开始和结束时的常驻内存字节数，为 0 表示没有采样。
+    uint64_t residentStart = 0;
+    uint64_t residentEnd = 0;
+
+    /// @brief 是否没有任何统计数据。
+    bool empty() const { return tests == 0 && residentEnd == 0; }
+
+    /// @brief 累加另一个测试的统计结果，常驻内存不参与累加。
+    AllocationStats& operator+=(const AllocationStats& other) {
+        tests += other.tests;
+        allocations += other.allocations;
+        frees += other.frees;
+        bytesAllocated += other.bytesAllocated;
+        peakLiveBytes = other.peakLiveBytes > peakLiveBytes ? other.peakLiveBytes : peakLiveBytes;
+        return *this;
+    }
+
+    /// @brief 生成一行摘要文本。
+    std::string summary() const {
+        std::string text;
+        if (tests != 0)
+        {
+            char perTest[32];
+            std::snprintf(perTest, sizeof(perTest), "%.1f", static_cast<double>(allocations) / static_cast<double>(tests));
+            text += std::to_string(allocations) + " allocations (" + perTest + " per test), " + std::to_string(frees) + " frees, " +
+                    formatBytes(bytesAllocated) + " allocated, peak " + formatBytes(peakLiveBytes) + " live in one test";
+        }
+        if (residentEnd != 0)
+        {
+            int64_t growth = static_cast<int64_t>(residentEnd) - static_cast<int64_t>(residentStart);
+            text += std::string(text.empty() ? "" : "; ") + "RSS " + formatBytes(residentEnd) + " at end (" + (growth < 0 ? "-" : "+") +
+                    formatBytes(static_cast<uint64_t>(growth < 0 ? -growth : growth)) + ")";
+        }
+        return text;
+    }
+
+    /// @brief 以 B/KB/MB/GB 为单位格式化字节数。
+    static std::string formatBytes(uint64_t bytes) {
+        static const char* units[] = {"B", "KB", "MB", "GB", "TB"};
+        double value = static_cast<double>(bytes);
+        size_t unit = 0;
+        while (value >= 1024 && unit + 1 < sizeof(units) / sizeof(units[0]))
+        {
+            value /= 1024;
+            unit++;
+        }
+        char buffer[32];
+        std::snprintf(buffer, sizeof(buffer), unit == 0 ? "%.0f %s" : "%.2f %s", value, units[unit]);
+        return buffer;
+    }
+};
+
+/**
+ * @brief 单个线程的分配计数。
+ *
+ * 只包含平凡类型的成员，因此可以作为 `thread_local` 变量在 `operator new` 中安全地使用。
+ */
+struct AllocationCounters {
+    uint64_t allocations;
+    uint64_t frees;
+    uint64_t bytesAllocated;
+    int64_t liveBytes;
+    int64_t peakLiveBytes;
+
+    /// @brief 嵌套的 `AllocationTracker::Suppress` 数量，不为 0 时不统计。
+    unsigned suppressed;
+};
+
+/**
+ * @brief 单个线程在本次统计期间分配的、尚未释放的内存块。
+ *
+ * 开放寻址的哈希集合，表直接由 `malloc` 分配，因此可以在 `operator new` 和 `operator delete` 中使用。
+ * 只有集合中的内存块在释放时才被统计，统计开始之前分配的、或在其他线程中分配的内存块的释放不影响计数。
+ */
+class TrackedBlocks {
+public:
+    /// @brief 清空后保留的最大容量，超过时释放表，避免每次清空都要写入一张很大的表。
+    static constexpr size_t RETAINED_CAPACITY = 1024;
+
+    TrackedBlocks() = default;
+    TrackedBlocks(const TrackedBlocks&) = delete;
+    TrackedBlocks& operator=(const TrackedBlocks&) = delete;
+
+    /// @brief 析构函数。线程结束时其他析构函数仍可能释放内存，因此释放表后恢复为空集合。
+    ~TrackedBlocks() {
+        std::free(slots);
+        slots = nullptr;
+        capacity = 0;
+        count = 0;
+    }
+
+    /// @brief 加入一个内存块，表无法扩容时不加入。
+    void insert(const void* pointer) {
+        if ((count + 1) * 2 > capacity && !grow())
+        {
+            return;
+        }
+        size_t slot = indexOf(pointer);
+        while (slots[slot] != nullptr)
+        {
+            slot = (slot + 1) & (capacity - 1);
+        }
+        slots[slot] = pointer;
+        count++;
+    }
+
+    /// @brief 移除一个内存块，返回它是否在集合中。
+    bool erase(const void* pointer) {
+        if (count == 0)
+        {
+            return false;
+        }
+        size_t slot = indexOf(pointer);
+        while (slots[slot] != pointer)
+        {
+            if (slots[slot] == nullptr)
+            {
+                return false;
+            }
+            slot = (slot + 1) & (capacity - 1);
+        }
+        // 向后移动同一探测序列中的后续项，不使用墓碑
+        size_t hole = slot;
+        for (size_t next = (hole + 1) & (capacity - 1); slots[next] != nullptr; next = (next + 1) & (capacity - 1))
+        {
+            size_t home = indexOf(slots[next]);
+            if (((next - home) & (capacity - 1)) >= ((next - hole) & (capacity - 1)))
+            {
+                slots[hole] = slots[next];
+                hole = next;
+            }
+        }
+        slots[hole] = nullptr;
+        count--;
+        return true;
+    }
+
+    /// @brief 清空集合。
+    void clear() {
+        if (capacity > RETAINED_CAPACITY)
+        {
+            std::free(slots);
+            slots = nullptr;
+            capacity = 0;
+        }
+        else if (count != 0)
+        {
+            std::memset(static_cast<void*>(slots), 0, capacity * sizeof(slots[0]));
+        }
+        count = 0;
+    }
+
+private:
+    const void** slots = nullptr;
+    size_t capacity = 0;
+    size_t count = 0;
+
+    size_t indexOf(const void* pointer) const {
+        uint64_t hash = static_cast<uint64_t>(reinterpret_cast<uintptr_t>(pointer)) * 0x9E3779B97F4A7C15ULL;
+        return static_cast<size_t>(hash >> 32) & (capacity - 1);
+    }
+
+    bool grow() {
+        size_t newCapacity = capacity == 0 ? 64 : capacity * 2;
+        const void** newSlots = static_cast<const void**>(std::calloc(newCapacity, sizeof(slots[0])));
+        if (newSlots == nullptr)
+        {
+            return false;
+        }
+        const void** oldSlots = slots;
+        size_t oldCapacity = capacity;
+        slots = newSlots;
+        capacity = newCapacity;
+        count = 0;
+        for (size_t i = 0; i < oldCapacity; i++)
+        {
+            if (oldSlots[i] != nullptr)
+            {
+                insert(oldSlots[i]);
+            }
+        }
+        std::free(oldSlots);
+        return true;
+    }
+};
+
+/**
+ * @brief 叶子测试的内存分配统计。
+ *
+ * 默认关闭；调用 `enable()` 后，`TestExecutorClass::ProceedTest()` 统计运行测试期间本线程的分配次数、其中被释放的次数、
+ * 分配的字节数和比开始时多占用的最大字节数，写入叶子结果的 `allocations`；`TestContainerClass::ProceedTest()` 在开始和结束时
+ * 读取 `/proc/self/statm` 中的常驻内存。叶子节点的父节点在汇总中与运行时间一并输出。
+ *
+ * 框架自身的记录（例如失败断言保存的操作数、`TestResult` 的复制）处于 `Suppress` 范围内，不计入叶子的统计。
+ * 释放只统计本线程在本次统计期间分配的内存块，因此统计开始之前分配的内存（例如测试名称）在测试中被释放时不影响计数。
+ *
+ * 示例：
+ * ```cpp
+ * #define FUZZ_TEST_SCHEMA_ALLOCATION_TRACKING
+ * #include "FuzzTestSchema.h"
+ *
+ * AllocationTracker::enable();
+ * rootClass.ProceedTest("ShowCase");
+ * ```
+ */
+class AllocationTracker {
+public:
+    /**
+     * @brief 在其生命周期内不统计本线程的分配和释放。
+     */
+    class Suppress {
+    public:
+        Suppress() { enterSuppressed(); }
+        ~Suppress() { leaveSuppressed(); }
+        Suppress(const Suppress&) = delete;
+        Suppress& operator=(const Suppress&) = delete;
+    };
+
+    /// @brief 单次测试开始时的计数快照。
+    struct Snapshot {
+        bool valid = false;
+        AllocationCounters counters;
+    };
+
+    /// @brief 启用或关闭分配统计。
+    static void enable(bool enabled = true) { enabledFlag().store(enabled, std::memory_order_relaxed); }
+
+    /// @brief 是否启用了分配统计。
+    static bool isEnabled() { return enabledFlag().load(std::memory_order_relaxed); }
+
+    /// @brief 是否定义了 `FUZZ_TEST_SCHEMA_ALLOCATION_TRACKING`，即全局的 `operator new` 已被替换。
+    static bool hooksInstalled() { return hooksFlag().load(std::memory_order_relaxed); }
+
+    /// @brief 开始统计一次测试，未启用时返回无效的快照。此前分配的内存块的释放不计入本次统计。
+    static Snapshot start() {
+        Snapshot snapshot;
+        if (!isEnabled())
+        {
+            return snapshot;
+        }
+        trackedBlocks().clear();
+        AllocationCounters& current = counters();
+        snapshot.valid = true;
+        snapshot.counters = current;
+        current.peakLiveBytes = current.liveBytes;
+        return snapshot;
+    }
+
+    /**
+     * @brief 结束统计一次测试，将与 `start()` 之间的差值写入 stats。
+     *
+     * @param snapshot `start()` 的返回值，无效时不做任何处理。
+     * @param stats 写入的目标。
+     */
+    static void finish(const Snapshot& snapshot, AllocationStats& stats) {
+        if (!snapshot.valid)
+        {
+            return;
+        }
+        AllocationCounters& current = counters();
+        AllocationStats leaf;
+        leaf.tests = 1;
+        leaf.allocations = current.allocations - snapshot.counters.allocations;
+        leaf.frees = current.frees - snapshot.counters.frees;
+        leaf.bytesAllocated = current.bytesAllocated - snapshot.counters.bytesAllocated;
+        int64_t peak = current.peakLiveBytes - snapshot.counters.liveBytes;
+        leaf.peakLiveBytes = peak > 0 ? static_cast<uint64_t>(peak) : 0;
+        stats = leaf;
+    }
+
+    /// @brief 读取进程当前的常驻内存字节数，失败时返回 0。
+    static uint64_t residentBytes() {
+        int fd = ::open("/proc/self/statm", O_RDONLY | O_CLOEXEC);
+        if (fd < 0)
+        {
+            return 0;
+        }
+        char buffer[128];
+        ssize_t size = ::read(fd, buffer, sizeof(buffer) - 1);
+        ::close(fd);
+        if (size <= 0)
+        {
+            return 0;
+        }
+        buffer[size] = '\0';
+        unsigned long long totalPages = 0;
+        unsigned long long residentPages = 0;
+        if (std::sscanf(buffer, "%llu %llu", &totalPages, &residentPages) != 2)
+        {
+            return 0;
+        }
+        return static_cast<uint64_t>(residentPages) * static_cast<uint64_t>(sysconf(_SC_PAGESIZE));
+    }
+
+    /// @brief 记录一次分配，由替换的 `operator new` 调用。
+    static void noteAllocation(void* pointer) {
+        if (pointer == nullptr || !isEnabled())
+        {
+            return;
+        }
+        AllocationCounters& current = counters();
+        if (current.suppressed != 0)
+        {
+            return;
+        }
+        trackedBlocks().insert(pointer);
+        int64_t size = static_cast<int64_t>(malloc_usable_size(pointer));
+        current.allocations++;
+        current.bytesAllocated += static_cast<uint64_t>(size);
+        current.liveBytes += size;
+        current.peakLiveBytes = current.liveBytes > current.peakLiveBytes ? current.liveBytes : current.peakLiveBytes;
+    }
+
+    /// @brief 记录一次释放，由替换的 `operator delete` 调用。只统计本线程在本次统计期间分配的内存块。
+    static void noteFree(void* pointer) {
+        if (pointer == nullptr || !isEnabled())
+        {
+            return;
+        }
+        // 即使处于不统计的范围内也要从集合中移除，以免地址被重新分配后误判
+        AllocationCounters& current = counters();
+        if (!trackedBlocks().erase(pointer) || current.suppressed != 0)
+        {
+            return;
+        }
+        current.frees++;
+        current.liveBytes -= static_cast<int64_t>(malloc_usable_size(pointer));
+    }
+
+    /// @brief 进入不统计的范围，必须与 `leaveSuppressed()` 成对调用。
+    static void enterSuppressed() { counters().suppressed++; }
+
+    /// @brief 离开不统计的范围。
+    static void leaveSuppressed() {
+        unsigned& suppressed = counters().suppressed;
+        suppressed -= suppressed != 0 ? 1 : 0;
+    }
+
+    static std::atomic<bool>& hooksFlag() {
+        static std::atomic<bool> installed{false};
+        return installed;
+    }
+
+private:
+    static std::atomic<bool>& enabledFlag() {
+        static std::atomic<bool> enabled{false};
+        return enabled;
+    }
+
+    static AllocationCounters& counters() {
+        static thread_local AllocationCounters current{};
+        return current;
+    }
+
+    static TrackedBlocks& trackedBlocks() {
+        static thread_local TrackedBlocks blocks;
+        return blocks;
+    }
+};
+
+#ifdef FUZZ_TEST_SCHEMA_ALLOCATION_TRACKING
+// 替换的 `operator new` 由 `malloc` 实现，`free` 正是与之匹配的释放函数；
+// gcc 把 `operator delete` 内联到调用处后会误报不匹配，因此在替换函数中关闭这一警告
+#if defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 11
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+static const bool fuzzTestSchemaAllocationHooks = (AllocationTracker::hooksFlag().store(true), true);
+
+void* operator new(std::size_t size) {
+    void* pointer = std::malloc(size == 0 ? 1 : size);
+    if (pointer == nullptr)
+    {
+        throw std::bad_alloc();
+    }
+    AllocationTracker::noteAllocation(pointer);
+    return pointer;
+}
+
+void* operator new[](std::size_t size) {
+    return operator new(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    void* pointer = std::malloc(size == 0 ? 1 : size);
+    AllocationTracker::noteAllocation(pointer);
+    return pointer;
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t& tag) noexcept {
+    return operator new(size, tag);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment) {
+    void* pointer = nullptr;
+    if (posix_memalign(&pointer, static_cast<std::size_t>(alignment), size == 0 ? 1 : size) != 0)
+    {
+        throw std::bad_alloc();
+    }
+    AllocationTracker::noteAllocation(pointer);
+    return pointer;
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment) {
+    return operator new(size, alignment);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    void* pointer = nullptr;
+    if (posix_memalign(&pointer, static_cast<std::size_t>(alignment), size == 0 ? 1 : size) != 0)
+    {
+        return nullptr;
+    }
+    AllocationTracker::noteAllocation(pointer);
+    return pointer;
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t& tag) noexcept {
+    return operator new(size, alignment, tag);
+}
+
+void operator delete(void* pointer) noexcept {
+    AllocationTracker::noteFree(pointer);
+    std::free(pointer);
+}
+
+void operator delete[](void* pointer) noexcept { operator delete(pointer); }
+void operator delete(void* pointer, std::size_t) noexcept { operator delete(pointer); }
+void operator delete[](void* pointer, std::size_t) noexcept { operator delete(pointer); }
+void operator delete(void* pointer, const std::nothrow_t&) noexcept { operator delete(pointer); }
+void operator delete[](void* pointer, const std::nothrow_t&) noexcept { operator delete(pointer); }
+void operator delete(void* pointer, std::align_val_t) noexcept { operator delete(pointer); }
+void operator delete[](void* pointer, std::align_val_t) noexcept { operator delete(pointer); }
+void operator delete(void* pointer, std::size_t, std::align_val_t) noexcept { operator delete(pointer); }
+void operator delete[](void* pointer, std::size_t, std::align_val_t) noexcept { operator delete(pointer); }
+void operator delete(void* pointer, std::align_val_t, const std::nothrow_t&) noexcept { operator delete(pointer); }
+void operator delete[](void* pointer, std::align_val_t, const std::nothrow_t&) noexcept { operator delete(pointer); }
+#if defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 11
+#pragma GCC diagnostic pop
+#endif
+#endif
+
+#endif
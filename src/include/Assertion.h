@@ -0,0 +1,264 @@
+#ifndef ASSERTION_H
+#define ASSERTION_H
+#include <cstdint>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+/**
+ * @brief 值格式化器。
+ *
+ * 断言失败时，非算术类型的操作数通过此模板转换为文本。默认实现按以下顺序选择：
+ * 字符串类型原样输出（带引号），支持 `begin()`/`end()` 的容器输出为 `[a, b, c]`，
+ * `std::pair` 输出为 `(first, second)`，其余类型使用 `operator<<`。
+ *
+ * 用户可以为自己的类型特化此模板，例如：
+ * ```cpp
+ * template <> struct ValueFormatter<MyType> {
+ *     static void format(std::string& out, const MyType& value) { out += value.describe(); }
+ * };
+ * ```
+ */
+template <typename T, typename = void>
+struct ValueFormatter {
+    static void format(std::string& out, const T& value) {
+        std::ostringstream stream;
+        stream << value;
+        out += stream.str();
+    }
+};
+
+/**
+ * @brief 将任意值追加格式化到字符串末尾。
+ *
+ * 算术类型使用 `std::to_string`，其余类型交给 `ValueFormatter`。
+ */
+template <typename T>
+void formatValue(std::string& out, const T& value);
+
+template <typename T, typename = void>
+struct IsIterable : std::false_type {};
+
+template <typename T>
+struct IsIterable<T, std::void_t<decltype(std::begin(std::declval<const T&>())), decltype(std::end(std::declval<const T&>()))>> : std::true_type {};
+
+template <typename T>
+struct IsStringLike : std::integral_constant<bool, std::is_convertible<const T&, std::string_view>::value> {};
+
+/// @brief 字符串类型的格式化器。
+template <typename T>
+struct ValueFormatter<T, std::enable_if_t<IsStringLike<T>::value>> {
+    static void format(std::string& out, const T& value) {
+        out += '"';
+        out += std::string_view(value);
+        out += '"';
+    }
+};
+
+/// @brief 容器类型的格式化器。
+template <typename T>
+struct ValueFormatter<T, std::enable_if_t<IsIterable<T>::value && !IsStringLike<T>::value>> {
+    static void format(std::string& out, const T& value) {
+        out += '[';
+        bool first = true;
+        for (const auto& element : value)
+        {
+            if (!first)
+            {
+                out += ", ";
+            }
+            first = false;
+            formatValue(out, element);
+        }
+        out += ']';
+    }
+};
+
+/// @brief `std::pair` 的格式化器。
+template <typename A, typename B>
+struct ValueFormatter<std::pair<A, B>> {
+    static void format(std::string& out, const std::pair<A, B>& value) {
+        out += '(';
+        formatValue(out, value.first);
+        out += ", ";
+        formatValue(out, value.second);
+        out += ')';
+    }
+};
+
+template <typename T>
+void formatValue(std::string& out, const T& value) {
+    if constexpr (std::is_same<T, bool>::value)
+    {
+        out += value ? "true" : "false";
+    }
+    else if constexpr (std::is_arithmetic<T>::value)
+    {
+        out += std::to_string(value);
+    }
+    else
+    {
+        ValueFormatter<T>::format(out, value);
+    }
+}
+
+/// @brief 断言的种类。
+enum class AssertionKind : uint8_t {
+    EQ,         // 相等
+    NE,         // 不相等
+    FEQ,        // 在容差范围内相等
+    FNE,        // 超出容差范围
+    MESSAGE     // 自定义的错误信息
+};
+
+/// @brief 断言操作数的存储形式。
+enum class OperandKind : uint8_t {
+    SIGNED,     // 有符号整数
+    UNSIGNED,   // 无符号整数
+    FLOATING,   // 浮点数
+    BOOLEAN,    // 布尔值
+    TEXT        // 已格式化的文本，保存在文本池中
+};
+
+/**
+ * @brief 断言操作数。
+ *
+ * 算术类型直接保存原始值；其他类型在失败时格式化为文本，保存其在文本池中的位置。
+ */
+union AssertionOperand {
+    int64_t signedValue;
+    uint64_t unsignedValue;
+    double floatingValue;
+    struct {
+        uint32_t offset;
+        uint32_t length;
+    } text;
+};
+
+/**
+ * @brief 一条失败断言的紧凑记录。
+ *
+ * 记录只保存原始操作数，错误信息在输出报告时才由 `formatAssertion` 生成。
+ * 变量名在记录时复制到文本池中，因此调用者传入的变量名不需要比记录活得更久。
+ */
+struct AssertionRecord {
+    uint32_t nameOffset;
+    uint32_t nameLength;
+    uint32_t testIndex;
+    AssertionKind kind;
+    OperandKind operandKind;
+    AssertionOperand lhs;
+    AssertionOperand rhs;
+    AssertionOperand tolerance;
+};
+
+/**
+ * @brief 将操作数保存到断言记录中。
+ *
+ * @param value 操作数。
+ * @param kind 输出操作数的存储形式。
+ * @param textPool 非算术类型的操作数格式化后追加到此文本池。
+ * @return 返回保存后的操作数。
+ */
+template <typename T>
+AssertionOperand captureOperand(const T& value, OperandKind& kind, std::string& textPool) {
+    AssertionOperand operand;
+    if constexpr (std::is_same<T, bool>::value)
+    {
+        kind = OperandKind::BOOLEAN;
+        operand.unsignedValue = value ? 1 : 0;
+    }
+    else if constexpr (std::is_floating_point<T>::value)
+    {
+        kind = OperandKind::FLOATING;
+        operand.floatingValue = static_cast<double>(value);
+    }
+    else if constexpr (std::is_integral<T>::value && std::is_signed<T>::value)
+    {
+        kind = OperandKind::SIGNED;
+        operand.signedValue = static_cast<int64_t>(value);
+    }
+    else if constexpr (std::is_integral<T>::value)
+    {
+        kind = OperandKind::UNSIGNED;
+        operand.unsignedValue = static_cast<uint64_t>(value);
+    }
+    else if constexpr (std::is_enum<T>::value)
+    {
+        return captureOperand(static_cast<std::underlying_type_t<T>>(value), kind, textPool);
+    }
+    else
+    {
+        kind = OperandKind::TEXT;
+        size_t offset = textPool.size();
+        ValueFormatter<T>::format(textPool, value);
+        operand.text.offset = static_cast<uint32_t>(offset);
+        operand.text.length = static_cast<uint32_t>(textPool.size() - offset);
+    }
+    return operand;
+}
+
+/// @brief 将保存的操作数还原为文本。
+inline std::string formatOperand(const AssertionOperand& operand, OperandKind kind, const std::string& textPool) {
+    switch (kind)
+    {
+    case OperandKind::SIGNED:
+        return std::to_string(operand.signedValue);
+    case OperandKind::UNSIGNED:
+        return std::to_string(operand.unsignedValue);
+    case OperandKind::FLOATING:
+        return std::to_string(operand.floatingValue);
+    case OperandKind::BOOLEAN:
+        return operand.unsignedValue ? "true" : "false";
+    case OperandKind::TEXT:
+        return textPool.substr(operand.text.offset, operand.text.length);
+    }
+    return "";
+}
+
+/**
+ * @brief 将断言记录中引用文本池的位置整体偏移。
+ *
+ * 把一个文本池追加到另一个文本池末尾后，用于修正原记录中的位置。
+ *
+ * @param record 断言记录。
+ * @param delta 偏移量，即原文本池在新文本池中的起始位置。
+ */
+inline void rebaseAssertion(AssertionRecord& record, uint32_t delta) {
+    record.nameOffset += delta;
+    if (record.operandKind == OperandKind::TEXT)
+    {
+        record.lhs.text.offset += delta;
+        record.rhs.text.offset += delta;
+        record.tolerance.text.offset += delta;
+    }
+}
+
+/**
+ * @brief 生成一条失败断言的错误信息。
+ *
+ * @param record 断言记录。
+ * @param textPool 记录所引用的文本池。
+ * @return 返回不带任何样式的错误信息。
+ */
+inline std::string formatAssertion(const AssertionRecord& record, const std::string& textPool) {
+    std::string name = textPool.substr(record.nameOffset, record.nameLength);
+    if (record.kind == AssertionKind::MESSAGE)
+    {
+        return name;
+    }
+    std::string lhs = formatOperand(record.lhs, record.operandKind, textPool);
+    std::string rhs = formatOperand(record.rhs, record.operandKind, textPool);
+    std::string relation = record.kind == AssertionKind::EQ || record.kind == AssertionKind::FEQ ? " = " : " ≠ ";
+    std::string message = "Test " + std::to_string(record.testIndex) + ": Expect " + name + relation + lhs;
+    if (record.kind == AssertionKind::FEQ || record.kind == AssertionKind::FNE)
+    {
+        message += " with fp_tolerance of " + formatOperand(record.tolerance, record.operandKind, textPool);
+    }
+    return message + ", but get: " + rhs + ".";
+}
+
+#endif
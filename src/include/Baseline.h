@@ -0,0 +1,346 @@
+#ifndef BASELINE_H
+#define BASELINE_H
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <new>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <Macros.h>
+
+/**
+ * @brief 两组样本的比较结果。
+ */
+struct BaselineComparison {
+    /// @brief 比较的结论。
+    enum class Verdict {
+        UNCHANGED,      // 没有统计上显著的变化
+        SLOWER,         // 显著变慢
+        FASTER,         // 显著变快
+        INSUFFICIENT    // 样本不足，无法判断
+    };
+
+    Verdict verdict = Verdict::INSUFFICIENT;
+
+    /// @brief 当前中位数相对基线中位数的变化，例如 0.15 表示慢了 15%。
+    double relativeChange = 0;
+
+    /// @brief 双侧 p 值。
+    double pValue = 1;
+
+    size_t baselineCount = 0;
+    size_t currentCount = 0;
+
+    /// @brief 生成一行摘要文本。
+    std::string summary() const {
+        if (verdict == Verdict::INSUFFICIENT)
+        {
+            return "Baseline: not enough samples to compare (" + std::to_string(currentCount) + " vs " + std::to_string(baselineCount) + " in baseline)";
+        }
+        char change[32];
+        std::snprintf(change, sizeof(change), "%+.1f%%", relativeChange * 100);
+        char probability[32];
+        std::snprintf(probability, sizeof(probability), "%.3g", pValue);
+        std::string verdictText = verdict == Verdict::SLOWER ? "REGRESSION, " : (verdict == Verdict::FASTER ? "improvement, " : "no significant change, ");
+        return "Baseline: " + verdictText + "median " + change + " (p = " + probability + ", " + std::to_string(currentCount) + " vs " +
+               std::to_string(baselineCount) + " samples)";
+    }
+};
+
+/**
+ * @brief Mann-Whitney U 检验。
+ *
+ * 基于秩的非参数检验，不假设运行时间服从正态分布，对个别极端值也不敏感。
+ * 使用带结（ties）校正的正态近似计算双侧 p 值，适用于每组不少于 8 个左右样本的情形。
+ *
+ * @param baseline 基线样本。
+ * @param current 当前样本。
+ * @return 返回双侧 p 值。
+ */
+inline double mannWhitneyPValue(const std::vector<uint64_t>& baseline, const std::vector<uint64_t>& current) {
+    size_t n1 = current.size();
+    size_t n2 = baseline.size();
+    if (n1 == 0 || n2 == 0)
+    {
+        return 1;
+    }
+    std::vector<std::pair<uint64_t, bool>> combined;
+    combined.reserve(n1 + n2);
+    for (uint64_t value : current)
+    {
+        combined.emplace_back(value, true);
+    }
+    for (uint64_t value : baseline)
+    {
+        combined.emplace_back(value, false);
+    }
+    std::sort(combined.begin(), combined.end());
+
+    double rankSum = 0;
+    double tieCorrection = 0;
+    for (size_t i = 0; i < combined.size();)
+    {
+        size_t j = i;
+        while (j < combined.size() && combined[j].first == combined[i].first)
+        {
+            j++;
+        }
+        double averageRank = (static_cast<double>(i) + static_cast<double>(j) + 1) / 2;
+        for (size_t k = i; k < j; k++)
+        {
+            rankSum += combined[k].second ? averageRank : 0;
+        }
+        double ties = static_cast<double>(j - i);
+        tieCorrection += ties * ties * ties - ties;
+        i = j;
+    }
+
+    double a = static_cast<double>(n1);
+    double b = static_cast<double>(n2);
+    double u = rankSum - a * (a + 1) / 2;
+    double mean = a * b / 2;
+    double n = a + b;
+    double variance = a * b / 12 * ((n + 1) - tieCorrection / (n * (n - 1)));
+    if (variance <= 0)
+    {
+        return 1;
+    }
+    // 连续性校正
+    double z = (std::fabs(u - mean) - 0.5) / std::sqrt(variance);
+    return z <= 0 ? 1 : std::erfc(z / std::sqrt(2.0));
+}
+
+/**
+ * @brief 运行时间基线。
+ *
+ * 以完整的测试名称（即 `testName + "." + subTestName` 形式的路径）为键，保存每个叶子节点父节点下各个叶子的运行时间。
+ * - 记录模式：每个叶子节点的父节点结束时，其叶子的运行时间被记录下来，`save()` 时写入基线文件。
+ * - 比较模式：载入此前保存的基线文件，每个叶子节点的父节点结束时用 Mann-Whitney U 检验与基线中的同名测试比较，
+ *   比较结果作为附加统计信息随汇总一并输出。只有 p 值低于 `significance`、且中位数的变化超过 `minRelativeChange` 时才判定为变化。
+ *
+ * 两种模式可以同时启用，即与上一次的基线比较，同时写入新的基线。
+ *
+ * 基线文件为文本格式，每行对应一个测试：`名称<TAB>样本数<TAB>以空格分隔的纳秒数`。
+ * 每个测试最多保存 `MAX_SAMPLES` 个均匀抽取的样本，因此文件大小与叶子的总数无关。
+ *
+ * 示例：
+ * ```cpp
+ * PerformanceBaseline::instance().compareWith("baseline.txt");
+ * PerformanceBaseline::instance().recordTo("baseline.txt");
+ * rootClass.ProceedTest("ShowCase");
+ * PerformanceBaseline::instance().save();
+ * return PerformanceBaseline::instance().exitCode();
+ * ```
+ */
+class PerformanceBaseline {
+public:
+    /// @brief 每个测试在基线文件中最多保存的样本数量。
+    static constexpr size_t MAX_SAMPLES = 1024;
+
+    /// @brief 全局唯一的基线。
+    static PerformanceBaseline& instance() {
+        static PerformanceBaseline baseline;
+        return baseline;
+    }
+
+    /// @brief 是否启用了记录或比较模式。
+    bool isActive() const { return active; }
+
+    /// @brief 启用记录模式，`save()` 时写入 path。
+    void recordTo(const std::string& path) {
+        std::lock_guard<std::mutex> guard(lock);
+        recordPath = path;
+        active = true;
+    }
+
+    /**
+     * @brief 启用比较模式，载入 path 中的基线。
+     *
+     * 文件无法打开或格式不正确时抛出 `std::runtime_error`。
+     */
+    void compareWith(const std::string& path) {
+        std::ifstream file(path);
+        if (!file)
+        {
+            throw std::runtime_error("PerformanceBaseline: cannot open " + path);
+        }
+        std::map<std::string, std::vector<uint64_t>> loaded;
+        std::string line;
+        while (std::getline(file, line))
+        {
+            size_t nameEnd = line.find('\t');
+            size_t countEnd = nameEnd == std::string::npos ? std::string::npos : line.find('\t', nameEnd + 1);
+            if (countEnd == std::string::npos)
+            {
+                throw std::runtime_error("PerformanceBaseline: invalid baseline file " + path);
+            }
+            std::vector<uint64_t>& samples = loaded[line.substr(0, nameEnd)];
+            std::istringstream values(line.substr(countEnd + 1));
+            uint64_t value;
+            while (values >> value)
+            {
+                samples.push_back(value);
+            }
+        }
+        std::lock_guard<std::mutex> guard(lock);
+        baseline = std::move(loaded);
+        active = true;
+    }
+
+    /**
+     * @brief 设置判定阈值。
+     *
+     * @param significance 显著性水平，p 值低于此值才可能判定为变化。
+     * @param minRelativeChange 中位数的最小相对变化，例如 0.05 表示 5%。
+     * @param minSamples 每组最少的样本数量，不足时不做判断。
+     * @param failOnRegression 出现显著变慢时 `exitCode()` 是否返回非零值。
+     */
+    void setThresholds(double significance, double minRelativeChange, size_t minSamples = 8, bool failOnRegression = true) {
+        std::lock_guard<std::mutex> guard(lock);
+        this->significance = significance;
+        this->minRelativeChange = minRelativeChange;
+        this->minSamples = minSamples;
+        this->failOnRegression = failOnRegression;
+    }
+
+    /**
+     * @brief 记录一个测试的叶子运行时间，并与基线比较。
+     *
+     * 由 `TestResult::finishSubtestBatch` 调用。
+     *
+     * @param testName 完整的测试名称。
+     * @param samples 各个叶子的运行时间（纳秒）。
+     * @return 返回比较结果的摘要，未启用比较模式或基线中没有该测试时返回空字符串。
+     */
+    std::string observe(const std::string& testName, std::vector<uint64_t> samples) {
+        std::lock_guard<std::mutex> guard(lock);
+        std::string summary;
+        auto found = baseline.find(testName);
+        if (found != baseline.end())
+        {
+            BaselineComparison comparison = compare(found->second, samples);
+            regressions += comparison.verdict == BaselineComparison::Verdict::SLOWER;
+            summary = comparison.summary();
+        }
+        if (!recordPath.empty())
+        {
+            recorded[testName] = downsample(std::move(samples));
+        }
+        return summary;
+    }
+
+    /// @brief 按当前阈值比较两组样本。
+    BaselineComparison compare(const std::vector<uint64_t>& baselineSamples, const std::vector<uint64_t>& currentSamples) const {
+        BaselineComparison comparison;
+        comparison.baselineCount = baselineSamples.size();
+        comparison.currentCount = currentSamples.size();
+        if (baselineSamples.size() < minSamples || currentSamples.size() < minSamples)
+        {
+            return comparison;
+        }
+        double baselineMedian = median(baselineSamples);
+        double currentMedian = median(currentSamples);
+        comparison.relativeChange = baselineMedian == 0 ? 0 : currentMedian / baselineMedian - 1;
+        comparison.pValue = mannWhitneyPValue(baselineSamples, currentSamples);
+        comparison.verdict = BaselineComparison::Verdict::UNCHANGED;
+        if (comparison.pValue < significance && std::fabs(comparison.relativeChange) >= minRelativeChange)
+        {
+            comparison.verdict = comparison.relativeChange > 0 ? BaselineComparison::Verdict::SLOWER : BaselineComparison::Verdict::FASTER;
+        }
+        return comparison;
+    }
+
+    /**
+     * @brief 将记录的样本写入基线文件。
+     *
+     * 未启用记录模式时不做任何处理；文件无法写入时抛出 `std::runtime_error`。
+     */
+    void save() {
+        std::lock_guard<std::mutex> guard(lock);
+        if (recordPath.empty())
+        {
+            return;
+        }
+        std::ofstream file(recordPath, std::ios::trunc);
+        for (const auto& entry : recorded)
+        {
+            file << entry.first << '\t' << entry.second.size() << '\t';
+            for (size_t i = 0; i < entry.second.size(); i++)
+            {
+                file << (i == 0 ? "" : " ") << entry.second[i];
+            }
+            file << '\n';
+        }
+        if (!file)
+        {
+            throw std::runtime_error("PerformanceBaseline: failed to write " + recordPath);
+        }
+    }
+
+    /// @brief 显著变慢的测试数量。
+    size_t regressionCount() const {
+        std::lock_guard<std::mutex> guard(lock);
+        return regressions;
+    }
+
+    /// @brief 进程的退出码：出现显著变慢且要求因此失败时返回 1，否则返回 0。
+    int exitCode() const {
+        std::lock_guard<std::mutex> guard(lock);
+        return failOnRegression && regressions > 0 ? 1 : 0;
+    }
+
+    /**
+     * @brief fork 之后在子进程中重新构造锁。
+     *
+     * fork 时其他线程可能正持有锁。子进程不调用 `save()`，它记录的样本不会写入基线文件。
+     */
+    void abandonAfterFork() { new (&lock) std::mutex(); }
+
+private:
+    PerformanceBaseline() {}
+
+    mutable std::mutex lock;
+    std::atomic<bool> active{false};
+    std::string recordPath;
+    std::map<std::string, std::vector<uint64_t>> baseline;
+    std::map<std::string, std::vector<uint64_t>> recorded;
+    double significance = 0.01;
+    double minRelativeChange = 0.05;
+    size_t minSamples = 8;
+    bool failOnRegression = true;
+    size_t regressions = 0;
+
+    static double median(std::vector<uint64_t> samples) {
+        size_t middle = samples.size() / 2;
+        std::nth_element(samples.begin(), samples.begin() + middle, samples.end());
+        double upper = static_cast<double>(samples[middle]);
+        if (samples.size() % 2 == 1)
+        {
+            return upper;
+        }
+        double lower = static_cast<double>(*std::max_element(samples.begin(), samples.begin() + middle));
+        return (lower + upper) / 2;
+    }
+
+    static std::vector<uint64_t> downsample(std::vector<uint64_t> samples) {
+        if (samples.size() <= MAX_SAMPLES)
+        {
+            return samples;
+        }
+        std::vector<uint64_t> kept(MAX_SAMPLES);
+        for (size_t i = 0; i < MAX_SAMPLES; i++)
+        {
+            kept[i] = samples[i * samples.size() / MAX_SAMPLES];
+        }
+        return kept;
+    }
+};
+
+#endif
@@ -0,0 +1,117 @@
+#ifndef BATCH_EXECUTOR_H
+#define BATCH_EXECUTOR_H
+#include <string>
+#include <vector>
+#include <TestResult.h>
+#include <Sharding.h>
+
+/// @brief 默认每批包含的叶子数量。
+static constexpr size_t DEFAULT_BATCH_SIZE = 256;
+
+/**
+ * @brief 以批的方式执行叶子节点父节点下的所有叶子。
+ *
+ * 叶子被划分为若干批，每批至多 batchSize 个，批与批之间并行执行。每批只计时一次、调用一次 runBatch，
+ * 再由 `TestResult::appendLeafBatch()` 展开为逐个叶子的记录，因此报告、进度和汇总与逐个执行时相同。
+ * 启用 `Sharding` 时只执行属于当前分片的叶子，此时每批的输入会被复制到一个连续的缓冲区中。
+ * 整批超出叶子测试的时间预算时，批中的每个叶子都记为超时失败。
+ *
+ * @param result 叶子节点的父节点的测试结果。
+ * @param inputs 所有叶子的输入，第 i 个元素对应 `testIndex` 为 i 的叶子。
+ * @param batchSize 每批包含的叶子数量。
+ * @param runBatch 形如 `void(Span<const Input>, BatchResult&)` 的函数。
+ */
+template <typename Input, typename RunBatch>
+void runLeafBatches(TestResult& result, Span<const Input> inputs, size_t batchSize, RunBatch&& runBatch) {
+    ShardFilter filter = Sharding::filter(result.testName);
+    size_t owned = filter.ownedCount(inputs.size());
+    result.otherShardCount = static_cast<ssize_t>(inputs.size() - owned);
+    batchSize = batchSize == 0 ? DEFAULT_BATCH_SIZE : batchSize;
+    size_t batchCount = (owned + batchSize - 1) / batchSize;
+    parallelFor(TestScheduler::pool(), batchCount, [&](size_t b) {
+        size_t begin = b * batchSize;
+        size_t end = begin + batchSize < owned ? begin + batchSize : owned;
+        if (Watchdog::shouldStop())
+        {
+            for (size_t k = begin; k < end; k++)
+            {
+                result.skipSubTest();
+            }
+            return;
+        }
+        std::vector<Input> gathered;
+        Span<const Input> batchInputs = inputs.subspan(begin, end - begin);
+        if (filter.count > 1)
+        {
+            gathered.reserve(end - begin);
+            for (size_t k = begin; k < end; k++)
+            {
+                gathered.push_back(inputs[filter.leaf(k)]);
+            }
+            batchInputs = Span<const Input>(gathered);
+        }
+
+        BatchResult batch(end - begin);
+        Watchdog::Watch watch(WatchKind::LEAF, [&] { return "batch of tests " + std::to_string(filter.leaf(begin)) + " to " + std::to_string(filter.leaf(end - 1)); });
+        PerfSample counterStart = PerfCounters::start();
+        AllocationTracker::Snapshot allocationStart = AllocationTracker::start();
+        START_TIMER;
+        runBatch(batchInputs, batch);
+        batch.runTime = FINISH_TIMER;
+        AllocationTracker::finish(allocationStart, batch.allocations);
+        PerfCounters::finish(counterStart, batch.counters);
+        if (watch.finish())
+        {
+            for (size_t offset = 0; offset < batch.size(); offset++)
+            {
+                batch.fail(offset, watch.describe());
+            }
+        }
+        result.appendLeafBatch(batch, [&](size_t offset) { return filter.leaf(begin + offset); });
+    });
+}
+
+/**
+ * @brief 批处理测试执行者类。
+ *
+ * 与每个输入构造一个 `TestExecutorClass` 不同，批处理执行者在每个叶子节点的父节点中只构造一次，
+ * 每次以 `RunBatch()` 处理一批连续的输入，并通过 `BatchResult` 返回通过位图和少量的失败记录。
+ * 适用于单个检查的开销远小于框架开销的场景，例如可以向量化的简单检查。
+ * 由容器类通过 `RunSubTestBatches()` 调用。
+ *
+ * 示例：
+ * ```cpp
+ * class LengthBatchExecutorClass : public BatchTestExecutorClass<std::string>
+ * {
+ * public:
+ *     void RunBatch(Span<const std::string> inputs, BatchResult& result) override
+ *     {
+ *         for (size_t i = 0; i < inputs.size(); i++)
+ *         {
+ *             if (inputs[i].empty())
+ *             {
+ *                 result.fail(i, "Expect string length ≠ 0");
+ *             }
+ *         }
+ *     }
+ * };
+ * ```
+ *
+ * @tparam Input 单个叶子的输入类型。
+ */
+template <typename Input>
+class BatchTestExecutorClass {
+public:
+    virtual ~BatchTestExecutorClass() {}
+
+    /// @brief 执行一批叶子测试。
+    /// @param inputs 这一批叶子的输入。
+    /// @param result 这一批叶子的结果，初始时全部通过。
+    /// @details 并行模式下会在多个线程中同时调用，其中只应读取共享数据。
+    virtual void RunBatch(Span<const Input> inputs, BatchResult& result) = 0;
+
+    /// @brief 每批包含的叶子数量。
+    virtual size_t BatchSize() const { return DEFAULT_BATCH_SIZE; }
+};
+
+#endif
@@ -0,0 +1,117 @@
+#ifndef BATCH_RESULT_H
+#define BATCH_RESULT_H
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <string>
+#include <utility>
+#include <vector>
+#include <PerfCounters.h>
+#include <AllocationTracker.h>
+
+/**
+ * @brief 连续元素的视图。
+ *
+ * 与 C++20 的 `std::span<T>` 相同，只保存指针和长度，复制没有开销；`Span<const T>` 为只读视图。
+ *
+ * @tparam T 元素类型。
+ */
+template <typename T>
+class Span {
+public:
+    Span() {}
+    Span(T* data, size_t size) : pointer(data), count(size) {}
+
+    /// @brief 引用一个连续容器（例如 `std::vector` 或 `std::array`）中的全部元素。
+    template <typename Container, typename = decltype(std::data(std::declval<Container&>()))>
+    Span(Container& container) : pointer(std::data(container)), count(std::size(container)) {}
+
+    T* data() const { return pointer; }
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    T& operator[](size_t index) const { return pointer[index]; }
+    T* begin() const { return pointer; }
+    T* end() const { return pointer + count; }
+
+    /// @brief 从 offset 开始的 length 个元素。
+    Span subspan(size_t offset, size_t length) const { return Span(pointer + offset, length); }
+
+private:
+    T* pointer = nullptr;
+    size_t count = 0;
+};
+
+/**
+ * @brief 一批叶子测试的结果。
+ *
+ * 以位图记录每个叶子是否通过（第 i 位为 1 表示通过），初始时全部通过；失败的叶子可以附带错误信息。
+ * 批处理的测试逻辑既可以逐个调用 `fail()`，也可以在向量化的循环中直接写入 `maskWords()`，每个字保存 64 个叶子的结果。
+ * 运行时间、性能计数器和内存分配统计由框架按整批测量后填写。
+ */
+class BatchResult {
+public:
+    /// @brief 一条失败记录。
+    struct Failure {
+        /// @brief 叶子在批中的位置。
+        uint32_t offset;
+        std::string message;
+    };
+
+    /// @brief 构造函数。
+    /// @param count 批中叶子的数量。
+    explicit BatchResult(size_t count) : count(count), passBits((count + 63) / 64, ~uint64_t(0)) {
+        if (count % 64 != 0)
+        {
+            passBits.back() = (uint64_t(1) << (count % 64)) - 1;
+        }
+    }
+
+    /// @brief 批中叶子的数量。
+    size_t size() const { return count; }
+
+    /// @brief 第 offset 个叶子是否通过。
+    bool passed(size_t offset) const { return (passBits[offset >> 6] >> (offset & 63)) & 1; }
+
+    /// @brief 将第 offset 个叶子标记为失败。
+    void fail(size_t offset) { passBits[offset >> 6] &= ~(uint64_t(1) << (offset & 63)); }
+
+    /// @brief 将第 offset 个叶子标记为失败，并附带一条错误信息。同一个叶子可以有多条错误信息。
+    void fail(size_t offset, std::string message) {
+        fail(offset);
+        failureRecords.push_back(Failure{static_cast<uint32_t>(offset), std::move(message)});
+    }
+
+    /// @brief 通过位图，第 w 个字的第 b 位对应第 `w * 64 + b` 个叶子；不应设置超出叶子数量的位。
+    uint64_t* maskWords() { return passBits.data(); }
+    const uint64_t* maskWords() const { return passBits.data(); }
+    size_t maskWordCount() const { return passBits.size(); }
+
+    /// @brief 失败的叶子数量。
+    size_t failedCount() const {
+        size_t passedCount = 0;
+        for (uint64_t word : passBits)
+        {
+            passedCount += static_cast<size_t>(__builtin_popcountll(word));
+        }
+        return count - passedCount;
+    }
+
+    /// @brief 附带错误信息的失败记录，按记录的先后顺序排列。
+    const std::vector<Failure>& failures() const { return failureRecords; }
+
+    /// @brief 整批的运行时间（纳秒），由框架填写。
+    uint64_t runTime = 0;
+
+    /// @brief 整批的性能计数器，由框架在启用 `PerfCounters` 时填写。
+    PerfCounterSet counters;
+
+    /// @brief 整批的内存分配统计，由框架在启用 `AllocationTracker` 时填写。
+    AllocationStats allocations;
+
+private:
+    size_t count;
+    std::vector<uint64_t> passBits;
+    std::vector<Failure> failureRecords;
+};
+
+#endif
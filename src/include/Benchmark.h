@@ -0,0 +1,269 @@
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <FuzzTestSchema.h>
+
+/**
+ * @brief 阻止编译器将一个值优化掉。
+ *
+ * 编译器必须认为该值已经被读取（对于非 const 引用，还可能被修改），因此产生这个值的计算不会被删除。
+ */
+template <typename T>
+inline __attribute__((always_inline)) void DoNotOptimize(const T& value) {
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+template <typename T>
+inline __attribute__((always_inline)) void DoNotOptimize(T& value) {
+    asm volatile("" : "+r,m"(value) : : "memory");
+}
+
+/**
+ * @brief 内存屏障。
+ *
+ * 强制编译器认为所有内存都可能被读写，使此前的写入不会因为“结果未被使用”而被删除。
+ */
+inline __attribute__((always_inline)) void ClobberMemory() {
+    asm volatile("" : : : "memory");
+}
+
+/**
+ * @brief 测量锁。
+ *
+ * 基准测试和 A/B 比较在测量期间持有此锁，即使启用了并行模式也不会同时测量，以免互相干扰。
+ */
+inline std::mutex& measurementMutex() {
+    static std::mutex mutex;
+    return mutex;
+}
+
+/**
+ * @brief 基准测试的参数。
+ */
+struct BenchmarkOptions {
+    /// @brief 预热时间，期间的执行不计入结果。
+    std::chrono::milliseconds warmupTime{50};
+
+    /// @brief 测量的总时间，平均分配给每个样本。
+    std::chrono::milliseconds measureTime{500};
+
+    /// @brief 样本数量。每个样本连续执行同样多次，取平均值作为一个每次执行时间的观测值。
+    size_t samples = 30;
+
+    /// @brief 每个样本最多执行的次数。
+    uint64_t maxIterations = uint64_t(1) << 30;
+};
+
+/**
+ * @brief 基准测试的统计结果。
+ */
+struct BenchmarkStats {
+    /// @brief 剔除离群值后的平均每次执行时间（纳秒）。
+    double nanosecondsPerOp = 0;
+
+    /// @brief 每个样本执行的次数。
+    uint64_t iterations = 0;
+
+    /// @brief 保留的样本数量。
+    size_t samples = 0;
+
+    /// @brief 被剔除的离群样本数量。
+    size_t outliers = 0;
+
+    /// @brief 每次执行处理的字节数，为 0 时不统计吞吐量。
+    uint64_t bytesPerOp = 0;
+
+    /// @brief 每秒执行次数。
+    double opsPerSecond() const { return nanosecondsPerOp <= 0 ? 0 : 1e9 / nanosecondsPerOp; }
+
+    /// @brief 每秒处理的字节数。
+    double bytesPerSecond() const { return opsPerSecond() * static_cast<double>(bytesPerOp); }
+
+    /// @brief 生成一行摘要文本。
+    std::string summary() const {
+        char buffer[32];
+        std::snprintf(buffer, sizeof(buffer), "%.2f ns", nanosecondsPerOp);
+        std::string perOp = nanosecondsPerOp < 1000 ? std::string(buffer) : formatTime(static_cast<uint64_t>(nanosecondsPerOp));
+        std::string text = perOp + "/op, " + formatScaled(opsPerSecond(), "") + " ops/s";
+        if (bytesPerOp != 0)
+        {
+            text += ", " + formatScaled(bytesPerSecond(), "B") + "/s";
+        }
+        return text + " (" + std::to_string(samples) + " samples of " + std::to_string(iterations) + " iterations, " +
+               std::to_string(outliers) + " outliers rejected)";
+    }
+
+    /// @brief 以 K/M/G 为单位格式化数值，保留三位有效数字。
+    static std::string formatScaled(double value, const std::string& unit) {
+        static const char* prefixes[] = {"", " K", " M", " G", " T"};
+        size_t prefix = 0;
+        while (value >= 1000 && prefix + 1 < sizeof(prefixes) / sizeof(prefixes[0]))
+        {
+            value /= 1000;
+            prefix++;
+        }
+        char buffer[32];
+        std::snprintf(buffer, sizeof(buffer), value >= 100 ? "%.0f" : (value >= 10 ? "%.1f" : "%.2f"), value);
+        std::string separator = prefix == 0 && !unit.empty() ? " " : "";
+        return buffer + std::string(prefixes[prefix]) + separator + unit;
+    }
+};
+
+/**
+ * @brief 基准测试执行者类。
+ *
+ * 此类为 `TestExecutorClass` 的具体子类，用于测量单次操作的耗时。派生类实现 `RunIteration()` 作为被测操作，
+ * 可以覆盖 `RunTest()` 进行正确性检查（默认只执行一次 `RunIteration()`），并通过 `BytesProcessed()` 声明每次操作处理的字节数。
+ *
+ * `ProceedTest()` 首先执行一次 `RunTest()`，正确性检查失败时不再进行测量。随后：
+ * 1. 在 `warmupTime` 内反复执行，使缓存、分支预测和惰性初始化进入稳定状态；
+ * 2. 按已测得的速度逐步增加每个样本的执行次数，使单个样本的耗时达到 `measureTime / samples`；
+ * 3. 采集 `samples` 个样本，按四分位距剔除 `[Q1 - 1.5 IQR, Q3 + 1.5 IQR]` 之外的离群样本，取其余样本的平均值。
+ *
+ * 测量结果（纳秒每次）写入 `runTime`，因此容器的运行时间直方图反映各个基准测试的单次耗时；
+ * 完整的摘要（ns/op、ops/s、bytes/s）作为附加统计信息随容器的汇总一并输出。
+ * 不同的基准测试之间互斥执行，即使启用了并行模式也不会同时测量，以免互相干扰。
+ *
+ * 示例：
+ * ```cpp
+ * class ParseBenchmarkClass : public BenchmarkExecutorClass
+ * {
+ * public:
+ *     using BenchmarkExecutorClass::BenchmarkExecutorClass;
+ *
+ *     void RunIteration() override { DoNotOptimize(parse(*DATA_PTR(std::string))); }
+ *     uint64_t BytesProcessed() const override { return DATA_PTR(std::string)->size(); }
+ * };
+ * ```
+ */
+class BenchmarkExecutorClass : public TestExecutorClass {
+public:
+    /// @brief 构造函数。
+    /// @param dataPtr 测试所需的数据指针。
+    /// @param testIndex 当前测试的索引号。
+    /// @param options 基准测试的参数。
+    BenchmarkExecutorClass(void* dataPtr, ssize_t testIndex, BenchmarkOptions options = BenchmarkOptions())
+        : TestExecutorClass(dataPtr, testIndex), options(options) {}
+
+    /// @brief 执行正确性检查和基准测试。
+    /// @param testName 测试的名称。
+    /// @return 返回测试结果，`runTime` 为纳秒每次。
+    TestResult ProceedTest(NameType testName) override {
+        TestResult result = RunTest(testName);
+        result.isLeaf = true;
+        result.testIndex = static_cast<u_int32_t>(this->testIndex);
+        if (!result.success)
+        {
+            return result;
+        }
+
+        std::lock_guard<std::mutex> guard(measurementMutex());
+        stats = Measure();
+        result.runTime = static_cast<uint64_t>(stats.nanosecondsPerOp + 0.5);
+        result.summaryInfo.push_back(stats.summary());
+        return result;
+    }
+
+    /// @brief 正确性检查，默认执行一次 `RunIteration()`。
+    /// @param testName 测试的名称。
+    /// @return 返回测试结果。
+    TestResult RunTest(NameType testName) override {
+        (void)testName;
+        RunIteration();
+        return this->testResult;
+    }
+
+    /// @brief 最近一次测量的统计结果。
+    const BenchmarkStats& Stats() const { return stats; }
+
+protected:
+    /// @brief 基准测试的参数。
+    BenchmarkOptions options;
+
+    /// @brief 被测操作。
+    /// @details 此函数必须在派生类中实现。其结果应当通过 `DoNotOptimize` 使用，以免被编译器删除。
+    virtual void RunIteration() = 0;
+
+    /// @brief 每次操作处理的字节数，默认为 0（不统计吞吐量）。
+    virtual uint64_t BytesProcessed() const { return 0; }
+
+private:
+    BenchmarkStats stats;
+
+    /// @brief 连续执行 iterations 次，返回总耗时（纳秒）。
+    uint64_t RunBatch(uint64_t iterations) {
+        START_TIMER;
+        for (uint64_t i = 0; i < iterations; i++)
+        {
+            RunIteration();
+            ClobberMemory();
+        }
+        return FINISH_TIMER;
+    }
+
+    BenchmarkStats Measure() {
+        auto warmupEnd = std::chrono::steady_clock::now() + options.warmupTime;
+        do
+        {
+            RunBatch(1);
+        } while (std::chrono::steady_clock::now() < warmupEnd);
+
+        size_t sampleCount = options.samples == 0 ? 1 : options.samples;
+        uint64_t target = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(options.measureTime).count()) / sampleCount;
+        uint64_t iterations = 1;
+        while (iterations < options.maxIterations)
+        {
+            uint64_t elapsed = RunBatch(iterations);
+            if (elapsed >= target)
+            {
+                break;
+            }
+            // 按已测得的速度估算所需次数，但每次最多增长 10 倍，以免单次测量的误差导致过冲
+            uint64_t estimate = elapsed == 0 ? iterations * 10 : static_cast<uint64_t>(static_cast<double>(iterations) * target / elapsed * 1.2);
+            iterations = std::min(std::max(estimate, iterations + 1), std::min(iterations * 10, options.maxIterations));
+        }
+
+        std::vector<double> samples(sampleCount);
+        for (auto& sample : samples)
+        {
+            sample = static_cast<double>(RunBatch(iterations)) / static_cast<double>(iterations);
+        }
+        std::sort(samples.begin(), samples.end());
+        double q1 = quantile(samples, 0.25);
+        double q3 = quantile(samples, 0.75);
+        double low = q1 - 1.5 * (q3 - q1);
+        double high = q3 + 1.5 * (q3 - q1);
+
+        BenchmarkStats result;
+        double sum = 0;
+        for (double sample : samples)
+        {
+            if (sample < low || sample > high)
+            {
+                result.outliers++;
+                continue;
+            }
+            sum += sample;
+            result.samples++;
+        }
+        result.nanosecondsPerOp = result.samples == 0 ? 0 : sum / static_cast<double>(result.samples);
+        result.iterations = iterations;
+        result.bytesPerOp = BytesProcessed();
+        return result;
+    }
+
+    static double quantile(const std::vector<double>& sorted, double q) {
+        double position = q * static_cast<double>(sorted.size() - 1);
+        size_t lower = static_cast<size_t>(position);
+        size_t upper = lower + 1 < sorted.size() ? lower + 1 : lower;
+        return sorted[lower] + (sorted[upper] - sorted[lower]) * (position - static_cast<double>(lower));
+    }
+};
+
+#endif
@@ -0,0 +1,275 @@
+#ifndef COMPARISON_H
+#define COMPARISON_H
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+#include <Benchmark.h>
+
+/**
+ * @brief A/B 比较的参数。
+ */
+struct ComparisonOptions {
+    /// @brief 预热时间，期间两种实现交替执行，不计入结果。
+    std::chrono::milliseconds warmupTime{20};
+
+    /// @brief 测量的轮数。每一轮以随机的先后顺序各测量一次两种实现，得到一对配对的观测值。
+    size_t rounds = 30;
+
+    /// @brief 单次测量的最短时间。单次执行快于此值时连续执行多次，取平均值作为一个观测值。
+    std::chrono::microseconds minMeasureTime{20};
+
+    /// @brief 单次测量最多执行的次数。
+    uint64_t maxIterations = uint64_t(1) << 24;
+
+    /// @brief 决定每一轮先后顺序的种子，与叶子的 `testIndex` 一起使用，相同的种子总是得到相同的顺序。
+    uint64_t seed = 0;
+};
+
+/**
+ * @brief 一个输入上的配对比较结果。
+ *
+ * 所有数值都是各轮观测值的中位数，差值和加速比先在每一轮内配对计算、再取中位数，
+ * 因此两种实现共同经历的频率和温度变化会被抵消。
+ */
+struct PairedComparison {
+    /// @brief 基准实现的每次执行时间（纳秒）。
+    double baselineNanoseconds = 0;
+
+    /// @brief 候选实现的每次执行时间（纳秒）。
+    double candidateNanoseconds = 0;
+
+    /// @brief 配对差值 `候选 - 基准`（纳秒），小于 0 表示候选实现更快。
+    double deltaNanoseconds = 0;
+
+    /// @brief 配对的对数加速比 `log(基准 / 候选)`，大于 0 表示候选实现更快。
+    double logSpeedup = 0;
+
+    /// @brief 测量的轮数。
+    size_t rounds = 0;
+
+    /// @brief 每次测量连续执行的次数。
+    uint64_t iterations = 0;
+
+    /// @brief 加速比，大于 1 表示候选实现更快。
+    double speedup() const { return std::exp(logSpeedup); }
+
+    /// @brief 生成一行摘要文本。
+    std::string summary() const {
+        return "baseline " + formatNanoseconds(baselineNanoseconds) + "/op, candidate " + formatNanoseconds(candidateNanoseconds) + "/op, paired delta " +
+               (deltaNanoseconds < 0 ? "-" : "+") + formatNanoseconds(std::fabs(deltaNanoseconds)) + "/op, " + ComparisonStats::formatRatio(speedup()) +
+               " (" + std::to_string(rounds) + " rounds of " + std::to_string(iterations) + " iterations)";
+    }
+
+    static std::string formatNanoseconds(double nanoseconds) {
+        if (nanoseconds >= 1000)
+        {
+            return formatTime(static_cast<uint64_t>(nanoseconds + 0.5));
+        }
+        char buffer[32];
+        std::snprintf(buffer, sizeof(buffer), "%.2f ns", nanoseconds);
+        return buffer;
+    }
+};
+
+/**
+ * @brief A/B 比较执行者类。
+ *
+ * 此类为 `TestExecutorClass` 的具体子类，在同一个输入上比较两种实现（例如现有的解析器和候选的解析器）的输出和速度。
+ * 派生类在构造函数中通过 `Compare()` 登记基准实现和候选实现，二者都以 `const Input&` 为参数并返回同一类型的输出。
+ *
+ * `ProceedTest()` 首先检查两种实现的输出相等，不相等时叶子测试失败，不再进行测量，也不计入运行时间的直方图。随后：
+ * 1. 在 `warmupTime` 内交替执行两种实现；
+ * 2. 确定每次测量连续执行的次数，使较快的实现单次测量的耗时达到 `minMeasureTime`；
+ * 3. 进行 `rounds` 轮测量，每一轮以随机的先后顺序各测量一次两种实现，按轮配对计算差值和加速比。
+ *
+ * 每个输入的配对结果作为附加统计信息随容器的汇总输出，候选实现的每次执行时间写入 `runTime`。
+ * 每个输入的加速比记入 `TestResult::comparison`，逐层合并到上层的容器和驱动类，
+ * 叶子节点的父节点在汇总中输出整体加速比和自助法置信区间，机器可读的报告中每一层容器都带有同样的数据。
+ * 与 `BenchmarkExecutorClass` 一样，不同的测量之间互斥执行。
+ *
+ * 示例：
+ * ```cpp
+ * class ParseComparisonClass : public ComparisonExecutorClass<std::string>
+ * {
+ * public:
+ *     ParseComparisonClass(void* dataPtr, ssize_t testIndex) : ComparisonExecutorClass(dataPtr, testIndex)
+ *     {
+ *         Compare([](const std::string& text) { return parseWithStrtol(text); },
+ *                 [](const std::string& text) { return parseManually(text); });
+ *     }
+ * };
+ * ```
+ *
+ * @tparam Input 输入类型，`dataPtr` 指向一个 `Input`。
+ */
+template <typename Input>
+class ComparisonExecutorClass : public TestExecutorClass {
+public:
+    /// @brief 构造函数。
+    /// @param dataPtr 指向输入的数据指针。
+    /// @param testIndex 当前测试的索引号。
+    /// @param options A/B 比较的参数。
+    ComparisonExecutorClass(void* dataPtr, ssize_t testIndex, ComparisonOptions options = ComparisonOptions())
+        : TestExecutorClass(dataPtr, testIndex), options(options) {}
+
+    /// @brief 检查输出并比较两种实现的速度。
+    /// @param testName 测试的名称。
+    /// @return 返回测试结果，`runTime` 为候选实现的纳秒每次。
+    TestResult ProceedTest(NameType testName) override {
+        if (!runBaseline)
+        {
+            throw std::logic_error("ComparisonExecutorClass: Compare() was not called");
+        }
+        // 断言记录的是执行断言时的 testIndex，因此在正确性检查之前设置
+        this->testResult.isLeaf = true;
+        this->testResult.testIndex = this->testIndex;
+        TestResult result = RunTest(testName);
+        result.isLeaf = true;
+        result.testIndex = this->testIndex;
+        if (!result.success)
+        {
+            result.measured = false;
+            return result;
+        }
+
+        std::lock_guard<std::mutex> guard(measurementMutex());
+        paired = Measure();
+        result.runTime = static_cast<uint64_t>(paired.candidateNanoseconds + 0.5);
+        result.comparison.add(paired.logSpeedup);
+        result.summaryInfo.push_back(paired.summary());
+        return result;
+    }
+
+    /// @brief 正确性检查，默认断言两种实现的输出相等。
+    /// @param testName 测试的名称。
+    /// @return 返回测试结果。
+    TestResult RunTest(NameType testName) override {
+        (void)testName;
+        checkOutputs(*DATA_PTR(Input), this->testResult);
+        return this->testResult;
+    }
+
+    /// @brief 最近一次测量的配对比较结果。
+    const PairedComparison& Paired() const { return paired; }
+
+protected:
+    /// @brief A/B 比较的参数。
+    ComparisonOptions options;
+
+    /**
+     * @brief 登记被比较的两种实现。
+     *
+     * @param baseline 基准实现，例如现有的实现。
+     * @param candidate 候选实现，其输出必须与基准实现相等。
+     */
+    template <typename Baseline, typename Candidate>
+    void Compare(Baseline baseline, Candidate candidate) {
+        using Output = std::decay_t<std::invoke_result_t<Baseline&, const Input&>>;
+        static_assert(!std::is_void<Output>::value, "the compared implementations must return their output");
+        static_assert(std::is_same<Output, std::decay_t<std::invoke_result_t<Candidate&, const Input&>>>::value,
+                      "the compared implementations must return the same type");
+        runBaseline = makeRunner(baseline);
+        runCandidate = makeRunner(candidate);
+        checkOutputs = [baseline, candidate](const Input& input, TestResult& result) mutable {
+            Output expected = baseline(input);
+            Output actual = candidate(input);
+            result.assertEQ("candidate output", expected, actual);
+        };
+    }
+
+private:
+    /// @brief 连续执行若干次并返回总耗时（纳秒）的函数。
+    using Runner = std::function<uint64_t(const Input&, uint64_t)>;
+
+    Runner runBaseline;
+    Runner runCandidate;
+    std::function<void(const Input&, TestResult&)> checkOutputs;
+    PairedComparison paired;
+
+    template <typename Function>
+    static Runner makeRunner(Function function) {
+        return [function](const Input& input, uint64_t iterations) mutable {
+            START_TIMER;
+            for (uint64_t i = 0; i < iterations; i++)
+            {
+                auto output = function(input);
+                DoNotOptimize(output);
+                ClobberMemory();
+            }
+            return FINISH_TIMER;
+        };
+    }
+
+    PairedComparison Measure() {
+        const Input& input = *DATA_PTR(Input);
+        auto warmupEnd = std::chrono::steady_clock::now() + options.warmupTime;
+        do
+        {
+            runBaseline(input, 1);
+            runCandidate(input, 1);
+        } while (std::chrono::steady_clock::now() < warmupEnd);
+
+        uint64_t target = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(options.minMeasureTime).count());
+        uint64_t iterations = 1;
+        while (iterations < options.maxIterations)
+        {
+            uint64_t elapsed = std::min(runBaseline(input, iterations), runCandidate(input, iterations));
+            if (elapsed >= target)
+            {
+                break;
+            }
+            uint64_t estimate = elapsed == 0 ? iterations * 10 : static_cast<uint64_t>(static_cast<double>(iterations) * target / elapsed * 1.2);
+            iterations = std::min(std::max(estimate, iterations + 1), std::min(iterations * 10, options.maxIterations));
+        }
+
+        // 计时器的分辨率以下的耗时按半次计时的精度计算，以免出现 0 的比值
+        double floor = 0.5 / static_cast<double>(iterations);
+        size_t rounds = options.rounds == 0 ? 1 : options.rounds;
+        std::vector<double> baselineTimes, candidateTimes, deltas, logSpeedups;
+        Xoshiro256 rng(deriveSeed(options.seed, 0, static_cast<uint64_t>(this->testIndex)));
+        for (size_t round = 0; round < rounds; round++)
+        {
+            uint64_t baselineTime, candidateTime;
+            if (rng() & 1)
+            {
+                baselineTime = runBaseline(input, iterations);
+                candidateTime = runCandidate(input, iterations);
+            }
+            else
+            {
+                candidateTime = runCandidate(input, iterations);
+                baselineTime = runBaseline(input, iterations);
+            }
+            double baseline = std::max(static_cast<double>(baselineTime) / static_cast<double>(iterations), floor);
+            double candidate = std::max(static_cast<double>(candidateTime) / static_cast<double>(iterations), floor);
+            baselineTimes.push_back(baseline);
+            candidateTimes.push_back(candidate);
+            deltas.push_back(candidate - baseline);
+            logSpeedups.push_back(std::log(baseline / candidate));
+        }
+
+        PairedComparison result;
+        result.baselineNanoseconds = median(baselineTimes);
+        result.candidateNanoseconds = median(candidateTimes);
+        result.deltaNanoseconds = median(deltas);
+        result.logSpeedup = median(logSpeedups);
+        result.rounds = rounds;
+        result.iterations = iterations;
+        return result;
+    }
+
+    static double median(std::vector<double> values) {
+        std::sort(values.begin(), values.end());
+        size_t middle = values.size() / 2;
+        return values.size() % 2 == 1 ? values[middle] : (values[middle - 1] + values[middle]) / 2;
+    }
+};
+
+#endif
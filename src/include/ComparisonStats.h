@@ -0,0 +1,182 @@
+#ifndef COMPARISON_STATS_H
+#define COMPARISON_STATS_H
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <Generators.h>
+
+/**
+ * @brief A/B 比较的汇总数据。
+ *
+ * 记录每个输入的对数加速比 `log(基准实现的耗时 / 候选实现的耗时)`，追加到父节点时逐层合并，
+ * 因此测试树中任意一层都可以对其下层的所有输入计算整体加速比和置信区间。
+ * 输入数量、候选实现更快的输入数量和对数加速比之和是精确的，整体加速比为各个输入加速比的几何平均值；
+ * 置信区间由自助法（bootstrap）对一个至多 `RESERVOIR_SIZE` 个输入的样本重抽样得到，
+ * 输入更多时样本按输入数量成比例地从各个子树中抽取，区间宽度再按样本与全部输入的数量之比换算，
+ * 因此无论测试树有多深、有多少叶子，每个 `TestResult` 中的比较数据都只占用固定的内存。
+ * 重抽样使用固定的种子，同样的数据总是得到同样的区间，因此区间在数据改变之前只计算一次，
+ * 同一个容器的控制台汇总和机器可读报告共用同一次计算的结果。
+ */
+class ComparisonStats {
+public:
+    /// @brief 用于计算置信区间的样本的最大数量。
+    static constexpr size_t RESERVOIR_SIZE = 1024;
+
+    /// @brief 置信区间。
+    struct Interval {
+        double low = 1;
+        double high = 1;
+    };
+
+    /// @brief 记录一个输入的对数加速比，大于 0 表示候选实现更快。
+    void add(double logSpeedup) {
+        ComparisonStats single;
+        single.count = 1;
+        single.faster = logSpeedup > 0 ? 1 : 0;
+        single.sum = logSpeedup;
+        single.samples.push_back(logSpeedup);
+        *this += single;
+    }
+
+    /// @brief 合并下层的比较数据。
+    ComparisonStats& operator+=(const ComparisonStats& other) {
+        if (other.empty())
+        {
+            return *this;
+        }
+        if (samples.size() + other.samples.size() <= RESERVOIR_SIZE)
+        {
+            samples.insert(samples.end(), other.samples.begin(), other.samples.end());
+        }
+        else
+        {
+            // 按两侧代表的输入数量成比例地分配样本，再从各自的样本中无放回地抽取
+            Xoshiro256 rng(count * 0x9E3779B97F4A7C15ULL + other.count);
+            double share = static_cast<double>(count) / static_cast<double>(count + other.count);
+            size_t fromThis = static_cast<size_t>(share * static_cast<double>(RESERVOIR_SIZE) + 0.5);
+            fromThis = std::min(std::max(fromThis, RESERVOIR_SIZE - std::min(other.samples.size(), RESERVOIR_SIZE)), samples.size());
+            size_t fromOther = std::min(RESERVOIR_SIZE - fromThis, other.samples.size());
+            std::vector<double> merged;
+            merged.reserve(fromThis + fromOther);
+            pick(samples, fromThis, rng, merged);
+            pick(other.samples, fromOther, rng, merged);
+            samples.swap(merged);
+        }
+        count += other.count;
+        faster += other.faster;
+        sum += other.sum;
+        intervalValid = false;
+        return *this;
+    }
+
+    /// @brief 是否没有任何比较数据。
+    bool empty() const { return count == 0; }
+
+    /// @brief 输入的数量。
+    size_t inputs() const { return static_cast<size_t>(count); }
+
+    /// @brief 候选实现更快的输入数量。
+    size_t fasterInputs() const { return static_cast<size_t>(faster); }
+
+    /// @brief 整体加速比（几何平均值），大于 1 表示候选实现更快。
+    double speedup() const { return empty() ? 1 : std::exp(sum / static_cast<double>(count)); }
+
+    /**
+     * @brief 整体加速比的自助法置信区间。
+     *
+     * 耗时与 resamples 和样本数量的乘积成正比。结果按参数缓存，数据不变时再次调用不会重新抽样。
+     * 缓存不加锁，同一个对象不应当在多个线程中同时调用。
+     *
+     * @param confidence 置信水平。
+     * @param resamples 重抽样的次数。
+     */
+    Interval confidenceInterval(double confidence = 0.95, size_t resamples = 2000) const {
+        if (intervalValid && intervalConfidence == confidence && intervalResamples == resamples)
+        {
+            return interval;
+        }
+        intervalValid = true;
+        intervalConfidence = confidence;
+        intervalResamples = resamples;
+        if (samples.size() < 2 || resamples == 0)
+        {
+            interval.low = interval.high = speedup();
+            return interval;
+        }
+        Xoshiro256 rng(samples.size());
+        double sampleMean = 0;
+        for (double value : samples)
+        {
+            sampleMean += value;
+        }
+        sampleMean /= static_cast<double>(samples.size());
+        std::vector<double> means(resamples);
+        for (double& value : means)
+        {
+            double resampled = 0;
+            for (size_t i = 0; i < samples.size(); i++)
+            {
+                resampled += samples[rng() % samples.size()];
+            }
+            value = resampled / static_cast<double>(samples.size());
+        }
+        std::sort(means.begin(), means.end());
+        // 样本只是全部输入的一部分时，均值的标准误差按 sqrt(样本数量 / 输入数量) 缩小，区间以精确的均值为中心
+        double center = sum / static_cast<double>(count);
+        double scale = std::sqrt(static_cast<double>(samples.size()) / static_cast<double>(count));
+        double tail = (1 - confidence) / 2;
+        double low = means[static_cast<size_t>(tail * static_cast<double>(resamples - 1))];
+        double high = means[static_cast<size_t>((1 - tail) * static_cast<double>(resamples - 1) + 0.5)];
+        interval.low = std::exp(center + (low - sampleMean) * scale);
+        interval.high = std::exp(center + (high - sampleMean) * scale);
+        return interval;
+    }
+
+    /// @brief 生成一行摘要文本。
+    std::string summary() const {
+        Interval bounds = confidenceInterval();
+        return "candidate is " + formatRatio(speedup()) + " (95% CI " + formatRatio(bounds.low) + " to " + formatRatio(bounds.high) +
+               ") over " + std::to_string(inputs()) + " inputs, faster on " + std::to_string(fasterInputs());
+    }
+
+    /// @brief 将加速比格式化为 "1.52x faster" 或 "1.25x slower"。
+    static std::string formatRatio(double speedup) {
+        char buffer[32];
+        std::snprintf(buffer, sizeof(buffer), "%.3gx %s", speedup >= 1 ? speedup : 1 / speedup, speedup >= 1 ? "faster" : "slower");
+        return buffer;
+    }
+
+private:
+    /// @brief 输入的数量。
+    uint64_t count = 0;
+
+    /// @brief 候选实现更快的输入数量。
+    uint64_t faster = 0;
+
+    /// @brief 所有输入的对数加速比之和。
+    double sum = 0;
+
+    /// @brief 用于计算置信区间的对数加速比样本，至多 `RESERVOIR_SIZE` 个。
+    std::vector<double> samples;
+
+    /// @brief 最近一次计算的置信区间及其参数。
+    mutable Interval interval;
+    mutable double intervalConfidence = 0;
+    mutable size_t intervalResamples = 0;
+    mutable bool intervalValid = false;
+
+    /// @brief 从 values 中无放回地随机抽取 amount 个追加到 out。
+    static void pick(std::vector<double> values, size_t amount, Xoshiro256& rng, std::vector<double>& out) {
+        for (size_t i = 0; i < amount; i++)
+        {
+            size_t chosen = i + static_cast<size_t>(rng.nextBelow(values.size() - i));
+            std::swap(values[i], values[chosen]);
+            out.push_back(values[i]);
+        }
+    }
+};
+
+#endif
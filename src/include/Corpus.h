@@ -0,0 +1,350 @@
+#ifndef CORPUS_H
+#define CORPUS_H
+#include <array>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+#include <DataSource.h>
+
+/**
+ * 二进制语料文件格式（所有整数均为小端序）：
+ *
+ *   文件头：    magic "FTSCORP1"(8) | 版本号 u32 | 分组数量 u32 | 分组索引偏移量 u64
+ *   分组数据：  对每个分组依次写入
+ *                 名称长度 u32 | 名称字节 | 对齐到 8 字节
+ *                 每条记录：长度 u32 | 记录字节 | 对齐到 4 字节
+ *                 记录偏移表：记录数量个 u64，指向每条记录的长度字段
+ *   分组索引：  分组数量个 { 名称偏移量 u64 | 记录偏移表偏移量 u64 | 记录数量 u64 }
+ *
+ * 分组对应一个 `TestContainerClass`，记录对应一个 `TestExecutorClass` 的输入。
+ * 读取时整个文件被映射到内存，每条记录都可以直接以 `std::string_view` 访问，无需任何拷贝。
+ */
+#define CORPUS_MAGIC "FTSCORP1"
+#define CORPUS_VERSION 1
+
+/**
+ * @brief 语料文件中的一个分组。
+ *
+ * 分组只是映射内存上的视图，其生命周期不能超过所属的 `CorpusReader`。
+ * 名称和记录偏移表的位置在 `CorpusReader::group()` 中校验，每条记录的偏移量和长度在访问时校验，
+ * 超出文件范围时抛出 `std::runtime_error`，因此截断或损坏的语料文件不会导致越界读取。
+ */
+class CorpusGroup {
+public:
+    CorpusGroup(const char* base, size_t length, uint64_t nameOffset, uint64_t tableOffset, uint64_t recordCount)
+        : base(base), length(length), nameOffset(nameOffset), tableOffset(tableOffset), recordCount(recordCount) {}
+
+    /// @brief 分组名称。
+    std::string_view name() const {
+        uint32_t nameLength;
+        std::memcpy(&nameLength, base + nameOffset, sizeof(nameLength));
+        return std::string_view(base + nameOffset + sizeof(nameLength), nameLength);
+    }
+
+    /// @brief 分组中的记录数量。
+    size_t size() const { return recordCount; }
+
+    /// @brief 第 index 条记录的内容。index 超出范围时抛出 `std::out_of_range`。
+    std::string_view record(size_t index) const {
+        if (index >= recordCount)
+        {
+            throw std::out_of_range("CorpusGroup: record index out of range");
+        }
+        uint64_t offset;
+        std::memcpy(&offset, base + tableOffset + index * sizeof(uint64_t), sizeof(offset));
+        if (!fits(length, offset, sizeof(uint32_t)))
+        {
+            throw std::runtime_error("CorpusGroup: corrupt record offset");
+        }
+        uint32_t recordLength;
+        std::memcpy(&recordLength, base + offset, sizeof(recordLength));
+        if (!fits(length, offset + sizeof(recordLength), recordLength))
+        {
+            throw std::runtime_error("CorpusGroup: corrupt record length");
+        }
+        return std::string_view(base + offset + sizeof(recordLength), recordLength);
+    }
+
+    /// @brief 从 offset 开始的 size 字节是否完全位于长度为 length 的文件之内，计算不会溢出。
+    static bool fits(uint64_t length, uint64_t offset, uint64_t size) { return offset <= length && size <= length - offset; }
+
+private:
+    const char* base;
+    size_t length;
+    uint64_t nameOffset;
+    uint64_t tableOffset;
+    uint64_t recordCount;
+};
+
+/**
+ * @brief 内存映射的语料读取器。
+ *
+ * 打开文件时只映射并校验文件头和分组索引的范围，分组和记录在被访问时才校验、由内核按页载入，
+ * 因此启动几乎不需要时间，常驻内存也只包含实际访问过的页。
+ *
+ * 示例：
+ * ```cpp
+ * CorpusReader corpus("corpus.bin");
+ * for (size_t i = 0; i < corpus.size(); i++)
+ * {
+ *     CorpusGroup group = corpus.group(i);
+ *     std::string_view input = group.record(0);
+ * }
+ * ```
+ */
+class CorpusReader {
+public:
+    /// @brief 打开并映射语料文件。
+    /// @param path 语料文件路径。
+    /// @details 文件无法打开或格式不正确时抛出 `std::runtime_error`。
+    explicit CorpusReader(const std::string& path) {
+        int fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+        {
+            throw std::runtime_error("CorpusReader: cannot open " + path);
+        }
+        struct stat info;
+        if (fstat(fd, &info) != 0 || info.st_size < 24)
+        {
+            close(fd);
+            throw std::runtime_error("CorpusReader: invalid corpus file " + path);
+        }
+        length = static_cast<size_t>(info.st_size);
+        void* mapping = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+        if (mapping == MAP_FAILED)
+        {
+            throw std::runtime_error("CorpusReader: cannot map " + path);
+        }
+        base = static_cast<const char*>(mapping);
+        madvise(mapping, length, MADV_SEQUENTIAL);
+
+        uint32_t version;
+        std::memcpy(&version, base + 8, sizeof(version));
+        std::memcpy(&groupCount, base + 12, sizeof(groupCount));
+        std::memcpy(&indexOffset, base + 16, sizeof(indexOffset));
+        if (std::memcmp(base, CORPUS_MAGIC, 8) != 0 || version != CORPUS_VERSION ||
+            !CorpusGroup::fits(length, indexOffset, uint64_t(groupCount) * INDEX_ENTRY_SIZE))
+        {
+            munmap(mapping, length);
+            throw std::runtime_error("CorpusReader: invalid corpus file " + path);
+        }
+    }
+
+    ~CorpusReader() { munmap(const_cast<char*>(base), length); }
+
+    CorpusReader(const CorpusReader&) = delete;
+    CorpusReader& operator=(const CorpusReader&) = delete;
+
+    /// @brief 分组数量。
+    size_t size() const { return groupCount; }
+
+    /**
+     * @brief 第 index 个分组。
+     *
+     * index 超出范围时抛出 `std::out_of_range`；分组的名称或记录偏移表超出文件范围时抛出 `std::runtime_error`。
+     */
+    CorpusGroup group(size_t index) const {
+        if (index >= groupCount)
+        {
+            throw std::out_of_range("CorpusReader: group index out of range");
+        }
+        uint64_t entry[3];
+        std::memcpy(entry, base + indexOffset + index * INDEX_ENTRY_SIZE, sizeof(entry));
+        uint32_t nameLength = 0;
+        bool valid = CorpusGroup::fits(length, entry[0], sizeof(nameLength));
+        if (valid)
+        {
+            std::memcpy(&nameLength, base + entry[0], sizeof(nameLength));
+            valid = CorpusGroup::fits(length, entry[0] + sizeof(nameLength), nameLength) && entry[1] <= length &&
+                    entry[2] <= (length - entry[1]) / sizeof(uint64_t);
+        }
+        if (!valid)
+        {
+            throw std::runtime_error("CorpusReader: corrupt group " + std::to_string(index));
+        }
+        return CorpusGroup(base, length, entry[0], entry[1], entry[2]);
+    }
+
+private:
+    /// @brief 分组索引中每一项的字节数。
+    static constexpr uint64_t INDEX_ENTRY_SIZE = 24;
+
+    const char* base = nullptr;
+    size_t length = 0;
+    uint32_t groupCount = 0;
+    uint64_t indexOffset = 0;
+};
+
+/**
+ * @brief 语料文件写入器。
+ *
+ * 按 `beginGroup`、若干次 `append`、`endGroup` 的顺序逐个写入分组，最后调用 `finish` 写入分组索引。
+ * 每个分组写入期间只需要在内存中保存记录偏移表。
+ */
+class CorpusWriter {
+public:
+    /// @brief 创建语料文件。
+    /// @param path 语料文件路径，已存在的文件会被覆盖。
+    explicit CorpusWriter(const std::string& path) : path(path) {
+        file = std::fopen(path.c_str(), "wb");
+        if (file == nullptr)
+        {
+            throw std::runtime_error("CorpusWriter: cannot create " + path);
+        }
+        writeBytes(CORPUS_MAGIC, 8);
+        writeValue<uint32_t>(CORPUS_VERSION);
+        writeValue<uint32_t>(0);
+        writeValue<uint64_t>(0);
+    }
+
+    /// @brief 析构函数。若尚未调用 `finish`，则在此写入分组索引，写入失败时不抛出异常。
+    ~CorpusWriter() {
+        if (file != nullptr)
+        {
+            try
+            {
+                finish();
+            }
+            catch (...)
+            {
+            }
+        }
+    }
+
+    CorpusWriter(const CorpusWriter&) = delete;
+    CorpusWriter& operator=(const CorpusWriter&) = delete;
+
+    /// @brief 开始写入一个分组。
+    void beginGroup(std::string_view name) {
+        currentName = offset;
+        writeValue<uint32_t>(static_cast<uint32_t>(name.size()));
+        writeBytes(name.data(), name.size());
+        pad(8);
+        recordOffsets.clear();
+    }
+
+    /// @brief 向当前分组追加一条记录。
+    void append(std::string_view record) {
+        recordOffsets.push_back(offset);
+        writeValue<uint32_t>(static_cast<uint32_t>(record.size()));
+        writeBytes(record.data(), record.size());
+        pad(4);
+    }
+
+    /// @brief 结束当前分组。
+    void endGroup() {
+        pad(8);
+        uint64_t table = offset;
+        for (uint64_t recordOffset : recordOffsets)
+        {
+            writeValue<uint64_t>(recordOffset);
+        }
+        index.push_back({currentName, table, recordOffsets.size()});
+    }
+
+    /// @brief 写入分组索引并关闭文件。
+    void finish() {
+        uint64_t indexOffset = offset;
+        for (const auto& entry : index)
+        {
+            writeValue<uint64_t>(entry[0]);
+            writeValue<uint64_t>(entry[1]);
+            writeValue<uint64_t>(entry[2]);
+        }
+        uint32_t groupCount = static_cast<uint32_t>(index.size());
+        std::fseek(file, 12, SEEK_SET);
+        std::fwrite(&groupCount, sizeof(groupCount), 1, file);
+        std::fwrite(&indexOffset, sizeof(indexOffset), 1, file);
+        bool failed = std::ferror(file) != 0;
+        failed = std::fclose(file) != 0 || failed;
+        file = nullptr;
+        if (failed)
+        {
+            throw std::runtime_error("CorpusWriter: failed to write " + path);
+        }
+    }
+
+private:
+    std::string path;
+    std::FILE* file = nullptr;
+    uint64_t offset = 0;
+    uint64_t currentName = 0;
+    std::vector<uint64_t> recordOffsets;
+    std::vector<std::array<uint64_t, 3>> index;
+
+    void writeBytes(const void* data, size_t size) {
+        std::fwrite(data, 1, size, file);
+        offset += size;
+    }
+
+    template <typename T>
+    void writeValue(T value) {
+        writeBytes(&value, sizeof(value));
+    }
+
+    void pad(size_t alignment) {
+        static const char zeros[8] = {};
+        writeBytes(zeros, (alignment - offset % alignment) % alignment);
+    }
+};
+
+/**
+ * @brief 将内存中的测试数据转换为语料文件。
+ *
+ * 适用于示例中 `DriverType` 形式的数据，即 `std::pair<分组列表, 名称>`，
+ * 其中每个分组是 `std::pair<记录列表, 分组名称>`，记录可以转换为 `std::string_view`。
+ *
+ * @param path 语料文件路径。
+ * @param data 测试数据。
+ */
+template <typename DriverData>
+void writeCorpus(const std::string& path, const DriverData& data) {
+    CorpusWriter writer(path);
+    for (const auto& group : data.first)
+    {
+        writer.beginGroup(group.second);
+        for (const auto& record : group.first)
+        {
+            writer.append(std::string_view(record));
+        }
+        writer.endGroup();
+    }
+    writer.finish();
+}
+
+/**
+ * @brief 按分组产出语料内容的数据源。
+ *
+ * 可以直接作为 `StreamingTestDriverClass<CorpusGroup>` 的数据源使用。产出的分组只是映射内存上的视图，
+ * 因此数据源（以及它所引用的 `CorpusReader`）必须在测试结束前保持有效。
+ */
+class CorpusSource : public ChunkSource<CorpusGroup> {
+public:
+    /// @brief 构造函数。
+    /// @param corpus 已打开的语料。
+    explicit CorpusSource(std::shared_ptr<CorpusReader> corpus) : corpus(std::move(corpus)) {}
+
+    std::unique_ptr<CorpusGroup> next() override {
+        if (current == corpus->size())
+        {
+            return nullptr;
+        }
+        return std::unique_ptr<CorpusGroup>(new CorpusGroup(corpus->group(current++)));
+    }
+
+private:
+    std::shared_ptr<CorpusReader> corpus;
+    size_t current = 0;
+};
+
+#endif
@@ -0,0 +1,601 @@
+#ifndef COVERAGE_FUZZER_H
+#define COVERAGE_FUZZER_H
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <dirent.h>
+#include <exception>
+#include <fstream>
+#include <iterator>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <sys/stat.h>
+#include <vector>
+#include <FuzzTestSchema.h>
+#include <InputFiles.h>
+
+/**
+ * 覆盖率引导的模糊测试。
+ *
+ * 被测代码需要使用编译器的覆盖率插桩编译：
+ * - clang：`-fsanitize-coverage=trace-pc-guard`，每条边对应一个 guard，精确记录边覆盖。
+ * - gcc：`-fsanitize-coverage=trace-pc`，按 AFL 的方式将相邻两个基本块的地址哈希为一条边。
+ *
+ * 插桩回调只能定义一次：请在**恰好一个**源文件中先定义宏 `FUZZ_TEST_SCHEMA_COVERAGE`，再包含本头文件。
+ * 只有在执行 `TestExecutorClass` 的线程上、且处于单次执行期间的回调才会被计数，框架自身的后台线程不会干扰覆盖率。
+ */
+
+// 插桩回调和框架自身的热点循环不应被插桩，否则每次执行都会产生大量无意义的回调
+#if defined(__clang__)
+#define FUZZ_NO_COVERAGE __attribute__((no_sanitize("coverage")))
+#elif defined(__has_attribute) && __has_attribute(no_sanitize_coverage)
+#define FUZZ_NO_COVERAGE __attribute__((no_sanitize_coverage))
+#else
+#define FUZZ_NO_COVERAGE
+#endif
+
+/**
+ * @brief 进程内的边覆盖计数表。
+ *
+ * 计数按 AFL 的方式归入 1、2、3、4-7、8-15、16-31、32-127、128+ 八个区间，
+ * 某条边第一次出现或第一次进入新的计数区间即视为产生了新的覆盖。
+ * 计数表是整个进程共享的，因此同一时刻只能有一个模糊测试在记录覆盖率，见 `exclusive()`。
+ */
+class CoverageMap {
+public:
+    /// @brief 计数表的大小（边的数量上限）。
+    static constexpr size_t MAP_SIZE = 1 << 16;
+
+    /// @brief 每条边在当前执行中的命中次数。
+    static inline uint8_t counters[MAP_SIZE];
+
+    /// @brief 当前线程是否正在记录覆盖率。
+    static inline thread_local bool tracing = false;
+
+    /// @brief 当前线程上一个基本块的位置（仅用于 trace-pc 模式）。
+    static inline thread_local uintptr_t previousLocation = 0;
+
+    /// @brief 已分配的 guard 数量（仅用于 trace-pc-guard 模式）。
+    static inline uint32_t guardCount = 0;
+
+    /// @brief 是否收到过 trace-pc 回调。
+    static inline bool hashedEdges = false;
+
+    /// @brief 开始记录一次执行的覆盖率。
+    static void begin() {
+        previousLocation = 0;
+        tracing = true;
+    }
+
+    /// @brief 结束记录。
+    static void end() { tracing = false; }
+
+    /// @brief 模糊测试在整个运行期间持有的互斥锁。
+    /// @details 并行模式下多个 `CoverageFuzzerClass` 同时被调度时依次执行，以免互相合并对方的覆盖。
+    static std::mutex& exclusive() {
+        static std::mutex mutex;
+        return mutex;
+    }
+
+    /// @brief 计数表中实际可能被写入的范围。
+    static size_t activeSize() {
+        if (hashedEdges || guardCount + 1 >= MAP_SIZE)
+        {
+            return MAP_SIZE;
+        }
+        return guardCount + 1;
+    }
+};
+
+/**
+ * @brief 覆盖率的累积状态。
+ *
+ * 保存所有已经见过的（边，计数区间）组合，用于判断一次执行是否产生了新的覆盖。
+ */
+class CoverageTracker {
+public:
+    CoverageTracker() : seen(CoverageMap::MAP_SIZE, 0) {}
+
+    /**
+     * @brief 将本次执行的计数合并到累积状态中，并清空计数表。
+     *
+     * 计数表按 8 字节一组扫描，全零的组直接跳过，因此开销主要取决于实际被覆盖的边的数量。
+     *
+     * @return 本次执行是否产生了新的覆盖。
+     */
+    FUZZ_NO_COVERAGE bool merge() {
+        bool found = false;
+        size_t size = CoverageMap::activeSize();
+        for (size_t base = 0; base < size; base += sizeof(uint64_t))
+        {
+            uint64_t word;
+            std::memcpy(&word, CoverageMap::counters + base, sizeof(word));
+            if (word == 0)
+            {
+                continue;
+            }
+            size_t limit = base + sizeof(uint64_t) < size ? base + sizeof(uint64_t) : size;
+            for (size_t i = base; i < limit; i++)
+            {
+                uint8_t count = CoverageMap::counters[i];
+                if (count == 0)
+                {
+                    continue;
+                }
+                uint8_t bucket = classify(count);
+                if ((bucket & ~seen[i]) != 0)
+                {
+                    edges += seen[i] == 0;
+                    seen[i] |= bucket;
+                    found = true;
+                }
+            }
+            std::memset(CoverageMap::counters + base, 0, limit - base);
+        }
+        return found;
+    }
+
+    /// @brief 已覆盖的边的数量。
+    size_t edgeCount() const { return edges; }
+
+private:
+    std::vector<uint8_t> seen;
+    size_t edges = 0;
+
+    static uint8_t classify(uint8_t count) {
+        if (count <= 3)
+        {
+            return static_cast<uint8_t>(1 << (count - 1));
+        }
+        if (count <= 7)
+        {
+            return 8;
+        }
+        if (count <= 15)
+        {
+            return 16;
+        }
+        if (count <= 31)
+        {
+            return 32;
+        }
+        return count <= 127 ? 64 : 128;
+    }
+};
+
+#ifdef FUZZ_TEST_SCHEMA_COVERAGE
+extern "C" {
+
+FUZZ_NO_COVERAGE void __sanitizer_cov_trace_pc_guard_init(uint32_t* start, uint32_t* stop) {
+    if (start == stop || *start != 0)
+    {
+        return;
+    }
+    for (uint32_t* guard = start; guard < stop; guard++)
+    {
+        *guard = static_cast<uint32_t>(++CoverageMap::guardCount % CoverageMap::MAP_SIZE);
+    }
+}
+
+FUZZ_NO_COVERAGE void __sanitizer_cov_trace_pc_guard(uint32_t* guard) {
+    if (!CoverageMap::tracing || *guard == 0)
+    {
+        return;
+    }
+    uint8_t& counter = CoverageMap::counters[*guard];
+    counter++;
+    counter += counter == 0;
+}
+
+FUZZ_NO_COVERAGE void __sanitizer_cov_trace_pc() {
+    if (!CoverageMap::tracing)
+    {
+        return;
+    }
+    CoverageMap::hashedEdges = true;
+    uintptr_t location = reinterpret_cast<uintptr_t>(__builtin_return_address(0));
+    location = (location ^ (location >> 17)) * 0x9e3779b97f4a7c15ULL;
+    location >>= 48;
+    uint8_t& counter = CoverageMap::counters[(location ^ CoverageMap::previousLocation) % CoverageMap::MAP_SIZE];
+    counter++;
+    counter += counter == 0;
+    CoverageMap::previousLocation = location >> 1;
+}
+
+}
+#endif
+
+/**
+ * @brief 模糊测试的参数。
+ */
+struct FuzzOptions {
+    /// @brief 测试名称。
+    NameType name = "Fuzz";
+
+    /// @brief 最多执行的次数，为 0 时不限制。
+    uint64_t maxRuns = 0;
+
+    /// @brief 最长执行时间。
+    std::chrono::milliseconds maxTime{10000};
+
+    /// @brief 变异产生的输入的最大长度。
+    size_t maxInputLength = 4096;
+
+    /// @brief 变异使用的随机数种子。
+    uint64_t seed = 0;
+
+    /// @brief 找到多少个失败的输入后停止，为 0 时不停止。
+    size_t maxFailures = 1;
+
+    /// @brief 语料目录。启动时从中读取初始输入，运行中产生新覆盖的输入和失败的输入会写入此目录；为空时不读写文件。
+    std::string corpusDirectory;
+
+    /// @brief 字典，变异时会将其中的词插入或覆盖到输入中。
+    std::vector<std::string> dictionary;
+};
+
+/**
+ * @brief 输入变异器。
+ *
+ * 每次变异随机叠加 1 到 4 个基本操作：位翻转、字节替换为特殊值、字节加减、插入或删除随机字节、
+ * 输入内部的片段复制、与语料中另一个输入拼接，以及插入或覆盖字典中的词。
+ */
+class InputMutator {
+public:
+    InputMutator(size_t maxLength, const std::vector<std::string>& dictionary) : maxLength(maxLength), dictionary(dictionary) {}
+
+    /**
+     * @brief 原地变异一个输入。
+     *
+     * @param input 待变异的输入。
+     * @param rng 随机数生成器。
+     * @param corpus 当前的语料，拼接时从中选择另一个输入。
+     */
+    void mutate(std::string& input, Xoshiro256& rng, const std::vector<std::string>& corpus) const {
+        size_t rounds = 1 + rng.nextBelow(4);
+        for (size_t round = 0; round < rounds; round++)
+        {
+            switch (rng.nextBelow(dictionary.empty() ? 7 : 8))
+            {
+            case 0:
+                flipBit(input, rng);
+                break;
+            case 1:
+                setInterestingByte(input, rng);
+                break;
+            case 2:
+                addToByte(input, rng);
+                break;
+            case 3:
+                insertBytes(input, rng);
+                break;
+            case 4:
+                eraseBytes(input, rng);
+                break;
+            case 5:
+                copyChunk(input, rng);
+                break;
+            case 6:
+                splice(input, rng, corpus);
+                break;
+            default:
+                insertToken(input, rng);
+                break;
+            }
+        }
+        if (input.size() > maxLength)
+        {
+            input.resize(maxLength);
+        }
+    }
+
+private:
+    size_t maxLength;
+    const std::vector<std::string>& dictionary;
+
+    static void flipBit(std::string& input, Xoshiro256& rng) {
+        if (input.empty())
+        {
+            input.push_back(static_cast<char>(rng.next()));
+            return;
+        }
+        uint64_t bit = rng.nextBelow(input.size() * 8);
+        input[bit / 8] = static_cast<char>(input[bit / 8] ^ (1 << (bit % 8)));
+    }
+
+    static void setInterestingByte(std::string& input, Xoshiro256& rng) {
+        static const unsigned char interesting[] = {0x00, 0x01, 0x7F, 0x80, 0xFF, '0', 'a', ' ', '\n'};
+        if (input.empty())
+        {
+            input.push_back(0);
+        }
+        input[rng.nextBelow(input.size())] = static_cast<char>(interesting[rng.nextBelow(sizeof(interesting))]);
+    }
+
+    static void addToByte(std::string& input, Xoshiro256& rng) {
+        if (input.empty())
+        {
+            return;
+        }
+        char& byte = input[rng.nextBelow(input.size())];
+        byte = static_cast<char>(byte + static_cast<int>(rng.nextBelow(71)) - 35);
+    }
+
+    void insertBytes(std::string& input, Xoshiro256& rng) const {
+        size_t count = 1 + rng.nextBelow(8);
+        if (input.size() + count > maxLength)
+        {
+            return;
+        }
+        std::string bytes(count, '\0');
+        fillBytes(rng, &bytes[0], count);
+        input.insert(rng.nextBelow(input.size() + 1), bytes);
+    }
+
+    static void eraseBytes(std::string& input, Xoshiro256& rng) {
+        if (input.size() < 2)
+        {
+            return;
+        }
+        size_t position = rng.nextBelow(input.size());
+        input.erase(position, 1 + rng.nextBelow(input.size() - position));
+    }
+
+    static void copyChunk(std::string& input, Xoshiro256& rng) {
+        if (input.size() < 2)
+        {
+            return;
+        }
+        size_t from = rng.nextBelow(input.size());
+        size_t length = 1 + rng.nextBelow(input.size() - from);
+        size_t to = rng.nextBelow(input.size() - length + 1);
+        std::string chunk = input.substr(from, length);
+        input.replace(to, length, chunk);
+    }
+
+    static void splice(std::string& input, Xoshiro256& rng, const std::vector<std::string>& corpus) {
+        const std::string& other = corpus[rng.nextBelow(corpus.size())];
+        if (other.empty())
+        {
+            return;
+        }
+        size_t keep = rng.nextBelow(input.size() + 1);
+        size_t from = rng.nextBelow(other.size());
+        input.replace(keep, std::string::npos, other, from, std::string::npos);
+    }
+
+    void insertToken(std::string& input, Xoshiro256& rng) const {
+        const std::string& token = dictionary[rng.nextBelow(dictionary.size())];
+        size_t position = rng.nextBelow(input.size() + 1);
+        if (rng.nextBelow(2) == 0 || position + token.size() > input.size())
+        {
+            input.insert(position, token);
+        }
+        else
+        {
+            input.replace(position, token.size(), token);
+        }
+    }
+};
+
+/**
+ * @brief 覆盖率引导的模糊测试容器。
+ *
+ * 以一个 `TestExecutorClass` 的子类作为模糊测试目标：执行者的数据指针指向当前输入（`std::string`，内容为任意字节），
+ * 执行者中失败的断言即视为发现了问题，抛出的异常同样视为失败。
+ * 模糊测试在当前线程中以最高速度循环执行：从语料中选择一个输入、变异、执行并收集覆盖率，
+ * 产生新覆盖的输入加入语料并写入语料目录，失败的输入以 `failure-` 为前缀写入语料目录。
+ * 覆盖率计数表由整个进程共享，并行模式下同时被调度的多个模糊测试依次执行，与基准测试的互斥方式相同。
+ *
+ * 执行次数、每秒执行次数、覆盖率的增长和语料的大小会作为附加统计信息随测试汇总一并输出；
+ * 失败的输入对应的错误信息中，`Test N` 的 N 为该输入的执行序号。
+ *
+ * 示例：
+ * ```cpp
+ * std::vector<std::string> seeds = {"hello"};
+ * FuzzOptions options;
+ * options.corpusDirectory = "fuzz-corpus";
+ * CoverageFuzzerClass<ParserExecutorClass> fuzzer(&seeds, options);
+ * fuzzer.ProceedTest("ParserFuzz");
+ * ```
+ *
+ * @tparam Executor 模糊测试目标，需要提供 `Executor(void* dataPtr, ssize_t testIndex)` 构造函数。
+ */
+template <typename Executor>
+class CoverageFuzzerClass : public TestContainerClass {
+public:
+    /// @brief 构造函数。
+    /// @param dataPtr 指向初始输入 `std::vector<std::string>` 的指针，可以为 nullptr。
+    /// @param options 模糊测试的参数。
+    CoverageFuzzerClass(void* dataPtr, FuzzOptions options = FuzzOptions()) : TestContainerClass(true, dataPtr), options(std::move(options)) {}
+
+    TestResult RunTest(NameType testName) override {
+        // 覆盖率计数表是进程级的，时间预算从取得锁之后开始计算
+        std::lock_guard<std::mutex> guard(CoverageMap::exclusive());
+        NameType fullName = testName + "." + options.name;
+        this->testResult = TestResult(0, false, fullName);
+        this->testResult.isParentOfLeaf = true;
+        fullTestName = fullName;
+        startTime = std::chrono::steady_clock::now();
+        rng.reseed(options.seed);
+
+        if (!options.corpusDirectory.empty())
+        {
+            mkdir(options.corpusDirectory.c_str(), 0755);
+        }
+        std::vector<std::string> seeds = loadSeeds();
+        for (const auto& seed : seeds)
+        {
+            if (execute(seed) && !stopped())
+            {
+                corpus.push_back(seed);
+            }
+        }
+        if (corpus.empty())
+        {
+            corpus.push_back(seeds.empty() ? std::string() : seeds.front());
+        }
+        size_t seedEdges = tracker.edgeCount();
+        size_t seedCorpusSize = corpus.size();
+        uint64_t lastNewCoverage = 0;
+
+        InputMutator mutator(options.maxInputLength, options.dictionary);
+        std::string input;
+        while (!stopped())
+        {
+            input = corpus[rng.nextBelow(corpus.size())];
+            mutator.mutate(input, rng, corpus);
+            if (execute(input))
+            {
+                corpus.push_back(input);
+                saveInput(input, "");
+                lastNewCoverage = elapsedSinceStart();
+            }
+        }
+
+        uint64_t elapsed = elapsedSinceStart();
+        uint64_t rate = elapsed == 0 ? executions : static_cast<uint64_t>(executions * 1e9 / elapsed);
+        TestResult& result = this->testResult;
+        result.subTestCount = static_cast<ssize_t>(executions);
+        result.finishedCount = static_cast<ssize_t>(executions);
+        result.summaryInfo.push_back("Fuzzing: " + std::to_string(executions) + " executions in " + formatTime(elapsed) + " (" +
+                                     std::to_string(rate) + " exec/s)");
+        if (tracker.edgeCount() == 0)
+        {
+            result.summaryInfo.push_back("Coverage: no instrumentation detected, build the target with -fsanitize-coverage=trace-pc-guard (clang) "
+                                         "or -fsanitize-coverage=trace-pc (gcc) and define FUZZ_TEST_SCHEMA_COVERAGE in one source file");
+        }
+        else
+        {
+            result.summaryInfo.push_back("Coverage: " + std::to_string(seedEdges) + " edges from seeds, " + std::to_string(tracker.edgeCount()) + " edges at the end" +
+                                         (corpus.size() == seedCorpusSize ? ", no new input found" : ", last new input found after " + formatTime(lastNewCoverage)));
+        }
+        result.summaryInfo.push_back("Corpus: " + std::to_string(corpus.size()) + " inputs (" + std::to_string(corpus.size() - seedCorpusSize) + " new)" +
+                                     (options.corpusDirectory.empty() ? "" : ", saved in " + options.corpusDirectory));
+        return this->testResult;
+    }
+
+    /// @brief 当前的语料。
+    const std::vector<std::string>& Corpus() const { return corpus; }
+
+private:
+    FuzzOptions options;
+    NameType fullTestName;
+    Xoshiro256 rng;
+    CoverageTracker tracker;
+    std::vector<std::string> corpus;
+    std::chrono::steady_clock::time_point startTime;
+    uint64_t executions = 0;
+    size_t failures = 0;
+
+    uint64_t elapsedSinceStart() const {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - startTime).count();
+    }
+
+    bool stopped() const {
+        if (Watchdog::shouldStop())
+        {
+            return true;
+        }
+        if (options.maxFailures != 0 && failures >= options.maxFailures)
+        {
+            return true;
+        }
+        if (options.maxRuns != 0 && executions >= options.maxRuns)
+        {
+            return true;
+        }
+        // 每次执行后都读取时钟，较慢的目标也不会超出时间预算
+        return std::chrono::steady_clock::now() - startTime >= options.maxTime;
+    }
+
+    /// @brief 执行一次输入，返回是否产生了新的覆盖。失败的输入不会加入语料。
+    bool execute(const std::string& input) {
+        uint64_t index = executions++;
+        TestResult result;
+        START_TIMER;
+        CoverageMap::begin();
+        try
+        {
+            Executor executor(const_cast<std::string*>(&input), static_cast<ssize_t>(index));
+            result = executor.ProceedTest(fullTestName);
+        }
+        catch (const std::exception& exception)
+        {
+            result.testIndex = static_cast<u_int32_t>(index);
+            result.recordMessage("Test " + std::to_string(index) + ": Uncaught exception: " + exception.what());
+        }
+        catch (...)
+        {
+            result.testIndex = static_cast<u_int32_t>(index);
+            result.recordMessage("Test " + std::to_string(index) + ": Uncaught exception of unknown type");
+        }
+        CoverageMap::end();
+        uint64_t time = FINISH_TIMER;
+        bool found = tracker.merge();
+
+        TestResult& aggregate = this->testResult;
+        aggregate.latency.record(time);
+        aggregate.counters += result.counters;
+        aggregate.allocations += result.allocations;
+        if (result.success)
+        {
+            return found;
+        }
+        failures++;
+        aggregate.success = false;
+        aggregate.failedCount++;
+        for (const auto& error : result.formatErrors())
+        {
+            aggregate.errorInfo.push_back(error);
+        }
+        std::string path = saveInput(input, "failure-");
+        aggregate.errorInfo.push_back("Test " + std::to_string(index) + ": Failing input (" + std::to_string(input.size()) + " bytes)" +
+                                      (path.empty() ? ": " + escapeInput(input) : " saved to " + path));
+        return false;
+    }
+
+    /// @brief 读取初始输入：数据指针中的输入和语料目录中的文件。
+    std::vector<std::string> loadSeeds() const {
+        std::vector<std::string> seeds;
+        if (this->dataPtr != nullptr)
+        {
+            seeds = *DATA_PTR(std::vector<std::string>);
+        }
+        if (options.corpusDirectory.empty())
+        {
+            return seeds;
+        }
+        DIR* directory = opendir(options.corpusDirectory.c_str());
+        if (directory == nullptr)
+        {
+            return seeds;
+        }
+        while (dirent* entry = readdir(directory))
+        {
+            std::string name = entry->d_name;
+            if (name == "." || name == ".." || name.compare(0, 8, "failure-") == 0)
+            {
+                continue;
+            }
+            std::ifstream file(options.corpusDirectory + "/" + name, std::ios::binary);
+            if (file)
+            {
+                std::string content((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+                content.resize(content.size() < options.maxInputLength ? content.size() : options.maxInputLength);
+                seeds.push_back(std::move(content));
+            }
+        }
+        closedir(directory);
+        return seeds;
+    }
+
+    /// @brief 将输入写入语料目录，文件名为内容的哈希值，返回写入的路径。
+    std::string saveInput(const std::string& input, const std::string& prefix) const {
+        return saveInputFile(options.corpusDirectory, prefix, input);
+    }
+};
+
+#endif
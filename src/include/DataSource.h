@@ -0,0 +1,201 @@
+#ifndef DATA_SOURCE_H
+#define DATA_SOURCE_H
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief 分块数据源。
+ *
+ * 数据源按块依次产出测试数据，每一块通常对应一个 `TestContainerClass` 的全部输入。
+ * 与一次性在 `SetUp()` 中准备好全部数据相比，分块产出可以让内存占用只与块的大小有关，而与整个数据集的大小无关。
+ *
+ * @tparam Chunk 每一块数据的类型。
+ */
+template <typename Chunk>
+class ChunkSource {
+public:
+    virtual ~ChunkSource() {}
+
+    /// @brief 取出下一块数据。
+    /// @return 返回下一块数据，没有更多数据时返回 nullptr。
+    virtual std::unique_ptr<Chunk> next() = 0;
+};
+
+/**
+ * @brief 由生成函数产出数据块的数据源。
+ *
+ * 生成函数形如 `bool(Chunk&)`：向传入的空数据块填充数据并返回 true，没有更多数据时返回 false。
+ *
+ * 示例：
+ * ```cpp
+ * int i = 0;
+ * GeneratorSource<ContainerType> source([&i](ContainerType& chunk) {
+ *     if (i == 20) return false;
+ *     chunk.second = "test-" + std::to_string(i++);
+ *     ...
+ *     return true;
+ * });
+ * ```
+ */
+template <typename Chunk>
+class GeneratorSource : public ChunkSource<Chunk> {
+public:
+    /// @brief 构造函数。
+    /// @param generator 数据块生成函数。
+    explicit GeneratorSource(std::function<bool(Chunk&)> generator) : generator(std::move(generator)) {}
+
+    std::unique_ptr<Chunk> next() override {
+        std::unique_ptr<Chunk> chunk(new Chunk());
+        if (!generator(*chunk))
+        {
+            return nullptr;
+        }
+        return chunk;
+    }
+
+private:
+    std::function<bool(Chunk&)> generator;
+};
+
+/**
+ * @brief 将一个迭代器区间按固定大小切分为数据块的数据源。
+ *
+ * 只要求输入迭代器，因此也可以用于 `std::istream_iterator` 等逐个读取的数据。
+ * 每一块是一个包含至多 `chunkSize` 个元素的 `std::vector`。
+ *
+ * @tparam Iterator 迭代器类型。
+ */
+template <typename Iterator>
+class IteratorSource : public ChunkSource<std::vector<typename std::iterator_traits<Iterator>::value_type>> {
+public:
+    using Chunk = std::vector<typename std::iterator_traits<Iterator>::value_type>;
+
+    /// @brief 构造函数。
+    /// @param begin 区间起点。
+    /// @param end 区间终点。
+    /// @param chunkSize 每一块包含的元素数量。
+    IteratorSource(Iterator begin, Iterator end, size_t chunkSize) : current(begin), end(end), chunkSize(chunkSize == 0 ? 1 : chunkSize) {}
+
+    std::unique_ptr<Chunk> next() override {
+        if (current == end)
+        {
+            return nullptr;
+        }
+        std::unique_ptr<Chunk> chunk(new Chunk());
+        chunk->reserve(chunkSize);
+        while (current != end && chunk->size() < chunkSize)
+        {
+            chunk->push_back(*current);
+            ++current;
+        }
+        return chunk;
+    }
+
+private:
+    Iterator current;
+    Iterator end;
+    size_t chunkSize;
+};
+
+/**
+ * @brief 双缓冲的预取数据源。
+ *
+ * 包装另一个数据源，在后台线程中提前取出并预处理下一块数据。调用者在测试第 N 块数据时，
+ * 第 N+1 块已经在后台准备；后台线程在准备好的数据块被取走之前不会开始准备下一块，
+ * 因此任意时刻最多同时存在两块数据（调用者在取下一块之前应当先释放当前块）。
+ *
+ * 后台线程中抛出的异常会在下一次调用 `next()` 时重新抛出。
+ */
+template <typename Chunk>
+class PrefetchingSource : public ChunkSource<Chunk> {
+public:
+    /// @brief 构造函数。
+    /// @param upstream 被包装的数据源。
+    /// @param prepare 在后台线程中对每一块数据执行的预处理，可以为空。
+    PrefetchingSource(std::unique_ptr<ChunkSource<Chunk>> upstream, std::function<void(Chunk&)> prepare = nullptr)
+        : upstream(std::move(upstream)), prepare(std::move(prepare)) {
+        worker = std::thread([this] { produce(); });
+    }
+
+    ~PrefetchingSource() override {
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            stopping = true;
+        }
+        changed.notify_all();
+        worker.join();
+    }
+
+    std::unique_ptr<Chunk> next() override {
+        std::unique_lock<std::mutex> guard(lock);
+        changed.wait(guard, [this] { return ready != nullptr || exhausted; });
+        if (ready == nullptr && error)
+        {
+            std::rethrow_exception(error);
+        }
+        std::unique_ptr<Chunk> chunk = std::move(ready);
+        guard.unlock();
+        changed.notify_all();
+        return chunk;
+    }
+
+private:
+    std::unique_ptr<ChunkSource<Chunk>> upstream;
+    std::function<void(Chunk&)> prepare;
+    std::thread worker;
+
+    std::mutex lock;
+    std::condition_variable changed;
+    std::unique_ptr<Chunk> ready;
+    bool exhausted = false;
+    bool stopping = false;
+    std::exception_ptr error;
+
+    void produce() {
+        while (true)
+        {
+            {
+                std::unique_lock<std::mutex> guard(lock);
+                changed.wait(guard, [this] { return ready == nullptr || stopping; });
+                if (stopping)
+                {
+                    return;
+                }
+            }
+            std::unique_ptr<Chunk> chunk;
+            try
+            {
+                chunk = upstream->next();
+                if (chunk != nullptr && prepare)
+                {
+                    prepare(*chunk);
+                }
+            }
+            catch (...)
+            {
+                std::lock_guard<std::mutex> guard(lock);
+                error = std::current_exception();
+                chunk = nullptr;
+            }
+            bool finished = chunk == nullptr;
+            {
+                std::lock_guard<std::mutex> guard(lock);
+                exhausted = finished;
+                ready = std::move(chunk);
+            }
+            changed.notify_all();
+            if (finished)
+            {
+                return;
+            }
+        }
+    }
+};
+
+#endif
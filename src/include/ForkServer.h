@@ -0,0 +1,665 @@
+#ifndef FORK_SERVER_H
+#define FORK_SERVER_H
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <iostream>
+#include <mutex>
+#include <new>
+#include <string>
+#include <type_traits>
+#include <vector>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <TestResult.h>
+#include <InputFiles.h>
+#include <ResultCache.h>
+
+/**
+ * @brief 测试输入与字节串之间的转换。
+ *
+ * 隔离执行时，输入需要以字节串的形式发送给工作进程，导致崩溃的输入也以字节串的形式保存。
+ * 默认支持 `std::string`、可平凡复制的类型以及由它们组成的 `std::vector`；其他输入类型需要特化此模板，
+ * 提供 `static std::string encode(const T&)` 和 `static T decode(const std::string&)`。
+ *
+ * @tparam T 输入类型。
+ */
+template <typename T, typename Enable = void>
+struct InputCodec {
+    static_assert(std::is_trivially_copyable<T>::value, "InputCodec: specialize InputCodec<T> for this input type");
+
+    static std::string encode(const T& value) { return std::string(reinterpret_cast<const char*>(&value), sizeof(T)); }
+
+    static T decode(const std::string& bytes) {
+        T value{};
+        std::memcpy(&value, bytes.data(), bytes.size() < sizeof(T) ? bytes.size() : sizeof(T));
+        return value;
+    }
+};
+
+template <>
+struct InputCodec<std::string> {
+    static std::string encode(const std::string& value) { return value; }
+    static std::string decode(const std::string& bytes) { return bytes; }
+};
+
+template <typename T>
+struct InputCodec<std::vector<T>, typename std::enable_if<std::is_trivially_copyable<T>::value>::type> {
+    static std::string encode(const std::vector<T>& value) {
+        return std::string(reinterpret_cast<const char*>(value.data()), value.size() * sizeof(T));
+    }
+
+    static std::vector<T> decode(const std::string& bytes) {
+        std::vector<T> value(bytes.size() / sizeof(T));
+        std::memcpy(value.data(), bytes.data(), value.size() * sizeof(T));
+        return value;
+    }
+};
+
+/**
+ * @brief 隔离执行的参数。
+ */
+struct ForkServerOptions {
+    /// @brief 工作进程的数量，为 0 时与线程池的线程数相同（串行模式下为 1）。
+    size_t workers = 0;
+
+    /// @brief 保存导致崩溃的输入的目录，默认为空，此时不写入任何文件，而是把输入写入错误信息。
+    std::string crashDirectory;
+};
+
+/**
+ * @brief 隔离执行叶子测试的 fork 服务器。
+ *
+ * 启用后，每个驱动类在 `SetUp()` 结束时 fork 出一个 fork 服务器进程，它保留了此刻的全部状态（包括已经载入的测试数据）；
+ * 之后需要工作进程时由 fork 服务器再 fork 出来，因此每个工作进程都从 `SetUp()` 之后的状态开始，而无需重新启动进程。
+ * 工作进程是常驻的：它依次执行分配给它的叶子测试，直到崩溃或者驱动类结束。
+ *
+ * `IsolatedExecutorClass` 把叶子测试的输入经 `InputCodec` 编码后发送给一个空闲的工作进程，在其中执行真正的测试，
+ * 再取回结果。工作进程因信号（包括段错误和 sanitizer 的 abort）终止或者自行退出时，这个叶子测试记为失败，
+ * 错误信息包括信号或退出码和输入本身（设置了 `crashDirectory` 时改为保存到该目录中）；随后由 fork 服务器补充一个新的工作进程，父进程继续调度其余的测试。
+ * 设置了 `Watchdog` 的叶子预算时，超时的工作进程会被直接杀死，这个叶子测试记为超时失败。
+ *
+ * 进程之间通过 UNIX 域套接字通信：父进程与 fork 服务器之间有一条控制连接，新工作进程的连接通过 `SCM_RIGHTS` 传给父进程。
+ * 请求中直接携带处理函数的地址，由于工作进程与父进程的地址空间布局相同，这个地址在工作进程中同样有效。
+ *
+ * 注意：
+ * 工作进程中只有执行测试的线程，测试代码不应使用线程池或向控制台输出进度；工作进程以 `_exit()` 结束，不会执行全局对象的析构函数。
+ *
+ * 示例：
+ * ```cpp
+ * ForkServerOptions options;
+ * options.crashDirectory = "crashes";
+ * ForkServer::enable(options);
+ * rootClass.ProceedTest("ShowCase");
+ * ```
+ */
+class ForkServer {
+public:
+    /// @brief 在工作进程中执行一个叶子测试的函数。
+    using Handler = TestResult (*)(const std::string& input, size_t testIndex, const std::string& testName);
+
+    /**
+     * @brief 隔离执行的作用范围。
+     *
+     * 由驱动类在 `SetUp()` 之后创建：启用了隔离执行时启动 fork 服务器，离开作用范围时结束所有工作进程。
+     * 嵌套的或在多个线程中同时存在的作用范围（例如测试图中并行执行的兄弟驱动类）共享同一个 fork 服务器，
+     * 最后一个离开的作用范围结束所有工作进程。
+     */
+    class Session {
+    public:
+        Session() : owner(ForkServer::instance().begin()) {}
+        ~Session() {
+            if (owner)
+            {
+                ForkServer::instance().end();
+            }
+        }
+        Session(const Session&) = delete;
+        Session& operator=(const Session&) = delete;
+
+    private:
+        bool owner;
+    };
+
+    /// @brief 全局唯一的 fork 服务器。
+    static ForkServer& instance() {
+        static ForkServer server;
+        return server;
+    }
+
+    /// @brief 启用隔离执行。
+    static void enable(ForkServerOptions options = ForkServerOptions()) {
+        ForkServer& server = instance();
+        std::lock_guard<std::mutex> guard(server.poolLock);
+        server.options = std::move(options);
+        server.enabled = true;
+    }
+
+    /// @brief 是否启用了隔离执行。
+    static bool isEnabled() { return instance().enabled; }
+
+    /// @brief fork 服务器是否正在运行，即当前是否在一个 `Session` 之内。
+    bool isRunning() const { return controlFd >= 0; }
+
+    /**
+     * @brief 在一个工作进程中执行叶子测试。
+     *
+     * 此方法是线程安全的，并行模式下多个线程会同时使用不同的工作进程。
+     *
+     * @param handler 在工作进程中执行测试的函数。
+     * @param input 编码后的输入。
+     * @param testIndex 叶子测试的索引号。
+     * @param testName 测试的名称。
+     * @return 返回工作进程中的测试结果；工作进程异常终止时返回失败的结果。
+     */
+    TestResult execute(Handler handler, const std::string& input, size_t testIndex, const std::string& testName) {
+        TestResult result;
+        result.isLeaf = true;
+        result.testIndex = static_cast<u_int32_t>(testIndex);
+
+        Worker worker;
+        if (!acquire(worker))
+        {
+            result.recordMessage("Test " + std::to_string(testIndex) + ": Failed to start an isolated worker process");
+            return result;
+        }
+
+        // 超时时直接杀死工作进程，执行测试的线程随即读到连接关闭
+        pid_t pid = worker.pid;
+        Watchdog::Watch watch(WatchKind::LEAF, [&] { return testName + " test " + std::to_string(testIndex); }, [pid] { ::kill(pid, SIGKILL); });
+        std::string request;
+        appendInteger(request, reinterpret_cast<uint64_t>(handler));
+        appendInteger(request, testIndex);
+        appendString(request, testName);
+        appendString(request, input);
+        START_TIMER;
+        std::string response;
+        bool completed = writeFrame(worker.fd, request) && readFrame(worker.fd, response) && decodeResult(response, result);
+        // 结束监视之后看门狗不会再杀死这个工作进程，此时才能把它交给下一个测试
+        bool timedOut = watch.finish();
+        if (completed && !timedOut)
+        {
+            release(worker);
+            return result;
+        }
+        if (!completed)
+        {
+            result.runTime = FINISH_TIMER;
+        }
+
+        int status = reap(worker);
+        std::string path = saveInputFile(options.crashDirectory, timedOut ? "timeout-" : "crash-", input);
+        std::string inputText = "(" + std::to_string(input.size()) + " bytes)" + (path.empty() ? ": " + escapeInput(input) : " saved to " + path);
+        if (timedOut)
+        {
+            result.recordMessage("Test " + std::to_string(testIndex) + ": " + watch.describe() + ", worker process killed");
+            result.errorInfo.push_back("Test " + std::to_string(testIndex) + ": Timed out input " + inputText);
+            return result;
+        }
+        result.recordMessage("Test " + std::to_string(testIndex) + ": " + describeStatus(status));
+        result.errorInfo.push_back("Test " + std::to_string(testIndex) + ": Crashing input " + inputText);
+        return result;
+    }
+
+    /// @brief 自启用以来异常终止的工作进程数量。
+    size_t crashCount() const {
+        std::lock_guard<std::mutex> guard(poolLock);
+        return crashes;
+    }
+
+private:
+    struct Worker {
+        int fd = -1;
+        pid_t pid = -1;
+    };
+
+    ForkServerOptions options;
+    bool enabled = false;
+
+    /// @brief 与 fork 服务器之间的控制连接，由 `controlLock` 保护。
+    int controlFd = -1;
+    pid_t serverPid = -1;
+    std::mutex controlLock;
+
+    /// @brief 保护 fork 服务器的启动和结束，`sessionUsers` 为当前存在的作用范围数量。
+    std::mutex sessionLock;
+    size_t sessionUsers = 0;
+
+    mutable std::mutex poolLock;
+    std::condition_variable workerReleased;
+    std::vector<Worker> idleWorkers;
+    size_t liveWorkers = 0;
+    size_t maxWorkers = 1;
+    size_t crashes = 0;
+
+    ForkServer() {}
+
+    bool begin() {
+        std::lock_guard<std::mutex> guard(sessionLock);
+        if (!enabled)
+        {
+            return false;
+        }
+        if (sessionUsers != 0)
+        {
+            sessionUsers++;
+            return true;
+        }
+        if (!options.crashDirectory.empty())
+        {
+            mkdir(options.crashDirectory.c_str(), 0755);
+        }
+        WorkStealingPool* pool = TestScheduler::pool();
+        maxWorkers = options.workers != 0 ? options.workers : (pool != nullptr ? pool->threadCount() : 1);
+
+        int sockets[2];
+        if (socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, sockets) != 0)
+        {
+            return false;
+        }
+        // 在 fork 之前刷新输出和报告的缓冲区，以免缓冲的内容在子进程中被重复输出
+        OutputSink::instance().flush();
+        ResultReporter::instance().flush();
+        std::cout.flush();
+        std::fflush(nullptr);
+        pid_t pid = fork();
+        if (pid < 0)
+        {
+            ::close(sockets[0]);
+            ::close(sockets[1]);
+            return false;
+        }
+        if (pid == 0)
+        {
+            ::close(sockets[0]);
+            prepareChild();
+            runServer(sockets[1]);
+            _exit(0);
+        }
+        ::close(sockets[1]);
+        controlFd = sockets[0];
+        serverPid = pid;
+
+        Worker worker;
+        for (size_t i = 0; i < maxWorkers && spawn(worker); i++)
+        {
+            std::lock_guard<std::mutex> guard(poolLock);
+            idleWorkers.push_back(worker);
+            liveWorkers++;
+        }
+        sessionUsers = 1;
+        return true;
+    }
+
+    void end() {
+        std::lock_guard<std::mutex> sessionGuard(sessionLock);
+        if (--sessionUsers != 0)
+        {
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> guard(poolLock);
+            for (const Worker& worker : idleWorkers)
+            {
+                ::close(worker.fd);
+            }
+            idleWorkers.clear();
+            liveWorkers = 0;
+        }
+        // 关闭控制连接后，fork 服务器回收所有工作进程并退出
+        ::close(controlFd);
+        controlFd = -1;
+        int status;
+        while (waitpid(serverPid, &status, 0) < 0 && errno == EINTR)
+        {
+        }
+        serverPid = -1;
+    }
+
+    bool acquire(Worker& worker) {
+        std::unique_lock<std::mutex> guard(poolLock);
+        workerReleased.wait(guard, [this] { return !idleWorkers.empty() || liveWorkers < maxWorkers; });
+        if (!idleWorkers.empty())
+        {
+            worker = idleWorkers.back();
+            idleWorkers.pop_back();
+            return true;
+        }
+        liveWorkers++;
+        guard.unlock();
+        if (spawn(worker))
+        {
+            return true;
+        }
+        guard.lock();
+        liveWorkers--;
+        workerReleased.notify_one();
+        return false;
+    }
+
+    void release(const Worker& worker) {
+        std::lock_guard<std::mutex> guard(poolLock);
+        idleWorkers.push_back(worker);
+        workerReleased.notify_one();
+    }
+
+    /// @brief 回收一个异常终止的工作进程，返回它的终止状态。
+    int reap(const Worker& worker) {
+        ::close(worker.fd);
+        int status = -1;
+        {
+            std::lock_guard<std::mutex> guard(controlLock);
+            std::string request(1, 'W');
+            appendInteger(request, static_cast<uint64_t>(worker.pid));
+            std::string response;
+            if (writeFrame(controlFd, request) && readFrame(controlFd, response) && response.size() == sizeof(uint64_t))
+            {
+                size_t offset = 0;
+                status = static_cast<int>(readInteger(response, offset));
+            }
+        }
+        std::lock_guard<std::mutex> guard(poolLock);
+        liveWorkers--;
+        crashes++;
+        workerReleased.notify_one();
+        return status;
+    }
+
+    /// @brief 请求 fork 服务器创建一个新的工作进程。
+    bool spawn(Worker& worker) {
+        std::lock_guard<std::mutex> guard(controlLock);
+        if (controlFd < 0 || !writeFrame(controlFd, std::string(1, 'S')))
+        {
+            return false;
+        }
+        uint64_t pid = 0;
+        int fd = receiveDescriptor(controlFd, pid);
+        if (fd < 0)
+        {
+            return false;
+        }
+        worker.fd = fd;
+        worker.pid = static_cast<pid_t>(pid);
+        return true;
+    }
+
+    static std::string describeStatus(int status) {
+        if (status >= 0 && WIFSIGNALED(status))
+        {
+            int signal = WTERMSIG(status);
+            const char* name = strsignal(signal);
+            return "Crashed with signal " + std::to_string(signal) + " (" + (name != nullptr ? name : "unknown") + ")";
+        }
+        if (status >= 0 && WIFEXITED(status))
+        {
+            return "Worker process exited with code " + std::to_string(WEXITSTATUS(status)) + " during the test";
+        }
+        return "Worker process terminated for an unknown reason";
+    }
+
+    /**
+     * @brief fork 之后在 fork 服务器进程中清理从父进程继承的线程状态。
+     *
+     * 子进程中只有调用 fork 的线程，其余线程持有的锁永远不会被释放，线程池和渲染线程也不复存在。
+     * 重新构造工作进程可能用到的锁并丢弃线程池，使得测试代码调用 `exit()` 时全局对象的析构函数不会卡住；
+     * 丢弃继承的结果报告，使得析构函数不会向父进程的报告文件写入重复的记录和结尾。
+     */
+    static void prepareChild() {
+        new (&outputMutex()) std::mutex();
+        OutputSink::instance().abandonAfterFork();
+        // fork 时父进程正持有 `sessionLock`
+        new (&instance().sessionLock) std::mutex();
+        instance().sessionUsers = 0;
+        TestScheduler::abandonAfterFork();
+        ProgressRenderer::instance().abandonAfterFork();
+        Watchdog::instance().abandonAfterFork();
+        ResultReporter::instance().abandonAfterFork();
+        PerformanceBaseline::instance().abandonAfterFork();
+        ResultCache::instance().abandonAfterFork();
+    }
+
+    /// @brief fork 服务器进程的主循环。
+    static void runServer(int fd) {
+        std::string request;
+        while (readFrame(fd, request))
+        {
+            if (request == "S")
+            {
+                int sockets[2];
+                if (socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, sockets) != 0)
+                {
+                    break;
+                }
+                pid_t pid = fork();
+                if (pid == 0)
+                {
+                    ::close(fd);
+                    ::close(sockets[0]);
+                    runWorker(sockets[1]);
+                    _exit(0);
+                }
+                ::close(sockets[1]);
+                if (pid < 0 || !sendDescriptor(fd, sockets[0], static_cast<uint64_t>(pid)))
+                {
+                    ::close(sockets[0]);
+                    break;
+                }
+                ::close(sockets[0]);
+            }
+            else if (!request.empty() && request[0] == 'W')
+            {
+                size_t offset = 1;
+                pid_t pid = static_cast<pid_t>(readInteger(request, offset));
+                int status = -1;
+                while (waitpid(pid, &status, 0) < 0 && errno == EINTR)
+                {
+                }
+                std::string response;
+                appendInteger(response, static_cast<uint64_t>(static_cast<uint32_t>(status)));
+                writeFrame(fd, response);
+            }
+        }
+        ::close(fd);
+        while (wait(nullptr) > 0 || errno == EINTR)
+        {
+        }
+    }
+
+    /// @brief 工作进程的主循环。
+    static void runWorker(int fd) {
+        std::string request;
+        while (readFrame(fd, request))
+        {
+            size_t offset = 0;
+            Handler handler = reinterpret_cast<Handler>(readInteger(request, offset));
+            size_t testIndex = static_cast<size_t>(readInteger(request, offset));
+            std::string testName = readString(request, offset);
+            std::string input = readString(request, offset);
+            TestResult result;
+            try
+            {
+                result = handler(input, testIndex, testName);
+            }
+            catch (const std::exception& exception)
+            {
+                result.isLeaf = true;
+                result.recordMessage("Test " + std::to_string(testIndex) + ": Uncaught exception: " + exception.what());
+            }
+            catch (...)
+            {
+                result.isLeaf = true;
+                result.recordMessage("Test " + std::to_string(testIndex) + ": Uncaught exception of unknown type");
+            }
+            if (!writeFrame(fd, encodeResult(result)))
+            {
+                break;
+            }
+        }
+    }
+
+    static std::string encodeResult(const TestResult& result) {
+        std::string response;
+        appendInteger(response, result.success ? 1 : 0);
+        appendInteger(response, result.runTime);
+        std::vector<std::string> errors = result.formatErrors();
+        appendInteger(response, errors.size());
+        for (const auto& error : errors)
+        {
+            appendString(response, error);
+        }
+        appendInteger(response, result.summaryInfo.size());
+        for (const auto& line : result.summaryInfo)
+        {
+            appendString(response, line);
+        }
+        return response;
+    }
+
+    static bool decodeResult(const std::string& response, TestResult& result) {
+        size_t offset = 0;
+        if (response.size() < 3 * sizeof(uint64_t))
+        {
+            return false;
+        }
+        result.success = readInteger(response, offset) != 0;
+        result.failedCount = result.success ? 0 : 1;
+        result.runTime = readInteger(response, offset);
+        for (uint64_t count = readInteger(response, offset); count > 0; count--)
+        {
+            result.errorInfo.push_back(readString(response, offset));
+        }
+        for (uint64_t count = readInteger(response, offset); count > 0; count--)
+        {
+            result.summaryInfo.push_back(readString(response, offset));
+        }
+        return true;
+    }
+
+    static void appendInteger(std::string& out, uint64_t value) { out.append(reinterpret_cast<const char*>(&value), sizeof(value)); }
+
+    static void appendString(std::string& out, const std::string& value) {
+        appendInteger(out, value.size());
+        out += value;
+    }
+
+    static uint64_t readInteger(const std::string& in, size_t& offset) {
+        uint64_t value = 0;
+        if (offset + sizeof(value) <= in.size())
+        {
+            std::memcpy(&value, in.data() + offset, sizeof(value));
+        }
+        offset += sizeof(value);
+        return value;
+    }
+
+    static std::string readString(const std::string& in, size_t& offset) {
+        uint64_t size = readInteger(in, offset);
+        if (offset > in.size() || size > in.size() - offset)
+        {
+            offset = in.size();
+            return "";
+        }
+        std::string value = in.substr(offset, size);
+        offset += size;
+        return value;
+    }
+
+    /// @brief 写入一帧：长度 u64 | 内容。
+    static bool writeFrame(int fd, const std::string& payload) {
+        std::string frame;
+        appendString(frame, payload);
+        size_t written = 0;
+        while (written < frame.size())
+        {
+            ssize_t count = send(fd, frame.data() + written, frame.size() - written, MSG_NOSIGNAL);
+            if (count < 0 && errno == EINTR)
+            {
+                continue;
+            }
+            if (count <= 0)
+            {
+                return false;
+            }
+            written += static_cast<size_t>(count);
+        }
+        return true;
+    }
+
+    static bool readExactly(int fd, char* buffer, size_t size) {
+        size_t received = 0;
+        while (received < size)
+        {
+            ssize_t count = recv(fd, buffer + received, size - received, 0);
+            if (count < 0 && errno == EINTR)
+            {
+                continue;
+            }
+            if (count <= 0)
+            {
+                return false;
+            }
+            received += static_cast<size_t>(count);
+        }
+        return true;
+    }
+
+    static bool readFrame(int fd, std::string& payload) {
+        uint64_t size = 0;
+        if (!readExactly(fd, reinterpret_cast<char*>(&size), sizeof(size)))
+        {
+            return false;
+        }
+        payload.resize(size);
+        return size == 0 || readExactly(fd, &payload[0], size);
+    }
+
+    /// @brief 通过 `SCM_RIGHTS` 发送一个文件描述符，同时携带一个整数。
+    static bool sendDescriptor(int socket, int fd, uint64_t value) {
+        struct iovec data = {&value, sizeof(value)};
+        char control[CMSG_SPACE(sizeof(int))];
+        std::memset(control, 0, sizeof(control));
+        struct msghdr message;
+        std::memset(&message, 0, sizeof(message));
+        message.msg_iov = &data;
+        message.msg_iovlen = 1;
+        message.msg_control = control;
+        message.msg_controllen = sizeof(control);
+        struct cmsghdr* header = CMSG_FIRSTHDR(&message);
+        header->cmsg_level = SOL_SOCKET;
+        header->cmsg_type = SCM_RIGHTS;
+        header->cmsg_len = CMSG_LEN(sizeof(int));
+        std::memcpy(CMSG_DATA(header), &fd, sizeof(int));
+        return sendmsg(socket, &message, MSG_NOSIGNAL) == static_cast<ssize_t>(sizeof(value));
+    }
+
+    static int receiveDescriptor(int socket, uint64_t& value) {
+        struct iovec data = {&value, sizeof(value)};
+        char control[CMSG_SPACE(sizeof(int))];
+        struct msghdr message;
+        std::memset(&message, 0, sizeof(message));
+        message.msg_iov = &data;
+        message.msg_iovlen = 1;
+        message.msg_control = control;
+        message.msg_controllen = sizeof(control);
+        ssize_t count;
+        while ((count = recvmsg(socket, &message, MSG_CMSG_CLOEXEC)) < 0 && errno == EINTR)
+        {
+        }
+        struct cmsghdr* header = CMSG_FIRSTHDR(&message);
+        if (count != static_cast<ssize_t>(sizeof(value)) || header == nullptr || header->cmsg_type != SCM_RIGHTS)
+        {
+            return -1;
+        }
+        int fd;
+        std::memcpy(&fd, CMSG_DATA(header), sizeof(int));
+        return fd;
+    }
+};
+
+#endif
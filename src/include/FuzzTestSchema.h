@@ -1,6 +1,14 @@
 #ifndef FUZZ_TEST_SCHEMA_H
 #define FUZZ_TEST_SCHEMA_H
 #include <TestResult.h>
+#include <DataSource.h>
+#include <Corpus.h>
+#include <Generators.h>
+#include <ForkServer.h>
+#include <Sharding.h>
+#include <ResultCache.h>
+#include <SharedFixture.h>
+#include <BatchExecutor.h>
 
 /**
  * @brief 泛用测试类基类。
@@ -8,6 +16,9 @@
  * 此类为泛用测试类的基类，提供了测试结果管理和子测试类管理的基础功能。
  * 用户不应该直接继承此类，而应当继承从此类派生的子类，以利用其提供的具体测试逻辑。
  *
+ * 子测试类既可以在 `RunTest()` 中临时构造（例如遍历数据的容器类），也可以通过 `AddSubTest()` 预先添加到测试图中，
+ * 由当前测试类持有，再在 `RunTest()` 中以 `RunSubTestClasses()` 执行。后者可以组成任意深度的测试图，见 `TestGroupClass`。
+ *
  * 注意：
  * 直接继承此类可能会导致不正确的测试行为。请确保从具体的子类继承。
  */
@@ -16,12 +27,12 @@ protected:
     /// @brief 当前测试的结果。
     TestResult testResult;
 
-    /// @brief 子测试类的集合。
-    std::vector<GenericTestClass> sublevelTestClasses;
+    /// @brief 由当前测试类持有的子测试类，按添加的顺序排列。
+    std::vector<std::unique_ptr<GenericTestClass>> sublevelTestClasses;
 
 public:
     /// @brief 数据指针，用于存储测试所需的数据。
-    void* dataPtr;
+    void* dataPtr = nullptr;
 
     /// @brief 默认构造函数。
     GenericTestClass() {}
@@ -29,10 +40,102 @@ public:
     /// @brief 析构函数。
     virtual ~GenericTestClass() {}
 
+    GenericTestClass(const GenericTestClass&) = delete;
+    GenericTestClass& operator=(const GenericTestClass&) = delete;
+
     /// @brief 执行测试的纯虚函数。
     /// @param testName 测试的名称。
     /// @return 返回测试结果。
     virtual TestResult ProceedTest(NameType testName) = 0;
+
+    /**
+     * @brief 向测试图中添加一个由当前测试类持有的子测试类。
+     *
+     * @tparam Child 子测试类的类型。
+     * @param args 子测试类的构造参数。
+     * @return 返回新添加的子测试类，可以继续向其添加下一层。
+     */
+    template <typename Child, typename... Args>
+    Child& AddSubTest(Args&&... args) {
+        sublevelTestClasses.push_back(std::make_unique<Child>(std::forward<Args>(args)...));
+        return static_cast<Child&>(*sublevelTestClasses.back());
+    }
+
+    /// @brief 由当前测试类持有的子测试类的数量。
+    size_t SubTestClassCount() const { return sublevelTestClasses.size(); }
+
+protected:
+    /**
+     * @brief 执行所有由当前测试类持有的子测试类，并将结果附加到当前测试结果中。
+     *
+     * 与 `RunSubTests` 相同，并行模式下互不依赖的子树会同时执行；子树内部的子测试也会继续展开到同一个线程池中。
+     *
+     * @param testName 传给每个子测试类的测试名称，即当前测试的完整名称。
+     */
+    void RunSubTestClasses(const NameType& testName) {
+        RunSubTests(sublevelTestClasses.size(), [&](size_t i) { return sublevelTestClasses[i]->ProceedTest(testName); });
+    }
+
+    /**
+     * @brief 调度一批子测试，并将结果附加到当前测试结果中。
+     *
+     * 串行模式下按顺序逐个执行；启用 `TestScheduler::enableParallel` 后，子测试会被分发到
+     * 工作窃取线程池中并行执行，子测试本身也可以继续展开（例如容器子树）。
+     * 无论以何种顺序完成，结果都按 `testIndex` 顺序存放。
+     * 当前容器或整次运行超出 `Watchdog` 的时间预算后，尚未开始的子测试不再执行，只计入 `skippedCount`。
+     * 启用 `Sharding` 时，叶子节点的父节点只调度属于当前分片的叶子，其余叶子计入 `otherShardCount`。
+     *
+     * @param subTestCount 子测试的数量。
+     * @param runOne 形如 `TestResult(size_t index)` 的函数，负责构造并执行第 index 个子测试。
+     *
+     * 注意：
+     * 并行模式下 `runOne` 会在多个线程中同时调用，其中只应读取共享数据。
+     */
+    template <typename RunOne>
+    void RunSubTests(size_t subTestCount, RunOne&& runOne) {
+        if (Sharding::isActive() && this->testResult.isParentOfLeaf)
+        {
+            ShardFilter filter = Sharding::filter(this->testResult.testName);
+            size_t owned = filter.ownedCount(subTestCount);
+            this->testResult.otherShardCount = static_cast<ssize_t>(subTestCount - owned);
+            ScheduleSubTests(owned, runOne, [&filter](size_t k) { return filter.leaf(k); });
+            return;
+        }
+        ScheduleSubTests(subTestCount, runOne, [](size_t k) { return k; });
+    }
+
+    /**
+     * @brief 以批的方式执行所有叶子，并将结果附加到当前测试结果中。
+     *
+     * 与 `RunSubTests` 为每个叶子构造一个执行者不同，这里每批叶子只调用一次 `executor.RunBatch()`、计时一次，
+     * 结果再展开为逐个叶子的记录，报告、进度、分片和时间预算的行为与 `RunSubTests` 相同。
+     * 只适用于叶子节点的父节点，`testResult` 需要事先以叶子的数量构造。
+     *
+     * @param inputs 所有叶子的输入，第 i 个元素对应 `testIndex` 为 i 的叶子。
+     * @param executor 批处理测试执行者。
+     */
+    template <typename Input>
+    void RunSubTestBatches(Span<const Input> inputs, BatchTestExecutorClass<Input>& executor) {
+        runLeafBatches(this->testResult, inputs, executor.BatchSize(),
+                       [&executor](Span<const Input> batch, BatchResult& result) { executor.RunBatch(batch, result); });
+    }
+
+private:
+    /// @brief 调度一批子测试，第 k 个子测试的索引号为 indexOf(k)。
+    template <typename RunOne, typename IndexOf>
+    void ScheduleSubTests(size_t subTestCount, RunOne& runOne, const IndexOf& indexOf) {
+        parallelFor(TestScheduler::pool(), subTestCount, [this, &runOne, &indexOf](size_t k) {
+            size_t index = indexOf(k);
+            if (Watchdog::shouldStop())
+            {
+                this->testResult.skipSubTest();
+                return;
+            }
+            TestResult subTestResult = runOne(index);
+            subTestResult.testIndex = index;
+            this->testResult.appendSubTestResult(std::move(subTestResult));
+        });
+    }
 };
 
 /**
@@ -46,6 +149,10 @@ public:
  */
 class TestDriverClass : public GenericTestClass {
 protected:
+    /// @brief 当前驱动类下所有叶子测试结果的列式存储。
+    /// @details 由驱动类持有，下层的 `TestResult` 只保存其中的视图。
+    std::shared_ptr<ResultStore> resultStore;
+
     /// @brief 设置测试前的状态。
     /// @details 此函数必须在派生类中实现，用于准备测试前的环境。
     virtual void SetUp() = 0;
@@ -64,18 +171,89 @@ public:
     /// @brief 执行测试。
     /// @param testName 测试的名称。
     /// @return 返回测试结果。
-    /// @details 此函数负责调用 `SetUp`、运行 `RunTest` 并调用 `TearDown`，最后返回测试结果。
+    /// @details 此函数负责调用 `SetUp`、运行 `RunTest` 并调用 `TearDown`，最后将结果写入 `ResultReporter` 并返回。
+    /// 执行期间，当前驱动类持有的 `resultStore` 会成为下层所有叶子结果的存放位置。
     TestResult ProceedTest(NameType testName) {
+        TestContext context = TestContext::current();
+        context.resultStore = this->resultStore = std::make_shared<ResultStore>();
+        TestContext::Scope scope(context);
         SetUp();
-        this->testResult.appendSubTestResult(RunTest(testName));
+        START_TIMER;
+        TestResult result;
+        {
+            ForkServer::Session isolation;
+            result = RunTest(testName);
+        }
+        result.runTime = FINISH_TIMER;
         TearDown();
-        return this->testResult;
+        result.reportContainer(result.testName.empty() ? testName : result.testName);
+        return result;
     }
 
     /// @brief 析构函数。
     ~TestDriverClass() override {}
 };
 
+/**
+ * @brief 流式测试驱动类。
+ *
+ * 此类为 `TestDriverClass` 的具体子类，适用于数据集过大、无法在 `SetUp()` 中一次性载入内存的场景。
+ * 用户通过 `OpenSource()` 提供一个按块产出数据的 `ChunkSource`，每一块数据交给 `RunChunk()` 调度一个下层测试。
+ * 数据块由后台线程预取并执行 `PrepareChunk()`：测试第 N 块时第 N+1 块已在准备中，
+ * 每一块在其下层测试结束后立即释放，因此内存占用只与块的大小有关，而与数据集的大小无关。
+ *
+ * 注意：
+ * 此类已经实现了 `SetUp()`、`TearDown()` 和 `RunTest()`，用户只需要实现 `OpenSource()` 和 `RunChunk()`。
+ *
+ * @tparam Chunk 每一块数据的类型。
+ */
+template <typename Chunk>
+class StreamingTestDriverClass : public TestDriverClass {
+protected:
+    /// @brief 打开数据源。
+    /// @return 返回按块产出测试数据的数据源。
+    /// @details 此函数必须在派生类中实现，在 `SetUp()` 中调用。
+    virtual std::unique_ptr<ChunkSource<Chunk>> OpenSource() = 0;
+
+    /// @brief 预处理一块数据。
+    /// @param chunk 待预处理的数据块。
+    /// @details 在后台预取线程中调用，默认不做任何处理。
+    virtual void PrepareChunk(Chunk& chunk) { (void)chunk; }
+
+    /// @brief 对一块数据执行测试。
+    /// @param chunk 当前的数据块，在此函数返回后即被释放。
+    /// @param chunkIndex 数据块的序号。
+    /// @param testName 测试的名称。
+    /// @return 返回这一块数据的测试结果。
+    /// @details 此函数必须在派生类中实现，通常在其中构造一个 `TestContainerClass` 的子类并调用其 `ProceedTest()`。
+    virtual TestResult RunChunk(Chunk& chunk, size_t chunkIndex, NameType testName) = 0;
+
+    void SetUp() override {
+        source.reset(new PrefetchingSource<Chunk>(OpenSource(), [this](Chunk& chunk) { PrepareChunk(chunk); }));
+    }
+
+    void TearDown() override {
+        source.reset();
+    }
+
+    TestResult RunTest(NameType testName) override {
+        size_t chunkIndex = 0;
+        std::unique_ptr<Chunk> chunk = source->next();
+        while (chunk != nullptr)
+        {
+            TestResult result = RunChunk(*chunk, chunkIndex, testName);
+            result.testIndex = chunkIndex++;
+            this->testResult.appendSubTestResult(std::move(result));
+            chunk.reset();
+            chunk = source->next();
+        }
+        return this->testResult;
+    }
+
+private:
+    std::unique_ptr<ChunkSource<Chunk>> source;
+};
+
 /**
  * @brief 测试容器类。
  *
@@ -104,18 +282,33 @@ public:
     /// @return 返回测试结果。
     /// @details 此函数需要在派生类中实现，以执行具体的测试逻辑。
     TestResult ProceedTest(NameType testName) override {
+        Watchdog::Watch watch(WatchKind::CONTAINER, [&] { return "container " + testName; });
+        uint64_t residentStart = AllocationTracker::isEnabled() ? AllocationTracker::residentBytes() : 0;
         START_TIMER;
         if (isParentOfLeaf)
         {
             auto result = RunTest(testName);
             auto time = FINISH_TIMER;
             result.runTime = time;
-            this->testResult.finishSubtestBatch(true);
+            this->testResult.runTime = time;
+            sampleResident(this->testResult, residentStart);
+            if (watch.finish())
+            {
+                this->testResult.recordTimeout(watch);
+                result.success = false;
+            }
+            this->testResult.finishSubtestBatch();
             return result;
         }
         auto result = RunTest(testName);
         auto time = FINISH_TIMER;
         result.runTime = time;
+        sampleResident(result, residentStart);
+        if (watch.finish())
+        {
+            result.recordTimeout(watch);
+        }
+        result.reportContainer(result.testName.empty() ? testName : result.testName);
         return result;
     };
 
@@ -123,6 +316,64 @@ public:
 
     /// @brief 析构函数。
     ~TestContainerClass() override {}
+
+private:
+    /// @brief 启用 `AllocationTracker` 时记录容器开始和结束时的常驻内存。
+    static void sampleResident(TestResult& result, uint64_t residentStart) {
+        if (AllocationTracker::isEnabled())
+        {
+            result.allocations.residentStart = residentStart;
+            result.allocations.residentEnd = AllocationTracker::residentBytes();
+        }
+    }
+};
+
+/**
+ * @brief 测试分组类。
+ *
+ * 测试图中的中间节点：不持有数据，只按添加的顺序执行由 `AddSubTest()` 添加的子测试类，
+ * 子测试类可以是驱动类、容器类、执行者类或另一个分组，因此测试图可以有任意深度。
+ * 并行模式下互不依赖的子树会同时执行。
+ * 作为测试图的根节点时（即上层没有驱动类），分组会像驱动类一样创建叶子结果的存储并启动隔离执行的作用范围。
+ *
+ * 示例：
+ * ```cpp
+ * TestGroupClass root("Graph");
+ * TestGroupClass& regions = root.AddSubTest<TestGroupClass>("Regions");
+ * regions.AddSubTest<RegionDriverClass>(dataset, 0);
+ * regions.AddSubTest<RegionDriverClass>(dataset, 1);
+ * root.AddSubTest<SmokeTestContainerClass>(true, &smokeData);
+ * root.ProceedTest("Suite");
+ * ```
+ */
+class TestGroupClass : public TestContainerClass {
+public:
+    /// @brief 分组的名称，为空时不改变下层的测试名称。
+    NameType name;
+
+    /// @brief 构造函数。
+    /// @param name 分组的名称。
+    /// @param isParentOfLeaf 子测试类是否为执行者类。
+    explicit TestGroupClass(NameType name, bool isParentOfLeaf = false) : TestContainerClass(isParentOfLeaf, nullptr), name(std::move(name)) {}
+
+    TestResult ProceedTest(NameType testName) override {
+        if (TestContext::current().resultStore != nullptr)
+        {
+            return TestContainerClass::ProceedTest(std::move(testName));
+        }
+        TestContext context = TestContext::current();
+        context.resultStore = std::make_shared<ResultStore>();
+        TestContext::Scope scope(context);
+        ForkServer::Session isolation;
+        return TestContainerClass::ProceedTest(std::move(testName));
+    }
+
+    TestResult RunTest(NameType testName) override {
+        NameType fullName = name.empty() ? testName : testName + "." + name;
+        this->testResult = TestResult(sublevelTestClasses.size(), isParentOfLeaf, fullName);
+        RunSubTestClasses(fullName);
+        return this->testResult;
+    }
 };
 
 /**
@@ -153,17 +404,129 @@ public:
     /// @return 返回测试结果。
     /// @details 此函数需要在派生类中实现，以执行具体的测试逻辑。
     TestResult ProceedTest(NameType testName) override {
+        Watchdog::Watch watch(WatchKind::LEAF, [&] { return testName + " test " + std::to_string(this->testIndex); });
+        // 在统计开始之前复制测试名称，它在 RunTest() 中的释放不是统计期间分配的内存块，不计入叶子的统计；
+        // testName 本身保持不变，供看门狗生成描述
+        NameType runName = testName;
+        PerfSample counterStart = PerfCounters::start();
+        AllocationTracker::Snapshot allocationStart = AllocationTracker::start();
         START_TIMER;
-        auto result = RunTest(testName);
+        auto result = RunTest(std::move(runName));
         auto time = FINISH_TIMER;
+        AllocationTracker::finish(allocationStart, result.allocations);
         result.runTime = time;
+        PerfCounters::finish(counterStart, result.counters);
+        if (watch.finish())
+        {
+            result.recordTimeout(watch, DescribeInput());
+        }
         return result;
     };
 
     virtual TestResult RunTest(NameType testName) = 0;
 
+    /// @brief 输入的可读形式，用于超时等错误信息。
+    /// @details 默认为空，即不输出输入；派生类可以按需重写。
+    virtual std::string DescribeInput() { return ""; }
+
     /// @brief 析构函数。
     ~TestExecutorClass() override {}
 };
 
-#endif
\ No newline at end of file
+/**
+ * @brief 隔离执行的测试执行者适配器。
+ *
+ * `dataPtr` 指向 `Input`。fork 服务器正在运行时，输入经 `InputCodec<Input>` 编码后交给一个工作进程，
+ * 由工作进程构造 `Executor` 并执行测试；否则直接在当前进程中执行，行为与 `Executor` 完全相同。
+ * `runTime` 是工作进程中测得的运行时间，不包括进程间通信的开销。
+ *
+ * 示例：
+ * ```cpp
+ * IsolatedExecutorClass<ParserExecutorClass> subClass(&subData, i);
+ * return subClass.ProceedTest(testName + "." + subTestName);
+ * ```
+ *
+ * @tparam Executor 实际的测试执行者，需要能以 `(void* dataPtr, ssize_t testIndex)` 构造。
+ * @tparam Input 输入类型。
+ */
+template <typename Executor, typename Input = std::string>
+class IsolatedExecutorClass : public TestExecutorClass {
+public:
+    using TestExecutorClass::TestExecutorClass;
+
+    TestResult ProceedTest(NameType testName) override {
+        if (!ForkServer::instance().isRunning())
+        {
+            Executor executor(this->dataPtr, this->testIndex);
+            return executor.ProceedTest(std::move(testName));
+        }
+        return RunTest(std::move(testName));
+    }
+
+    TestResult RunTest(NameType testName) override {
+        return ForkServer::instance().execute(&RunInWorker, InputCodec<Input>::encode(*DATA_PTR(Input)), static_cast<size_t>(this->testIndex), testName);
+    }
+
+private:
+    static TestResult RunInWorker(const std::string& bytes, size_t testIndex, const std::string& testName) {
+        Input input = InputCodec<Input>::decode(bytes);
+        Executor executor(&input, static_cast<ssize_t>(testIndex));
+        return executor.ProceedTest(testName);
+    }
+};
+
+/**
+ * @brief 使用结果缓存的测试执行者适配器。
+ *
+ * `dataPtr` 指向 `Input`。启用 `ResultCache` 时，以测试名称（即叶子节点父节点的完整名称）和经 `InputCodec<Input>` 编码的输入
+ * 查询缓存：命中时不执行测试，直接返回一个通过且标记为 `cached` 的叶子结果；未命中时由 `Executor` 执行测试，并将结果记录到缓存。
+ * 未启用缓存时行为与 `Executor` 完全相同。可以与 `IsolatedExecutorClass` 组合使用。
+ *
+ * 示例：
+ * ```cpp
+ * CachedExecutorClass<IsolatedExecutorClass<ParserExecutorClass>> subClass(&subData, i);
+ * return subClass.ProceedTest(testName + "." + subTestName);
+ * ```
+ *
+ * @tparam Executor 实际的测试执行者，需要能以 `(void* dataPtr, ssize_t testIndex)` 构造。
+ * @tparam Input 输入类型。
+ */
+template <typename Executor, typename Input = std::string>
+class CachedExecutorClass : public TestExecutorClass {
+public:
+    using TestExecutorClass::TestExecutorClass;
+
+    TestResult ProceedTest(NameType testName) override {
+        ResultCache& cache = ResultCache::instance();
+        if (!cache.isEnabled())
+        {
+            Executor executor(this->dataPtr, this->testIndex);
+            return executor.ProceedTest(std::move(testName));
+        }
+        uint64_t key = cache.key(testName, InputCodec<Input>::encode(*DATA_PTR(Input)));
+        if (cache.contains(key))
+        {
+            TestResult result;
+            result.isLeaf = true;
+            result.cached = true;
+            result.testIndex = static_cast<u_int32_t>(this->testIndex);
+            return result;
+        }
+        TestResult result = RunTest(std::move(testName));
+        cache.record(key, result.success);
+        return result;
+    }
+
+    TestResult RunTest(NameType testName) override {
+        Executor executor(this->dataPtr, this->testIndex);
+        return executor.ProceedTest(std::move(testName));
+    }
+};
+
+#include <Schema.h>
+#include <TypedTest.h>
+#include <CoverageFuzzer.h>
+#include <Benchmark.h>
+#include <Comparison.h>
+
+#endif
@@ -0,0 +1,469 @@
+#ifndef GENERATORS_H
+#define GENERATORS_H
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include <TaskScheduler.h>
+
+/**
+ * 可复现的输入生成器。
+ *
+ * 每个叶子测试的输入都由一个独立的随机数生成器产生，其种子由驱动类的种子、容器的序号和叶子的 `testIndex`
+ * 通过 `deriveSeed` 计算得到。因此只要记录驱动类的种子，任何一个失败的输入都可以用同样的三个数重新生成，
+ * 而无需保存输入本身；批量生成时各个叶子之间也互不依赖，可以并行填充。
+ *
+ * 生成器约定提供：
+ * - `ValueType`：生成的值的类型。
+ * - `void generate(Xoshiro256& rng, ValueType& out) const`：将生成的值写入 `out`，
+ *   字符串和容器会复用 `out` 已有的容量，因此向预先分配好的缓冲区批量填充时几乎不需要分配内存。
+ */
+
+/**
+ * @brief SplitMix64 混合函数。
+ *
+ * 用于将任意的 64 位状态扩展为质量良好的种子序列，每次调用会推进 `state`。
+ */
+inline uint64_t splitMix64(uint64_t& state) {
+    uint64_t z = (state += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+/**
+ * @brief 计算一个叶子测试的种子。
+ *
+ * @param driverSeed 驱动类的种子。
+ * @param containerIndex 容器在驱动类中的序号。
+ * @param testIndex 叶子在容器中的 `testIndex`。
+ * @return 返回叶子测试的种子，相同的参数总是得到相同的结果。
+ */
+inline uint64_t deriveSeed(uint64_t driverSeed, uint64_t containerIndex, uint64_t testIndex) {
+    uint64_t state = driverSeed;
+    state = splitMix64(state) ^ containerIndex;
+    state = splitMix64(state) ^ testIndex;
+    return splitMix64(state);
+}
+
+/**
+ * @brief xoshiro256** 伪随机数生成器。
+ *
+ * 状态只有 32 字节，每次产生 64 位随机数只需要几次移位和乘法。满足 `UniformRandomBitGenerator` 的要求，
+ * 因此也可以直接配合标准库的分布和算法使用。
+ */
+class Xoshiro256 {
+public:
+    using result_type = uint64_t;
+
+    /// @brief 构造函数。
+    /// @param seed 种子，通过 SplitMix64 扩展为完整的内部状态。
+    explicit Xoshiro256(uint64_t seed = 0) { reseed(seed); }
+
+    /// @brief 重新设置种子。
+    void reseed(uint64_t seed) {
+        for (uint64_t& word : state)
+        {
+            word = splitMix64(seed);
+        }
+    }
+
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+
+    /// @brief 产生下一个 64 位随机数。
+    result_type operator()() { return next(); }
+
+    /// @brief 产生下一个 64 位随机数。
+    uint64_t next() {
+        uint64_t result = rotateLeft(state[1] * 5, 7) * 9;
+        uint64_t shifted = state[1] << 17;
+        state[2] ^= state[0];
+        state[3] ^= state[1];
+        state[1] ^= state[2];
+        state[0] ^= state[3];
+        state[2] ^= shifted;
+        state[3] = rotateLeft(state[3], 45);
+        return result;
+    }
+
+    /// @brief 产生 `[0, bound)` 范围内均匀分布的随机数，`bound` 为 0 时返回任意 64 位随机数。
+    uint64_t nextBelow(uint64_t bound) {
+        if (bound == 0)
+        {
+            return next();
+        }
+        // Lemire 的乘法取模方法，只在极少数情况下需要重新采样
+        __uint128_t product = static_cast<__uint128_t>(next()) * bound;
+        uint64_t low = static_cast<uint64_t>(product);
+        if (low < bound)
+        {
+            uint64_t threshold = (0 - bound) % bound;
+            while (low < threshold)
+            {
+                product = static_cast<__uint128_t>(next()) * bound;
+                low = static_cast<uint64_t>(product);
+            }
+        }
+        return static_cast<uint64_t>(product >> 64);
+    }
+
+    /// @brief 产生 `[0, 1)` 范围内均匀分布的浮点数。
+    double nextDouble() { return static_cast<double>(next() >> 11) * 0x1.0p-53; }
+
+    /// @brief 以 probability 的概率返回 true。
+    bool chance(double probability) { return nextDouble() < probability; }
+
+private:
+    uint64_t state[4];
+
+    static uint64_t rotateLeft(uint64_t value, int shift) { return (value << shift) | (value >> (64 - shift)); }
+};
+
+/**
+ * @brief 用随机字节填充一段内存。
+ *
+ * 每次产生的 64 位随机数一次写入 8 个字节。
+ */
+inline void fillBytes(Xoshiro256& rng, void* buffer, size_t size) {
+    unsigned char* out = static_cast<unsigned char*>(buffer);
+    while (size >= sizeof(uint64_t))
+    {
+        uint64_t word = rng.next();
+        std::memcpy(out, &word, sizeof(word));
+        out += sizeof(word);
+        size -= sizeof(word);
+    }
+    if (size > 0)
+    {
+        uint64_t word = rng.next();
+        std::memcpy(out, &word, size);
+    }
+}
+
+/**
+ * @brief 生成器的公共基类。
+ *
+ * 派生类实现 `generate`，基类在此基础上提供直接返回值的调用方式。
+ */
+template <typename Derived, typename T>
+class Generator {
+public:
+    using ValueType = T;
+
+    /// @brief 生成一个新的值。
+    T operator()(Xoshiro256& rng) const {
+        T value{};
+        static_cast<const Derived*>(this)->generate(rng, value);
+        return value;
+    }
+};
+
+/**
+ * @brief 整数生成器。
+ *
+ * 在 `[min, max]` 范围内均匀生成整数，并以 `edgeProbability` 的概率改为生成边界值：
+ * `min`、`max`、`min + 1`、`max - 1` 以及范围内的 0、1、-1。
+ */
+template <typename T>
+class IntGenerator : public Generator<IntGenerator<T>, T> {
+    static_assert(std::is_integral<T>::value, "IntGenerator requires an integral type");
+
+public:
+    IntGenerator(T min = std::numeric_limits<T>::min(), T max = std::numeric_limits<T>::max(), double edgeProbability = 1.0 / 16)
+        : min(min), max(max), edgeProbability(edgeProbability) {
+        T candidates[] = {min, max, static_cast<T>(min + (min < max)), static_cast<T>(max - (min < max)), T(0), T(1), static_cast<T>(-1)};
+        for (T candidate : candidates)
+        {
+            if (candidate >= min && candidate <= max)
+            {
+                edges.push_back(candidate);
+            }
+        }
+    }
+
+    void generate(Xoshiro256& rng, T& out) const {
+        if (rng.chance(edgeProbability))
+        {
+            out = edges[rng.nextBelow(edges.size())];
+            return;
+        }
+        using Unsigned = std::make_unsigned_t<T>;
+        uint64_t span = static_cast<Unsigned>(static_cast<Unsigned>(max) - static_cast<Unsigned>(min));
+        uint64_t offset = span == std::numeric_limits<uint64_t>::max() ? rng.next() : rng.nextBelow(span + 1);
+        out = static_cast<T>(static_cast<Unsigned>(static_cast<Unsigned>(min) + static_cast<Unsigned>(offset)));
+    }
+
+private:
+    T min;
+    T max;
+    double edgeProbability;
+    std::vector<T> edges;
+};
+
+/**
+ * @brief 浮点数生成器。
+ *
+ * 在 `[min, max)` 范围内均匀生成浮点数，并以 `edgeProbability` 的概率改为生成特殊值：
+ * ±0、±1、最小正规格化数、最小非规格化数、机器精度、最大值、最小值，以及（允许时）±∞ 和 NaN。
+ * 特殊值不受范围限制，这正是它们用于暴露边界问题的意义所在。
+ */
+template <typename T>
+class FloatGenerator : public Generator<FloatGenerator<T>, T> {
+    static_assert(std::is_floating_point<T>::value, "FloatGenerator requires a floating point type");
+
+public:
+    FloatGenerator(T min = T(-1), T max = T(1), double edgeProbability = 1.0 / 16, bool allowNonFinite = true)
+        : min(min), max(max), edgeProbability(edgeProbability) {
+        using Limits = std::numeric_limits<T>;
+        edges = {T(0), -T(0), T(1), T(-1), Limits::min(), Limits::denorm_min(), Limits::epsilon(), Limits::max(), Limits::lowest()};
+        if (allowNonFinite)
+        {
+            edges.push_back(Limits::infinity());
+            edges.push_back(-Limits::infinity());
+            edges.push_back(Limits::quiet_NaN());
+        }
+    }
+
+    void generate(Xoshiro256& rng, T& out) const {
+        if (rng.chance(edgeProbability))
+        {
+            out = edges[rng.nextBelow(edges.size())];
+            return;
+        }
+        // 按插值计算，避免 max - min 在大范围下溢出为无穷大
+        T unit = static_cast<T>(rng.nextDouble());
+        out = min * (T(1) - unit) + max * unit;
+    }
+
+private:
+    T min;
+    T max;
+    double edgeProbability;
+    std::vector<T> edges;
+};
+
+/**
+ * @brief 字节串生成器。
+ *
+ * 生成长度在 `[minLength, maxLength]` 范围内、内容为任意字节的 `std::string`。
+ */
+class BytesGenerator : public Generator<BytesGenerator, std::string> {
+public:
+    BytesGenerator(size_t minLength = 0, size_t maxLength = 64) : minLength(minLength), maxLength(maxLength < minLength ? minLength : maxLength) {}
+
+    void generate(Xoshiro256& rng, std::string& out) const {
+        out.resize(minLength + rng.nextBelow(maxLength - minLength + 1));
+        fillBytes(rng, &out[0], out.size());
+    }
+
+private:
+    size_t minLength;
+    size_t maxLength;
+};
+
+/**
+ * @brief UTF-8 字符串生成器。
+ *
+ * 生成码点数量在 `[minCodePoints, maxCodePoints]` 范围内的合法 UTF-8 字符串（不包含代理区码点）。
+ * 以覆盖各种编码长度：1/2 的码点为 ASCII，1/4 为 2 字节编码，3 字节和 4 字节编码各占 1/8。
+ */
+class Utf8Generator : public Generator<Utf8Generator, std::string> {
+public:
+    Utf8Generator(size_t minCodePoints = 0, size_t maxCodePoints = 32)
+        : minCodePoints(minCodePoints), maxCodePoints(maxCodePoints < minCodePoints ? minCodePoints : maxCodePoints) {}
+
+    void generate(Xoshiro256& rng, std::string& out) const {
+        size_t count = minCodePoints + rng.nextBelow(maxCodePoints - minCodePoints + 1);
+        out.clear();
+        out.reserve(count * 4);
+        for (size_t i = 0; i < count; i++)
+        {
+            appendCodePoint(out, nextCodePoint(rng));
+        }
+    }
+
+private:
+    size_t minCodePoints;
+    size_t maxCodePoints;
+
+    static uint32_t nextCodePoint(Xoshiro256& rng) {
+        uint64_t bits = rng.next();
+        // 低 3 位选择编码长度：0、1 为 2 字节，2 为 3 字节，3 为 4 字节，其余为 ASCII
+        switch (bits & 7)
+        {
+        case 0:
+        case 1:
+            return 0x80 + static_cast<uint32_t>((bits >> 3) % (0x800 - 0x80));
+        case 2:
+        {
+            // 跳过 U+D800 到 U+DFFF 的代理区
+            uint32_t codePoint = 0x800 + static_cast<uint32_t>((bits >> 3) % (0x10000 - 0x800 - 0x800));
+            return codePoint >= 0xD800 ? codePoint + 0x800 : codePoint;
+        }
+        case 3:
+            return 0x10000 + static_cast<uint32_t>((bits >> 3) % (0x110000 - 0x10000));
+        default:
+            return static_cast<uint32_t>((bits >> 3) % 0x80);
+        }
+    }
+
+    static void appendCodePoint(std::string& out, uint32_t codePoint) {
+        if (codePoint < 0x80)
+        {
+            out += static_cast<char>(codePoint);
+        }
+        else if (codePoint < 0x800)
+        {
+            out += static_cast<char>(0xC0 | (codePoint >> 6));
+            out += static_cast<char>(0x80 | (codePoint & 0x3F));
+        }
+        else if (codePoint < 0x10000)
+        {
+            out += static_cast<char>(0xE0 | (codePoint >> 12));
+            out += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+            out += static_cast<char>(0x80 | (codePoint & 0x3F));
+        }
+        else
+        {
+            out += static_cast<char>(0xF0 | (codePoint >> 18));
+            out += static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F));
+            out += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+            out += static_cast<char>(0x80 | (codePoint & 0x3F));
+        }
+    }
+};
+
+/**
+ * @brief 容器生成器。
+ *
+ * 生成长度在 `[minLength, maxLength]` 范围内的 `std::vector`，每个元素由 `element` 生成。
+ * 已有元素会被原地覆盖，因此其内部的缓冲区同样会被复用。
+ */
+template <typename Element>
+class VectorGenerator : public Generator<VectorGenerator<Element>, std::vector<typename Element::ValueType>> {
+public:
+    VectorGenerator(Element element, size_t minLength = 0, size_t maxLength = 16)
+        : element(std::move(element)), minLength(minLength), maxLength(maxLength < minLength ? minLength : maxLength) {}
+
+    void generate(Xoshiro256& rng, std::vector<typename Element::ValueType>& out) const {
+        out.resize(minLength + rng.nextBelow(maxLength - minLength + 1));
+        for (auto& value : out)
+        {
+            element.generate(rng, value);
+        }
+    }
+
+private:
+    Element element;
+    size_t minLength;
+    size_t maxLength;
+};
+
+/**
+ * @brief 变换生成器。
+ *
+ * 先由 `source` 生成一个值，再交给 `function` 转换为最终的值，用于在已有生成器的基础上构造自定义类型。
+ */
+template <typename Source, typename Function>
+class MappedGenerator
+    : public Generator<MappedGenerator<Source, Function>, std::decay_t<std::invoke_result_t<const Function&, const typename Source::ValueType&>>> {
+public:
+    using ValueType = std::decay_t<std::invoke_result_t<const Function&, const typename Source::ValueType&>>;
+
+    MappedGenerator(Source source, Function function) : source(std::move(source)), function(std::move(function)) {}
+
+    void generate(Xoshiro256& rng, ValueType& out) const {
+        typename Source::ValueType value{};
+        source.generate(rng, value);
+        out = function(value);
+    }
+
+private:
+    Source source;
+    Function function;
+};
+
+/// @brief 构造整数生成器。
+template <typename T>
+IntGenerator<T> integers(T min = std::numeric_limits<T>::min(), T max = std::numeric_limits<T>::max()) {
+    return IntGenerator<T>(min, max);
+}
+
+/// @brief 构造浮点数生成器。
+template <typename T>
+FloatGenerator<T> floats(T min = T(-1), T max = T(1)) {
+    return FloatGenerator<T>(min, max);
+}
+
+/// @brief 构造字节串生成器。
+inline BytesGenerator byteStrings(size_t minLength = 0, size_t maxLength = 64) {
+    return BytesGenerator(minLength, maxLength);
+}
+
+/// @brief 构造 UTF-8 字符串生成器。
+inline Utf8Generator utf8Strings(size_t minCodePoints = 0, size_t maxCodePoints = 32) {
+    return Utf8Generator(minCodePoints, maxCodePoints);
+}
+
+/// @brief 构造容器生成器。
+template <typename Element>
+VectorGenerator<Element> vectorsOf(Element element, size_t minLength = 0, size_t maxLength = 16) {
+    return VectorGenerator<Element>(std::move(element), minLength, maxLength);
+}
+
+/// @brief 构造变换生成器。
+template <typename Source, typename Function>
+MappedGenerator<Source, Function> mapped(Source source, Function function) {
+    return MappedGenerator<Source, Function>(std::move(source), std::move(function));
+}
+
+/**
+ * @brief 重新生成一个叶子测试的输入。
+ *
+ * 与 `fillBatch` 为同一位置生成的输入完全相同，用于在测试失败后复现输入。
+ *
+ * @param generator 生成器。
+ * @param driverSeed 驱动类的种子。
+ * @param containerIndex 容器在驱动类中的序号。
+ * @param testIndex 叶子在容器中的 `testIndex`。
+ * @return 返回生成的输入。
+ */
+template <typename G>
+typename G::ValueType regenerate(const G& generator, uint64_t driverSeed, uint64_t containerIndex, uint64_t testIndex) {
+    Xoshiro256 rng(deriveSeed(driverSeed, containerIndex, testIndex));
+    return generator(rng);
+}
+
+/**
+ * @brief 向预先分配好的缓冲区批量生成一个容器的全部输入。
+ *
+ * 第 i 个位置使用 `deriveSeed(driverSeed, containerIndex, firstIndex + i)` 作为种子，
+ * 因此结果与填充顺序无关；启用 `TestScheduler::enableParallel` 时会并行填充。
+ *
+ * @param generator 生成器。
+ * @param driverSeed 驱动类的种子。
+ * @param containerIndex 容器在驱动类中的序号。
+ * @param out 输出缓冲区，已有元素的内存会被复用。
+ * @param count 生成的数量。
+ * @param firstIndex 第一个位置对应的 `testIndex`。
+ */
+template <typename G>
+void fillBatch(const G& generator, uint64_t driverSeed, uint64_t containerIndex, typename G::ValueType* out, size_t count, size_t firstIndex = 0) {
+    parallelFor(TestScheduler::pool(), count, [&](size_t i) {
+        Xoshiro256 rng(deriveSeed(driverSeed, containerIndex, firstIndex + i));
+        generator.generate(rng, out[i]);
+    });
+}
+
+/// @brief 填充整个 `std::vector`，其大小即为生成的数量。
+template <typename G>
+void fillBatch(const G& generator, uint64_t driverSeed, uint64_t containerIndex, std::vector<typename G::ValueType>& out) {
+    fillBatch(generator, driverSeed, containerIndex, out.data(), out.size());
+}
+
+#endif
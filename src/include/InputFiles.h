@@ -0,0 +1,68 @@
+#ifndef INPUT_FILES_H
+#define INPUT_FILES_H
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <string_view>
+
+/**
+ * @brief 计算 FNV-1a 64 位哈希值。
+ *
+ * 结果只取决于内容本身，与平台和进程无关，适合作为文件名或在多个进程之间保持一致的键。
+ */
+inline uint64_t fnv1aHash(std::string_view data, uint64_t hash = 0xcbf29ce484222325ULL) {
+    for (char byte : data)
+    {
+        hash = (hash ^ static_cast<unsigned char>(byte)) * 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+/**
+ * @brief 将单个输入保存为目录中的一个文件。
+ *
+ * 文件名为 prefix 加上输入内容的 FNV-1a 哈希值，因此相同的输入总是保存为同一个文件。
+ * 模糊测试的语料和失败输入、隔离执行时导致崩溃的输入都以这种形式保存。
+ *
+ * @param directory 目录，为空时不保存。
+ * @param prefix 文件名前缀。
+ * @param input 输入内容。
+ * @return 返回文件路径，未保存或写入失败时返回空字符串。
+ */
+inline std::string saveInputFile(const std::string& directory, const std::string& prefix, const std::string& input) {
+    if (directory.empty())
+    {
+        return "";
+    }
+    uint64_t hash = fnv1aHash(input);
+    char name[17];
+    std::snprintf(name, sizeof(name), "%016llx", static_cast<unsigned long long>(hash));
+    std::string path = directory + "/" + prefix + name;
+    std::ofstream file(path, std::ios::binary);
+    file.write(input.data(), static_cast<std::streamsize>(input.size()));
+    return file ? path : "";
+}
+
+/// @brief 将输入转换为可打印的带引号字符串，不可打印的字节写为 `\xNN`。
+inline std::string escapeInput(const std::string& input) {
+    static const char digits[] = "0123456789abcdef";
+    std::string out = "\"";
+    for (char byte : input)
+    {
+        unsigned char value = static_cast<unsigned char>(byte);
+        if (value >= 0x20 && value < 0x7F && value != '"' && value != '\\')
+        {
+            out += byte;
+        }
+        else
+        {
+            out += "\\x";
+            out += digits[value >> 4];
+            out += digits[value & 0xF];
+        }
+    }
+    return out + "\"";
+}
+
+#endif
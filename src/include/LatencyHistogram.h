@@ -0,0 +1,161 @@
+#ifndef LATENCY_HISTOGRAM_H
+#define LATENCY_HISTOGRAM_H
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <vector>
+#include <Macros.h>
+
+/**
+ * @brief 对数分桶的运行时间直方图。
+ *
+ * 与 HdrHistogram 相同，数值按二进制数量级分组，每个数量级再线性划分为 `SUB_BUCKET_COUNT` 个子桶，
+ * 因此任意数值的相对误差不超过 1/`SUB_BUCKET_COUNT`（约 3%），而小于 `SUB_BUCKET_COUNT` 的数值是精确的。
+ * 整个 64 位范围只需要固定的 `BUCKET_COUNT` 个计数，内存占用与记录的数量无关；
+ * 计数在第一次记录时才分配，未记录任何数值的直方图（例如叶子测试的结果）复制时几乎没有开销。
+ *
+ * 数量、总和、最小值和最大值是精确统计的。
+ */
+class LatencyHistogram {
+public:
+    /// @brief 每个数量级的子桶数量的位数。
+    static constexpr unsigned SUB_BUCKET_BITS = 5;
+
+    /// @brief 每个数量级的子桶数量。
+    static constexpr uint64_t SUB_BUCKET_COUNT = uint64_t(1) << SUB_BUCKET_BITS;
+
+    /// @brief 桶的总数。
+    static constexpr size_t BUCKET_COUNT = (64 - SUB_BUCKET_BITS + 1) * SUB_BUCKET_COUNT;
+
+    /// @brief 记录一个数值。
+    void record(uint64_t value) {
+        if (counts.empty())
+        {
+            counts.assign(BUCKET_COUNT, 0);
+        }
+        counts[bucketOf(value)]++;
+        total++;
+        sum += value;
+        minimum = value < minimum ? value : minimum;
+        maximum = value > maximum ? value : maximum;
+    }
+
+    /// @brief 记录 times 个相同的数值。
+    void record(uint64_t value, uint64_t times) {
+        if (times == 0)
+        {
+            return;
+        }
+        if (counts.empty())
+        {
+            counts.assign(BUCKET_COUNT, 0);
+        }
+        counts[bucketOf(value)] += times;
+        total += times;
+        sum += value * times;
+        minimum = value < minimum ? value : minimum;
+        maximum = value > maximum ? value : maximum;
+    }
+
+    /// @brief 合并另一个直方图。
+    void merge(const LatencyHistogram& other) {
+        if (other.total == 0)
+        {
+            return;
+        }
+        if (counts.empty())
+        {
+            counts.assign(BUCKET_COUNT, 0);
+        }
+        for (size_t i = 0; i < BUCKET_COUNT; i++)
+        {
+            counts[i] += other.counts[i];
+        }
+        total += other.total;
+        sum += other.sum;
+        minimum = other.minimum < minimum ? other.minimum : minimum;
+        maximum = other.maximum > maximum ? other.maximum : maximum;
+    }
+
+    /// @brief 记录的数量。
+    uint64_t count() const { return total; }
+
+    /// @brief 最小值，未记录任何数值时为 0。
+    uint64_t min() const { return total == 0 ? 0 : minimum; }
+
+    /// @brief 最大值。
+    uint64_t max() const { return maximum; }
+
+    /// @brief 平均值。
+    uint64_t mean() const { return total == 0 ? 0 : sum / total; }
+
+    /**
+     * @brief 百分位数。
+     *
+     * @param percentile 百分比，例如 99.9。
+     * @return 返回不小于 percentile% 的记录的数值所在桶的中点，不超过最大值。
+     */
+    uint64_t percentile(double percentile) const {
+        if (total == 0)
+        {
+            return 0;
+        }
+        uint64_t rank = static_cast<uint64_t>(percentile / 100.0 * static_cast<double>(total) + 0.5);
+        rank = rank == 0 ? 1 : (rank > total ? total : rank);
+        uint64_t seen = 0;
+        for (size_t i = 0; i < BUCKET_COUNT; i++)
+        {
+            seen += counts[i];
+            if (seen >= rank)
+            {
+                uint64_t value = lowerBound(i) + (bucketWidth(i) - 1) / 2;
+                return value > maximum ? maximum : (value < minimum ? minimum : value);
+            }
+        }
+        return maximum;
+    }
+
+    /// @brief 生成 p50/p90/p99/p99.9/max 的摘要文本。
+    std::string summary() const {
+        return "p50: " + formatTime(percentile(50)) + ", p90: " + formatTime(percentile(90)) + ", p99: " + formatTime(percentile(99)) +
+               ", p99.9: " + formatTime(percentile(99.9)) + ", max: " + formatTime(max());
+    }
+
+private:
+    std::vector<uint64_t> counts;
+    uint64_t total = 0;
+    uint64_t sum = 0;
+    uint64_t minimum = std::numeric_limits<uint64_t>::max();
+    uint64_t maximum = 0;
+
+    static size_t bucketOf(uint64_t value) {
+        if (value < SUB_BUCKET_COUNT)
+        {
+            return static_cast<size_t>(value);
+        }
+        unsigned exponent = 63 - __builtin_clzll(value);
+        uint64_t sub = (value >> (exponent - SUB_BUCKET_BITS)) & (SUB_BUCKET_COUNT - 1);
+        return static_cast<size_t>((exponent - SUB_BUCKET_BITS + 1) * SUB_BUCKET_COUNT + sub);
+    }
+
+    static uint64_t lowerBound(size_t bucket) {
+        if (bucket < SUB_BUCKET_COUNT)
+        {
+            return bucket;
+        }
+        unsigned exponent = static_cast<unsigned>(bucket / SUB_BUCKET_COUNT) + SUB_BUCKET_BITS - 1;
+        uint64_t sub = bucket % SUB_BUCKET_COUNT;
+        return (SUB_BUCKET_COUNT + sub) << (exponent - SUB_BUCKET_BITS);
+    }
+
+    static uint64_t bucketWidth(size_t bucket) {
+        if (bucket < SUB_BUCKET_COUNT)
+        {
+            return 1;
+        }
+        unsigned exponent = static_cast<unsigned>(bucket / SUB_BUCKET_COUNT) + SUB_BUCKET_BITS - 1;
+        return uint64_t(1) << (exponent - SUB_BUCKET_BITS);
+    }
+};
+
+#endif
@@ -1,5 +1,9 @@
 #ifndef MACROS_H
 #define MACROS_H
+#include <chrono>
+#include <cstdint>
+#include <limits>
+#include <string>
 
 /**
  * @brief 宏定义用于安全地转换 this->dataPtr 指针。
@@ -30,52 +34,63 @@
  */
 using NameType = std::string;
 
+#define ABS(lhs, rhs) ((lhs) > (rhs) ? (lhs) - (rhs) : (rhs) - (lhs))
+
 /**
- * @brief 宏定义用于执行子测试并将结果附加到当前测试结果。
- *
- * 此宏用于初始化一个 `ExampleTestExecutorClass` 的实例，并通过该实例执行一个子测试。
- * 执行完成后，子测试的结果会被附加到当前测试的结果集合中。
- *
- * @param subData 用于子测试的数据。
- * @param testName 当前测试的名称。
- * @param subTestName 子测试的名称。
+ * @brief 计时器自身的开销（纳秒）。
  *
- * 示例：
- * 假设有一个 `ExampleTestExecutorClass` 实例 `executor` 和一个测试数据 `data`，
- * 可以使用 `PROCEED_TEST(data, "mainTest", "subTest1")` 来执行名为 "mainTest.subTest1" 的子测试。
+ * 第一次调用时连续读取若干次稳定时钟，取相邻两次读取之差的最小值作为开销，此后每次计时结果都会减去该值。
  */
-#define PROCEED_TEST(subData, testName, subTestName){                       \
-    ExampleTestExecutorClass subClass(&subData);                            \
-    TestResult result = subClass.ProceedTest(testName + "." + subTestName); \
-    this->testResult.appendSubTestResult(result);                           \
+inline uint64_t timerOverhead() {
+    static const uint64_t overhead = [] {
+        uint64_t best = std::numeric_limits<uint64_t>::max();
+        for (int i = 0; i < 1000; i++)
+        {
+            auto first = std::chrono::steady_clock::now();
+            auto second = std::chrono::steady_clock::now();
+            uint64_t elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(second - first).count();
+            best = elapsed < best ? elapsed : best;
+        }
+        return best;
+    }();
+    return overhead;
 }
 
-#define ABS(lhs, rhs) lhs > rhs ? lhs - rhs : rhs - lhs
+/// @brief 从 start 到现在经过的纳秒数，已扣除计时器自身的开销。
+inline uint64_t elapsedNanoseconds(std::chrono::steady_clock::time_point start) {
+    uint64_t elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+    uint64_t overhead = timerOverhead();
+    return elapsed > overhead ? elapsed - overhead : 0;
+}
 
-#define START_TIMER auto start = std::chrono::high_resolution_clock::now();
+#define START_TIMER timerOverhead(); auto start = std::chrono::steady_clock::now();
 
-#define FINISH_TIMER std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::high_resolution_clock::now() - start).count()
+#define FINISH_TIMER elapsedNanoseconds(start)
 
 // 定义转换阈值
-#define MIN_THRESHOLD 300000000  // 5 minutes in microseconds
-#define SEC_THRESHOLD 5000000    // 5 seconds in microseconds
-#define MS_THRESHOLD 5000        // 5 milliseconds in microseconds
+#define MIN_THRESHOLD 300000000000ULL  // 5 minutes in nanoseconds
+#define SEC_THRESHOLD 5000000000ULL    // 5 seconds in nanoseconds
+#define MS_THRESHOLD 5000000ULL        // 5 milliseconds in nanoseconds
+#define US_THRESHOLD 5000ULL           // 5 microseconds in nanoseconds
 
 // 定义转换公式
-#define CONVERT_MIN(time) ((float)time / 1000000.0f / 60.0f)  // Convert μs to minutes
-#define CONVERT_SEC(time) ((float)time / 1000000.0f)          // Convert μs to seconds
-#define CONVERT_MS(time) ((float)time / 1000.0f)              // Convert μs to milliseconds
+#define CONVERT_MIN(time) ((float)time / 1000000000.0f / 60.0f)  // Convert ns to minutes
+#define CONVERT_SEC(time) ((float)time / 1000000000.0f)          // Convert ns to seconds
+#define CONVERT_MS(time) ((float)time / 1000000.0f)              // Convert ns to milliseconds
+#define CONVERT_US(time) ((float)time / 1000.0f)                 // Convert ns to microseconds
 
 
-std::string formatTime(uint64_t microseconds) {
-    if (microseconds >= MIN_THRESHOLD) {
-        return std::to_string(CONVERT_MIN(microseconds)) + " min";
-    } else if (microseconds >= SEC_THRESHOLD) {
-        return std::to_string(CONVERT_SEC(microseconds)) + " s";
-    } else if (microseconds >= MS_THRESHOLD) {
-        return std::to_string(CONVERT_MS(microseconds)) + " ms";
+inline std::string formatTime(uint64_t nanoseconds) {
+    if (nanoseconds >= MIN_THRESHOLD) {
+        return std::to_string(CONVERT_MIN(nanoseconds)) + " min";
+    } else if (nanoseconds >= SEC_THRESHOLD) {
+        return std::to_string(CONVERT_SEC(nanoseconds)) + " s";
+    } else if (nanoseconds >= MS_THRESHOLD) {
+        return std::to_string(CONVERT_MS(nanoseconds)) + " ms";
+    } else if (nanoseconds >= US_THRESHOLD) {
+        return std::to_string(CONVERT_US(nanoseconds)) + " μs";
     } else {
-        return std::to_string(microseconds) + " μs";
+        return std::to_string(nanoseconds) + " ns";
     }
 }
 #endif
\ No newline at end of file
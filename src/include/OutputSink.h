@@ -0,0 +1,308 @@
+#ifndef OUTPUT_SINK_H
+#define OUTPUT_SINK_H
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fcntl.h>
+#include <mutex>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <unistd.h>
+#include <vector>
+
+/**
+ * @brief 控制台输出锁。
+ *
+ * 多个测试并行执行时，需要持有此锁才能向控制台输出完整的一段内容，避免不同测试的输出互相穿插。
+ * 通常通过 `OutputSink::Block` 持有此锁。
+ */
+inline std::mutex& outputMutex() {
+    static std::mutex mutex;
+    return mutex;
+}
+
+/**
+ * @brief 带缓冲的、线程安全的控制台输出。
+ *
+ * 框架的所有控制台输出（测试汇总、进度显示、看门狗提示等）都经过此类：
+ * 每个线程先把内容追加到自己的缓冲区中，不需要加锁；缓冲区以一整行或一整段为单位，通过一次 `write()` 系统调用写出。
+ * - 在 `Block` 之外，缓冲区在内容以换行符结尾时写出；
+ * - 在 `Block` 之内，缓冲区在 `Block` 结束时一次写出，因此一次测试汇总通常只需要一次系统调用。
+ *
+ * 输出目标可以是标准输出（默认）、文件，或只保留最后若干字节的内存环形缓冲区（适用于内存或磁盘受限、只关心最后输出的场景）。
+ * 设置了环境变量 `NO_COLOR` 或输出目标不是终端时，`getStyledText()` 等函数不再生成颜色和样式的转义序列。
+ *
+ * 注意：
+ * 切换输出目标和颜色设置必须在开始执行测试之前进行。
+ * 直接写入 `std::cout` 或 `printf` 的内容与此类的输出之间没有顺序保证，只是写入标准输出前会先刷新 `stdout`。
+ *
+ * 示例：
+ * ```cpp
+ * OutputSink::instance().toRingBuffer(64 * 1024);
+ * rootClass.ProceedTest("ShowCase");
+ * std::string tail = OutputSink::instance().ringBufferContents();
+ * ```
+ */
+class OutputSink {
+public:
+    /// @brief 缓冲区超过此大小时，即使在 `Block` 之内也会立即写出。
+    static constexpr size_t FLUSH_THRESHOLD = 64 * 1024;
+
+    /**
+     * @brief 一段不可分割的输出。
+     *
+     * 构造时持有 `outputMutex()`，其间写入的内容在析构时一次写出。
+     * 同一线程中不能嵌套：`outputMutex()` 不可重入，嵌套的 `Block` 在加锁之前抛出 `std::logic_error`，而不是死锁。
+     */
+    class Block {
+    public:
+        Block() {
+            ThreadBuffer& buffer = threadBuffer();
+            if (buffer.inBlock)
+            {
+                throw std::logic_error("OutputSink::Block: blocks cannot be nested on the same thread");
+            }
+            guard = std::unique_lock<std::mutex>(outputMutex());
+            buffer.inBlock = true;
+        }
+
+        ~Block() {
+            ThreadBuffer& buffer = threadBuffer();
+            buffer.inBlock = false;
+            OutputSink::instance().commit(buffer.text);
+        }
+
+        Block(const Block&) = delete;
+        Block& operator=(const Block&) = delete;
+
+    private:
+        std::unique_lock<std::mutex> guard;
+    };
+
+    /// @brief 全局唯一的输出。
+    static OutputSink& instance() {
+        static OutputSink sink;
+        return sink;
+    }
+
+    /// @brief 追加一段输出。此方法是线程安全的。
+    void write(std::string_view text) {
+        ThreadBuffer& buffer = threadBuffer();
+        buffer.text.append(text.data(), text.size());
+        if (buffer.text.size() >= FLUSH_THRESHOLD || (!buffer.inBlock && !buffer.text.empty() && buffer.text.back() == '\n'))
+        {
+            commit(buffer.text);
+        }
+    }
+
+    /// @brief 立即写出当前线程缓冲区中的内容。此方法是线程安全的。
+    void flush() { commit(threadBuffer().text); }
+
+    /// @brief 输出到标准输出（默认）。
+    void toStdout() {
+        retarget(Target::STDOUT, STDOUT_FILENO);
+    }
+
+    /**
+     * @brief 输出到文件。
+     *
+     * 文件无法创建时抛出 `std::runtime_error`。
+     *
+     * @param path 文件路径，已有的内容会被清空。
+     */
+    void toFile(const std::string& path) {
+        int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        if (fd < 0)
+        {
+            throw std::runtime_error("OutputSink: cannot create " + path);
+        }
+        retarget(Target::FILE, fd);
+    }
+
+    /**
+     * @brief 输出到内存中的环形缓冲区，只保留最后 capacity 字节。
+     *
+     * @param capacity 保留的字节数，必须大于 0。
+     */
+    void toRingBuffer(size_t capacity) {
+        std::lock_guard<std::mutex> guard(writeLock);
+        closeFile();
+        target = Target::RING_BUFFER;
+        fd = -1;
+        ring.assign(capacity != 0 ? capacity : 1, '\0');
+        ringHead = 0;
+        ringWrapped = false;
+        terminal = false;
+        colorOutput = false;
+    }
+
+    /// @brief 环形缓冲区中保留的内容，按写入的先后顺序排列。
+    std::string ringBufferContents() {
+        std::lock_guard<std::mutex> guard(writeLock);
+        if (!ringWrapped)
+        {
+            return std::string(ring.data(), ringHead);
+        }
+        std::string contents(ring.data() + ringHead, ring.size() - ringHead);
+        contents.append(ring.data(), ringHead);
+        return contents;
+    }
+
+    /// @brief 输出目标是否为终端，非终端时进度显示改为定期打印纯文本摘要。
+    bool isTerminal() const { return terminal; }
+
+    /// @brief 是否输出颜色和样式的转义序列。
+    bool colorEnabled() const { return colorOutput; }
+
+    /// @brief 强制启用或禁用颜色和样式的转义序列。
+    void setColorEnabled(bool enabled) { colorOutput = enabled; }
+
+    /// @brief 已经写出的字节数。
+    uint64_t bytesWritten() {
+        std::lock_guard<std::mutex> guard(writeLock);
+        return writtenBytes;
+    }
+
+    /**
+     * @brief fork 之后在子进程中重新构造写入锁。
+     *
+     * 子进程中只有调用 fork 的线程，fork 时其他线程可能正持有写入锁。
+     */
+    void abandonAfterFork() {
+        new (&writeLock) std::mutex();
+    }
+
+    ~OutputSink() { closeFile(); }
+
+    OutputSink(const OutputSink&) = delete;
+    OutputSink& operator=(const OutputSink&) = delete;
+
+private:
+    enum class Target { STDOUT, FILE, RING_BUFFER };
+
+    /// @brief 线程的输出缓冲区，线程结束时写出剩余的内容。
+    struct ThreadBuffer {
+        std::string text;
+
+        /// @brief 当前线程是否处于 `Block` 之中。
+        bool inBlock = false;
+
+        ~ThreadBuffer() {
+            if (!text.empty())
+            {
+                OutputSink::instance().commit(text);
+            }
+        }
+    };
+
+    static ThreadBuffer& threadBuffer() {
+        thread_local ThreadBuffer buffer;
+        return buffer;
+    }
+
+    OutputSink() : terminal(isatty(STDOUT_FILENO)) {
+        colorOutput = terminal && !noColorRequested();
+    }
+
+    static bool noColorRequested() {
+        const char* value = std::getenv("NO_COLOR");
+        return value != nullptr && value[0] != '\0';
+    }
+
+    void retarget(Target newTarget, int newFd) {
+        std::lock_guard<std::mutex> guard(writeLock);
+        closeFile();
+        target = newTarget;
+        fd = newFd;
+        ring.clear();
+        terminal = isatty(newFd);
+        colorOutput = terminal && !noColorRequested();
+    }
+
+    void closeFile() {
+        if (target == Target::FILE && fd >= 0)
+        {
+            ::close(fd);
+        }
+    }
+
+    /// @brief 写出并清空 text。
+    void commit(std::string& text) {
+        if (text.empty())
+        {
+            return;
+        }
+        std::lock_guard<std::mutex> guard(writeLock);
+        writtenBytes += text.size();
+        if (target == Target::RING_BUFFER)
+        {
+            appendToRing(text);
+        }
+        else
+        {
+            if (target == Target::STDOUT)
+            {
+                std::fflush(stdout);
+            }
+            writeAll(text);
+        }
+        text.clear();
+    }
+
+    void writeAll(const std::string& text) {
+        size_t offset = 0;
+        while (offset < text.size())
+        {
+            ssize_t count = ::write(fd, text.data() + offset, text.size() - offset);
+            if (count < 0 && errno == EINTR)
+            {
+                continue;
+            }
+            if (count <= 0)
+            {
+                return;
+            }
+            offset += static_cast<size_t>(count);
+        }
+    }
+
+    void appendToRing(const std::string& text) {
+        const char* data = text.data();
+        size_t size = text.size();
+        if (size >= ring.size())
+        {
+            data += size - ring.size();
+            size = ring.size();
+        }
+        while (size > 0)
+        {
+            size_t chunk = std::min(size, ring.size() - ringHead);
+            std::copy(data, data + chunk, ring.begin() + static_cast<std::ptrdiff_t>(ringHead));
+            data += chunk;
+            size -= chunk;
+            ringHead += chunk;
+            if (ringHead == ring.size())
+            {
+                ringHead = 0;
+                ringWrapped = true;
+            }
+        }
+    }
+
+    std::mutex writeLock;
+    Target target = Target::STDOUT;
+    int fd = STDOUT_FILENO;
+    bool terminal;
+    bool colorOutput;
+    uint64_t writtenBytes = 0;
+
+    std::vector<char> ring;
+    size_t ringHead = 0;
+    bool ringWrapped = false;
+};
+
+#endif
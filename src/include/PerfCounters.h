@@ -0,0 +1,346 @@
+#ifndef PERF_COUNTERS_H
+#define PERF_COUNTERS_H
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <time.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#endif
+#include <Macros.h>
+
+/**
+ * @brief 性能计数器的种类。
+ */
+enum class PerfCounter : unsigned {
+    CYCLES,             // CPU 周期数（硬件）
+    INSTRUCTIONS,       // 执行的指令数（硬件）
+    CACHE_MISSES,       // 末级缓存未命中次数（硬件）
+    BRANCH_MISSES,      // 分支预测失败次数（硬件）
+    TASK_CLOCK,         // 线程占用 CPU 的时间，纳秒（软件）
+    PAGE_FAULTS,        // 缺页次数（软件）
+    CONTEXT_SWITCHES,   // 上下文切换次数（软件）
+    COUNT
+};
+
+/**
+ * @brief 一组性能计数器的数值。
+ *
+ * 只有 `available` 中对应位被置位的计数器是有效的：硬件性能计数器不可用时（例如在虚拟机或容器中），只有软件计数器有效。
+ */
+struct PerfCounterSet {
+    static constexpr size_t COUNTER_COUNT = static_cast<size_t>(PerfCounter::COUNT);
+
+    std::array<uint64_t, COUNTER_COUNT> values{};
+
+    /// @brief 有效计数器的位掩码，第 i 位对应 `PerfCounter` 的第 i 项。
+    uint32_t available = 0;
+
+    /// @brief 是否没有任何有效的计数器。
+    bool empty() const { return available == 0; }
+
+    /// @brief 计数器是否有效。
+    bool has(PerfCounter counter) const { return (available >> static_cast<unsigned>(counter)) & 1; }
+
+    uint64_t operator[](PerfCounter counter) const { return values[static_cast<size_t>(counter)]; }
+
+    void set(PerfCounter counter, uint64_t value) {
+        values[static_cast<size_t>(counter)] = value;
+        available |= uint32_t(1) << static_cast<unsigned>(counter);
+    }
+
+    /// @brief 累加另一组计数器，有效的计数器取两者的并集。
+    PerfCounterSet& operator+=(const PerfCounterSet& other) {
+        for (size_t i = 0; i < COUNTER_COUNT; i++)
+        {
+            values[i] += other.values[i];
+        }
+        available |= other.available;
+        return *this;
+    }
+
+    /// @brief 计数器的名称。
+    static const char* name(PerfCounter counter) {
+        static const char* names[] = {"cycles", "instructions", "cache misses", "branch misses", "task clock", "page faults", "context switches"};
+        return names[static_cast<size_t>(counter)];
+    }
+
+    /// @brief 生成一行摘要文本，只包括有效的计数器。
+    std::string summary() const {
+        std::string text;
+        for (size_t i = 0; i < COUNTER_COUNT; i++)
+        {
+            PerfCounter counter = static_cast<PerfCounter>(i);
+            if (!has(counter))
+            {
+                continue;
+            }
+            text += text.empty() ? "" : ", ";
+            text += std::string(name(counter)) + " " + (counter == PerfCounter::TASK_CLOCK ? formatTime(values[i]) : formatCount(values[i]));
+            if (counter == PerfCounter::INSTRUCTIONS && has(PerfCounter::CYCLES) && (*this)[PerfCounter::CYCLES] != 0)
+            {
+                char ipc[32];
+                std::snprintf(ipc, sizeof(ipc), " (IPC %.2f)", static_cast<double>(values[i]) / static_cast<double>((*this)[PerfCounter::CYCLES]));
+                text += ipc;
+            }
+        }
+        return text;
+    }
+
+private:
+    static std::string formatCount(uint64_t count) {
+        static const char* prefixes[] = {"", " K", " M", " G", " T"};
+        double value = static_cast<double>(count);
+        size_t prefix = 0;
+        while (value >= 1000 && prefix + 1 < sizeof(prefixes) / sizeof(prefixes[0]))
+        {
+            value /= 1000;
+            prefix++;
+        }
+        char buffer[32];
+        std::snprintf(buffer, sizeof(buffer), prefix == 0 ? "%.0f" : "%.2f", value);
+        return buffer + std::string(prefixes[prefix]);
+    }
+};
+
+/**
+ * @brief 一次采样的结果。
+ *
+ * 除计数器数值外还记录事件组自打开以来被启用和实际在 PMU 上运行的时间：硬件计数器不足、事件组被内核轮流调度（multiplexing）时，
+ * 运行时间会小于启用时间，两次采样之间的计数器差值只覆盖了其中一部分时间，需要按比例换算。
+ */
+struct PerfSample {
+    PerfCounterSet values;
+
+    /// @brief 事件组被启用的累计时间，纳秒。
+    uint64_t timeEnabled = 0;
+
+    /// @brief 事件组实际运行的累计时间，纳秒。
+    uint64_t timeRunning = 0;
+
+    /// @brief 由事件组读出的计数器的位掩码，只有这些计数器受轮流调度的影响。
+    uint32_t grouped = 0;
+
+    /// @brief 是否没有任何有效的计数器。
+    bool empty() const { return values.empty(); }
+};
+
+/**
+ * @brief 单个线程的性能计数器组。
+ *
+ * 每个线程第一次采样时通过 `perf_event_open` 打开一个只统计本线程的事件组（硬件计数器只统计用户态）：
+ * 优先以 CPU 周期为组长，加入指令数、缓存未命中和分支预测失败，再加入软件计数器；
+ * 硬件性能计数器不可用时改为以 task-clock 为组长的纯软件事件组。
+ * 同一组内的事件总是同时被调度，一次 `read()` 就能读出全部计数器，因此每次采样只需要一次系统调用。
+ * 读取时同时取得事件组的启用时间和运行时间，用于识别和换算被轮流调度的区间。
+ *
+ * 没有通过 perf 打开的软件计数器（`perf_event_open` 被 seccomp 禁止，或者 `perf_event_paranoid` 不允许统计内核态的缺页和上下文切换）
+ * 改用 `CLOCK_THREAD_CPUTIME_ID` 和 `getrusage(RUSAGE_THREAD)` 读取。
+ */
+class PerfEventGroup {
+public:
+    PerfEventGroup() { open(); }
+
+    ~PerfEventGroup() {
+        for (int fd : fds)
+        {
+            ::close(fd);
+        }
+    }
+
+    PerfEventGroup(const PerfEventGroup&) = delete;
+    PerfEventGroup& operator=(const PerfEventGroup&) = delete;
+
+    /// @brief 读取当前的计数器数值（自打开以来的累计值）。
+    PerfSample read() const {
+        PerfSample sample;
+#if defined(__linux__)
+        if (!fds.empty())
+        {
+            // PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING：
+            // { nr, time_enabled, time_running, values[nr] }
+            uint64_t buffer[3 + PerfCounterSet::COUNTER_COUNT];
+            ssize_t size = ::read(fds.front(), buffer, sizeof(buffer));
+            if (size >= static_cast<ssize_t>(3 * sizeof(uint64_t)) && buffer[0] == counters.size()
+                && static_cast<size_t>(size) >= (3 + counters.size()) * sizeof(uint64_t))
+            {
+                sample.timeEnabled = buffer[1];
+                sample.timeRunning = buffer[2];
+                for (size_t i = 0; i < counters.size(); i++)
+                {
+                    sample.values.set(counters[i], buffer[3 + i]);
+                }
+                sample.grouped = sample.values.available;
+            }
+        }
+#endif
+        PerfCounterSet& values = sample.values;
+        if (!values.has(PerfCounter::TASK_CLOCK))
+        {
+            struct timespec clock;
+            if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &clock) == 0)
+            {
+                values.set(PerfCounter::TASK_CLOCK, static_cast<uint64_t>(clock.tv_sec) * 1000000000ULL + static_cast<uint64_t>(clock.tv_nsec));
+            }
+        }
+#if defined(RUSAGE_THREAD)
+        if (!values.has(PerfCounter::PAGE_FAULTS) || !values.has(PerfCounter::CONTEXT_SWITCHES))
+        {
+            struct rusage usage;
+            if (getrusage(RUSAGE_THREAD, &usage) == 0)
+            {
+                values.set(PerfCounter::PAGE_FAULTS, static_cast<uint64_t>(usage.ru_minflt + usage.ru_majflt));
+                values.set(PerfCounter::CONTEXT_SWITCHES, static_cast<uint64_t>(usage.ru_nvcsw + usage.ru_nivcsw));
+            }
+        }
+#endif
+        return sample;
+    }
+
+    /// @brief 是否使用了硬件性能计数器。
+    bool hasHardwareCounters() const { return !counters.empty() && counters.front() == PerfCounter::CYCLES; }
+
+private:
+    std::vector<int> fds;
+    std::vector<PerfCounter> counters;
+
+    void open() {
+#if defined(__linux__)
+        if (add(PerfCounter::CYCLES, PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES))
+        {
+            add(PerfCounter::INSTRUCTIONS, PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS);
+            add(PerfCounter::CACHE_MISSES, PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES);
+            add(PerfCounter::BRANCH_MISSES, PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES);
+        }
+        add(PerfCounter::TASK_CLOCK, PERF_TYPE_SOFTWARE, PERF_COUNT_SW_TASK_CLOCK);
+        // 缺页和上下文切换发生在内核中，只能在允许统计内核态时通过 perf 计数
+        if (add(PerfCounter::PAGE_FAULTS, PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS, false))
+        {
+            add(PerfCounter::CONTEXT_SWITCHES, PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CONTEXT_SWITCHES, false);
+        }
+        if (!fds.empty())
+        {
+            ioctl(fds.front(), PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+        }
+#endif
+    }
+
+#if defined(__linux__)
+    /// @brief 向事件组中加入一个事件，第一个成功打开的事件成为组长。
+    bool add(PerfCounter counter, uint32_t type, uint64_t config, bool excludeKernel = true) {
+        struct perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = type;
+        attr.config = config;
+        attr.disabled = fds.empty() ? 1 : 0;
+        attr.exclude_kernel = excludeKernel ? 1 : 0;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        int groupFd = fds.empty() ? -1 : fds.front();
+        long fd = syscall(SYS_perf_event_open, &attr, 0, -1, groupFd, PERF_FLAG_FD_CLOEXEC);
+        if (fd < 0)
+        {
+            return false;
+        }
+        fds.push_back(static_cast<int>(fd));
+        counters.push_back(counter);
+        return true;
+    }
+#endif
+};
+
+/**
+ * @brief 叶子测试的性能计数器。
+ *
+ * 默认关闭；调用 `enable()` 后，`TestExecutorClass::ProceedTest()` 在运行测试前后各采样一次本线程的计数器，
+ * 两次之差写入叶子结果的 `counters`，并随结果逐层向上累加，叶子节点的父节点在汇总中输出累加值。
+ * 事件组在两次采样之间被轮流调度时，差值按启用时间与运行时间之比换算；期间完全没有运行时丢弃事件组中的计数器。
+ * 每个工作线程的事件组只在第一次采样时打开一次。关闭时每个叶子的额外开销只有一次原子读取。
+ *
+ * 示例：
+ * ```cpp
+ * PerfCounters::enable();
+ * rootClass.ProceedTest("ShowCase");
+ * ```
+ */
+class PerfCounters {
+public:
+    /// @brief 启用或关闭性能计数器。
+    static void enable(bool enabled = true) { enabledFlag().store(enabled, std::memory_order_relaxed); }
+
+    /// @brief 是否启用了性能计数器。
+    static bool isEnabled() { return enabledFlag().load(std::memory_order_relaxed); }
+
+    /// @brief 读取本线程的计数器，未启用时返回空的计数器组。
+    static PerfSample start() {
+        if (!isEnabled())
+        {
+            return PerfSample();
+        }
+        return group().read();
+    }
+
+    /**
+     * @brief 再次读取本线程的计数器，将与 `start()` 的结果之差写入 counters。
+     *
+     * 由事件组读出的计数器在两次采样之间没有一直运行时，差值乘以启用时间与运行时间之比；运行时间为零时不写入这些计数器。
+     *
+     * @param begin `start()` 的返回值，为空时不做任何处理。
+     * @param counters 写入的目标。
+     */
+    static void finish(const PerfSample& begin, PerfCounterSet& counters) {
+        if (begin.empty())
+        {
+            return;
+        }
+        PerfSample end = group().read();
+        uint64_t enabled = end.timeEnabled >= begin.timeEnabled ? end.timeEnabled - begin.timeEnabled : 0;
+        uint64_t running = end.timeRunning >= begin.timeRunning ? end.timeRunning - begin.timeRunning : 0;
+        counters = PerfCounterSet();
+        for (size_t i = 0; i < PerfCounterSet::COUNTER_COUNT; i++)
+        {
+            PerfCounter counter = static_cast<PerfCounter>(i);
+            uint32_t bit = uint32_t(1) << i;
+            // 两次采样的来源（事件组或替代的系统调用）不同时差值没有意义
+            if (!begin.values.has(counter) || !end.values.has(counter) || (begin.grouped & bit) != (end.grouped & bit))
+            {
+                continue;
+            }
+            uint64_t delta = end.values[counter] >= begin.values[counter] ? end.values[counter] - begin.values[counter] : 0;
+            if ((end.grouped & bit) && running < enabled)
+            {
+                if (running == 0)
+                {
+                    continue;
+                }
+                delta = static_cast<uint64_t>(static_cast<double>(delta) * static_cast<double>(enabled) / static_cast<double>(running));
+            }
+            counters.set(counter, delta);
+        }
+    }
+
+    /// @brief 本线程是否能够使用硬件性能计数器。
+    static bool hasHardwareCounters() { return group().hasHardwareCounters(); }
+
+private:
+    static std::atomic<bool>& enabledFlag() {
+        static std::atomic<bool> enabled{false};
+        return enabled;
+    }
+
+    static PerfEventGroup& group() {
+        thread_local PerfEventGroup events;
+        return events;
+    }
+};
+
+#endif
@@ -0,0 +1,345 @@
+#ifndef PROGRESS_RENDERER_H
+#define PROGRESS_RENDERER_H
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+#include <StyledPrint.h>
+#include <ResultStore.h>
+
+/**
+ * @brief 单个叶子节点父节点的进度计数。
+ *
+ * 测试执行的热路径上只需要对 `completed` 和 `failed` 做一次原子自增，绘制工作全部由 `ProgressRenderer` 的后台线程完成。
+ */
+struct ProgressCounter {
+    /// @brief 测试名称。
+    std::string testName;
+
+    /// @brief 子测试总数。
+    size_t total = 0;
+
+    /// @brief 已完成的子测试数量。
+    std::atomic<size_t> completed{0};
+
+    /// @brief 失败的子测试数量。
+    std::atomic<size_t> failed{0};
+
+    /// @brief 叶子记录视图，用于绘制逐个子测试的状态。
+    LeafRange leaves;
+};
+
+/**
+ * @brief 限速的异步进度渲染器。
+ *
+ * 后台线程以固定帧率对所有正在执行的叶子节点父节点进行采样并重绘进度区域，绘制开销与子测试完成的频率无关。
+ * - 终端输出时，子测试数量不超过 `GLYPH_LIMIT` 的测试显示逐个子测试的 `[√]`/`[X]` 符号，
+ *   更大的测试显示固定宽度的分段进度条，每一段按其中子测试的通过或失败情况着色。
+ * - 输出不是终端时（例如重定向到文件），不再重绘，而是每隔 `summaryInterval` 打印一行纯文本进度摘要。
+ *
+ * 注意：
+ * 向控制台输出永久内容（例如测试结束时的汇总）之前，需要在 `OutputSink::Block` 中调用 `clearLiveArea()`，
+ * 渲染器会在下一帧重新绘制仍在进行中的测试。
+ */
+class ProgressRenderer {
+public:
+    /// @brief 子测试数量不超过此值时逐个绘制子测试符号，否则绘制进度条。
+    static constexpr size_t GLYPH_LIMIT = 64;
+
+    /// @brief 进度条的宽度（段数）。
+    static constexpr size_t BAR_WIDTH = 40;
+
+    /// @brief 同时绘制的最大测试数量，超出部分合并为一行。
+    static constexpr size_t MAX_LIVE_LINES = 8;
+
+    /// @brief 全局唯一的渲染器。
+    static ProgressRenderer& instance() {
+        static ProgressRenderer renderer;
+        return renderer;
+    }
+
+    ~ProgressRenderer() {
+        {
+            std::lock_guard<std::mutex> guard(stateLock);
+            stopping = true;
+        }
+        wakeUp.notify_all();
+        if (worker.joinable())
+        {
+            worker.join();
+        }
+    }
+
+    /**
+     * @brief 在 fork 出的子进程中丢弃渲染线程和正在跟踪的测试。
+     *
+     * 子进程中没有渲染线程，父进程中被其他线程持有的锁也不会被释放，因此重新构造锁和线程句柄，
+     * 并标记为已停止，此后子进程中的 `track` 不会再启动渲染线程，退出时也不会等待它。
+     */
+    void abandonAfterFork() {
+        new (&stateLock) std::mutex();
+        new (&wakeUp) std::condition_variable();
+        new (&worker) std::thread();
+        new (&active) std::vector<std::weak_ptr<ProgressCounter>>();
+        stopping = true;
+    }
+
+    /// @brief 设置终端模式下的刷新帧率。
+    void setFrameRate(unsigned framesPerSecond) {
+        std::lock_guard<std::mutex> guard(stateLock);
+        framePeriod = std::chrono::milliseconds(1000 / (framesPerSecond == 0 ? 1 : framesPerSecond));
+    }
+
+    /// @brief 设置非终端模式下打印进度摘要的间隔。
+    void setSummaryInterval(std::chrono::milliseconds interval) {
+        std::lock_guard<std::mutex> guard(stateLock);
+        summaryInterval = interval;
+    }
+
+    /// @brief 强制以终端模式（重绘进度区域）或非终端模式（打印进度摘要）显示进度，必须在开始执行测试之前调用。
+    void setInteractive(bool enabled) {
+        std::lock_guard<std::mutex> guard(stateLock);
+        interactive = enabled;
+    }
+
+    /// @brief 标准输出是否为终端。
+    bool isInteractive() const { return interactive; }
+
+    /**
+     * @brief 开始跟踪一个测试的进度。
+     *
+     * 渲染器只持有进度计数的弱引用：返回的 `shared_ptr` 的最后一个引用释放时（例如容器抛出异常、结果被丢弃），
+     * 这个测试自动停止跟踪，不会一直留在进度区域中。
+     *
+     * @param testName 测试名称。
+     * @param leaves 测试的叶子记录视图。
+     * @return 返回进度计数，子测试完成时对其自增即可。
+     */
+    std::shared_ptr<ProgressCounter> track(const std::string& testName, const LeafRange& leaves) {
+        auto counter = std::make_shared<ProgressCounter>();
+        counter->testName = testName;
+        counter->total = leaves.size();
+        counter->leaves = leaves;
+        {
+            std::lock_guard<std::mutex> guard(stateLock);
+            active.push_back(counter);
+            if (!worker.joinable() && !stopping)
+            {
+                worker = std::thread([this] { renderLoop(); });
+            }
+        }
+        return counter;
+    }
+
+    /**
+     * @brief 立即停止跟踪一个测试的进度，不必等待最后一个引用释放。
+     *
+     * @param counter 由 `track` 返回的进度计数。
+     */
+    void untrack(const std::shared_ptr<ProgressCounter>& counter) {
+        std::lock_guard<std::mutex> guard(stateLock);
+        active.erase(std::remove_if(active.begin(), active.end(), [&](const std::weak_ptr<ProgressCounter>& tracked) {
+                         std::shared_ptr<ProgressCounter> current = tracked.lock();
+                         return current == nullptr || current == counter;
+                     }),
+                     active.end());
+    }
+
+    /**
+     * @brief 清除当前绘制的进度区域。
+     *
+     * 调用者必须处于 `OutputSink::Block` 中。
+     */
+    void clearLiveArea() {
+        for (size_t i = 0; i < liveLines; i++)
+        {
+            deleteLastLine();
+        }
+        liveLines = 0;
+    }
+
+    /**
+     * @brief 立即绘制一帧。
+     *
+     * 调用者必须处于 `OutputSink::Block` 中。
+     */
+    void renderFrame() {
+        std::vector<std::shared_ptr<ProgressCounter>> snapshot;
+        {
+            std::lock_guard<std::mutex> guard(stateLock);
+            snapshot.reserve(active.size());
+            auto kept = active.begin();
+            for (const std::weak_ptr<ProgressCounter>& tracked : active)
+            {
+                std::shared_ptr<ProgressCounter> counter = tracked.lock();
+                if (counter != nullptr)
+                {
+                    snapshot.push_back(std::move(counter));
+                    *kept++ = tracked;
+                }
+            }
+            active.erase(kept, active.end());
+        }
+        if (interactive)
+        {
+            drawLiveArea(snapshot);
+        }
+        else
+        {
+            printSummaryLines(snapshot);
+        }
+        OutputSink::instance().flush();
+    }
+
+private:
+    ProgressRenderer() : interactive(OutputSink::instance().isTerminal()) {
+        // 确保输出锁先于渲染器构造，从而在程序退出时晚于渲染器析构；`OutputSink` 已在上面构造
+        outputMutex();
+    }
+
+    bool interactive;
+    size_t liveLines = 0;
+
+    std::mutex stateLock;
+    std::condition_variable wakeUp;
+    std::thread worker;
+    bool stopping = false;
+    std::vector<std::weak_ptr<ProgressCounter>> active;
+    std::chrono::milliseconds framePeriod{100};
+    std::chrono::milliseconds summaryInterval{5000};
+
+    void renderLoop() {
+        auto lastSummary = std::chrono::steady_clock::now();
+        std::unique_lock<std::mutex> guard(stateLock);
+        while (!stopping)
+        {
+            wakeUp.wait_for(guard, interactive ? framePeriod : summaryInterval);
+            if (stopping)
+            {
+                break;
+            }
+            auto now = std::chrono::steady_clock::now();
+            if (!interactive && now - lastSummary < summaryInterval)
+            {
+                continue;
+            }
+            lastSummary = now;
+            guard.unlock();
+            {
+                OutputSink::Block outputBlock;
+                renderFrame();
+            }
+            guard.lock();
+        }
+    }
+
+    /// @brief 进度区域中的一个符号或进度条格子。
+    struct Cell {
+        std::string_view text;
+        TextColor color;
+        TextStyle style;
+    };
+
+    static constexpr Cell PASSED_GLYPH{"[√]", TextColor::GREEN, TextStyle::BOLD};
+    static constexpr Cell FAILED_GLYPH{"[X]", TextColor::RED, TextStyle::BOLD};
+    static constexpr Cell RUNNING_GLYPH{"[|]", TextColor::BLUE, TextStyle::BOLD};
+    static constexpr Cell PENDING_GLYPH{"[?]", TextColor::YELLOW, TextStyle::BOLD};
+    static constexpr Cell PASSED_CELL{"#", TextColor::GREEN, TextStyle::BOLD};
+    static constexpr Cell FAILED_CELL{"#", TextColor::RED, TextStyle::BOLD};
+    static constexpr Cell PARTIAL_CELL{"-", TextColor::BLUE, TextStyle::NORMAL};
+    static constexpr Cell EMPTY_CELL{".", TextColor::DEFAULT, TextStyle::DIM};
+
+    /// @brief 追加一个格子；转义序列在绘制时查表得到，因此颜色设置的改变在下一帧生效。
+    static void appendCell(std::string& frame, const Cell& cell) { appendStyledText(frame, cell.text, cell.color, cell.style); }
+
+    void drawLiveArea(const std::vector<std::shared_ptr<ProgressCounter>>& counters) {
+        clearLiveArea();
+        std::string frame;
+        size_t drawn = 0;
+        for (const auto& counter : counters)
+        {
+            if (drawn == MAX_LIVE_LINES)
+            {
+                break;
+            }
+            const LeafRange& leaves = counter->leaves;
+            frame += getStyledText("Test: " + counter->testName + "  RUNNING ", TextColor::BLUE, TextStyle::NORMAL);
+            if (counter->total <= GLYPH_LIMIT)
+            {
+                bool runningMarked = false;
+                for (size_t i = 0; i < leaves.size(); i++)
+                {
+                    size_t id = leaves.id(i);
+                    if (leaves.records().isDone(id))
+                    {
+                        appendCell(frame, leaves.records().passed(id) ? PASSED_GLYPH : FAILED_GLYPH);
+                    }
+                    else
+                    {
+                        appendCell(frame, runningMarked ? PENDING_GLYPH : RUNNING_GLYPH);
+                        runningMarked = true;
+                    }
+                }
+            }
+            else
+            {
+                frame += "[";
+                for (size_t cell = 0; cell < BAR_WIDTH; cell++)
+                {
+                    size_t begin = cell * counter->total / BAR_WIDTH;
+                    size_t end = (cell + 1) * counter->total / BAR_WIDTH;
+                    size_t done = 0, failed = 0;
+                    leaves.records().countRange(leaves.id(begin), leaves.id(end), done, failed);
+                    if (failed > 0)
+                    {
+                        appendCell(frame, FAILED_CELL);
+                    }
+                    else if (done == end - begin)
+                    {
+                        appendCell(frame, PASSED_CELL);
+                    }
+                    else
+                    {
+                        appendCell(frame, done > 0 ? PARTIAL_CELL : EMPTY_CELL);
+                    }
+                }
+                frame += "]";
+            }
+            frame += " " + std::to_string(counter->completed.load()) + "/" + std::to_string(counter->total);
+            size_t failed = counter->failed.load();
+            if (failed > 0)
+            {
+                frame += getStyledText(" (" + std::to_string(failed) + " failed)", TextColor::RED, TextStyle::NORMAL);
+            }
+            frame += "\n";
+            drawn++;
+        }
+        if (counters.size() > drawn)
+        {
+            frame += getStyledText("... and " + std::to_string(counters.size() - drawn) + " more running", TextColor::BLUE, TextStyle::DIM) + "\n";
+            drawn++;
+        }
+        OutputSink::instance().write(frame);
+        liveLines = drawn;
+    }
+
+    void printSummaryLines(const std::vector<std::shared_ptr<ProgressCounter>>& counters) {
+        std::string lines;
+        for (const auto& counter : counters)
+        {
+            lines += "Test: " + counter->testName + "  RUNNING " + std::to_string(counter->completed.load()) + "/" + std::to_string(counter->total) +
+                     " (" + std::to_string(counter->failed.load()) + " failed)\n";
+        }
+        OutputSink::instance().write(lines);
+    }
+};
+
+#endif
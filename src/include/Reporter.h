@@ -0,0 +1,738 @@
+#ifndef REPORTER_H
+#define REPORTER_H
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+#include <LatencyHistogram.h>
+#include <PerfCounters.h>
+#include <AllocationTracker.h>
+#include <ComparisonStats.h>
+#include <ResultStore.h>
+
+/**
+ * @brief 带缓冲的文件输出。
+ *
+ * 内容先追加到固定大小的缓冲区中，缓冲区写满或调用 `flush()` 时才通过一次 `write()` 写入文件，
+ * 因此逐条写入大量短记录时，系统调用的次数与记录的数量无关。
+ *
+ * 此类不是线程安全的，由 `ResultReporter` 负责加锁。
+ */
+class BufferedWriter {
+public:
+    /// @brief 缓冲区的大小。
+    static constexpr size_t BUFFER_SIZE = size_t(1) << 16;
+
+    /**
+     * @brief 构造函数，创建或清空 path。
+     *
+     * 文件无法打开时抛出 `std::runtime_error`。
+     */
+    explicit BufferedWriter(const std::string& path) : path(path) {
+        fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        if (fd < 0)
+        {
+            throw std::runtime_error("BufferedWriter: cannot open " + path + ": " + std::strerror(errno));
+        }
+        buffer.reserve(BUFFER_SIZE);
+    }
+
+    BufferedWriter(const BufferedWriter&) = delete;
+    BufferedWriter& operator=(const BufferedWriter&) = delete;
+
+    ~BufferedWriter() {
+        flush();
+        ::close(fd);
+    }
+
+    void append(const char* data, size_t size) {
+        if (buffer.size() + size > BUFFER_SIZE)
+        {
+            flush();
+        }
+        buffer.append(data, size);
+    }
+
+    void append(const std::string& text) { append(text.data(), text.size()); }
+
+    void append(const char* text) { append(text, std::strlen(text)); }
+
+    void append(char c) {
+        if (buffer.size() + 1 > BUFFER_SIZE)
+        {
+            flush();
+        }
+        buffer.push_back(c);
+    }
+
+    void appendNumber(uint64_t value) {
+        char digits[24];
+        int length = std::snprintf(digits, sizeof(digits), "%llu", static_cast<unsigned long long>(value));
+        append(digits, static_cast<size_t>(length));
+    }
+
+    /// @brief 将缓冲区中的内容写入文件。
+    void flush() {
+        size_t written = 0;
+        while (written < buffer.size())
+        {
+            ssize_t count = ::write(fd, buffer.data() + written, buffer.size() - written);
+            if (count < 0 && errno == EINTR)
+            {
+                continue;
+            }
+            if (count <= 0)
+            {
+                failed = true;
+                break;
+            }
+            written += static_cast<size_t>(count);
+        }
+        buffer.clear();
+    }
+
+    /// @brief 此前的写入是否全部成功。
+    bool good() const { return !failed; }
+
+    /// @brief 输出文件的路径。
+    const std::string& filePath() const { return path; }
+
+private:
+    std::string path;
+    int fd = -1;
+    std::string buffer;
+    bool failed = false;
+};
+
+/**
+ * @brief 返回 data 处一个合法 UTF-8 字符的字节数，不合法时返回 0。
+ *
+ * 过长编码、代理区码点和超出 U+10FFFF 的码点都视为不合法。
+ */
+inline size_t utf8SequenceLength(const unsigned char* data, size_t remaining) {
+    unsigned char lead = data[0];
+    size_t length = lead < 0x80 ? 1 : (lead >= 0xC2 && lead <= 0xDF ? 2 : (lead >= 0xE0 && lead <= 0xEF ? 3 : (lead >= 0xF0 && lead <= 0xF4 ? 4 : 0)));
+    if (length == 0 || length > remaining)
+    {
+        return 0;
+    }
+    for (size_t i = 1; i < length; i++)
+    {
+        if ((data[i] & 0xC0) != 0x80)
+        {
+            return 0;
+        }
+    }
+    if ((lead == 0xE0 && data[1] < 0xA0) || (lead == 0xED && data[1] >= 0xA0) || (lead == 0xF0 && data[1] < 0x90) || (lead == 0xF4 && data[1] >= 0x90))
+    {
+        return 0;
+    }
+    return length;
+}
+
+/**
+ * @brief 以 JSON 字符串的形式（包括两侧的引号）写入 text。
+ *
+ * 控制字符写为 `\uXXXX`，不合法的 UTF-8 字节替换为 U+FFFD，因此任意字节串（例如模糊测试的输入）都能生成合法的 JSON。
+ */
+inline void appendJsonString(BufferedWriter& out, const std::string& text) {
+    static const char* hex = "0123456789abcdef";
+    const unsigned char* data = reinterpret_cast<const unsigned char*>(text.data());
+    out.append('"');
+    for (size_t i = 0; i < text.size();)
+    {
+        unsigned char c = data[i];
+        size_t length = utf8SequenceLength(data + i, text.size() - i);
+        if (length == 0)
+        {
+            out.append("\\ufffd");
+            i++;
+            continue;
+        }
+        if (c == '"' || c == '\\')
+        {
+            out.append('\\');
+            out.append(static_cast<char>(c));
+        }
+        else if (c == '\n')
+        {
+            out.append("\\n");
+        }
+        else if (c == '\t')
+        {
+            out.append("\\t");
+        }
+        else if (c < 0x20 || c == 0x7F)
+        {
+            char escaped[6] = {'\\', 'u', '0', '0', hex[c >> 4], hex[c & 15]};
+            out.append(escaped, 6);
+        }
+        else
+        {
+            out.append(reinterpret_cast<const char*>(data + i), length);
+        }
+        i += length;
+    }
+    out.append('"');
+}
+
+/**
+ * @brief 以 XML 文本或属性值的形式写入 text。
+ *
+ * XML 1.0 不允许出现的字符（控制字符、U+FFFE 和 U+FFFF）和不合法的 UTF-8 字节替换为 U+FFFD。
+ */
+inline void appendXmlText(BufferedWriter& out, const std::string& text) {
+    const unsigned char* data = reinterpret_cast<const unsigned char*>(text.data());
+    for (size_t i = 0; i < text.size();)
+    {
+        unsigned char c = data[i];
+        size_t length = utf8SequenceLength(data + i, text.size() - i);
+        bool nonCharacter = length == 3 && c == 0xEF && data[i + 1] == 0xBF && data[i + 2] >= 0xBE;
+        if (length == 0 || nonCharacter || (c < 0x20 && c != '\t' && c != '\n' && c != '\r'))
+        {
+            out.append("&#xFFFD;");
+            i += length == 0 ? 1 : length;
+            continue;
+        }
+        switch (c)
+        {
+        case '&': out.append("&amp;"); break;
+        case '<': out.append("&lt;"); break;
+        case '>': out.append("&gt;"); break;
+        case '"': out.append("&quot;"); break;
+        case '\n': out.append("&#10;"); break;
+        case '\r': out.append("&#13;"); break;
+        default: out.append(reinterpret_cast<const char*>(data + i), length); break;
+        }
+        i += length;
+    }
+}
+
+/**
+ * @brief 写入报告的一个容器（测试结果树中的非叶子节点）。
+ *
+ * 只携带汇总数据和不带样式的错误信息，由 `TestResult::reportContainer()` 填写。
+ */
+struct ContainerReport {
+    /// @brief 完整的测试名称。
+    std::string name;
+
+    bool passed = true;
+
+    /// @brief 是否为叶子节点的父节点。
+    bool isParentOfLeaf = false;
+
+    /// @brief 子测试的数量。
+    uint64_t total = 0;
+
+    /// @brief 已完成的子测试数量。
+    uint64_t finished = 0;
+
+    /// @brief 失败的测试数量（对非叶子子测试按其下层的失败数量累加）。
+    uint64_t failed = 0;
+
+    /// @brief 结果来自 `ResultCache` 的叶子数量（同样按下层累加），它们也计入 `finished`。
+    uint64_t cached = 0;
+
+    /// @brief 运行时间（纳秒）。
+    uint64_t runTime = 0;
+
+    /// @brief 下层所有叶子的运行时间直方图。
+    const LatencyHistogram* latency = nullptr;
+
+    /// @brief 下层所有叶子的性能计数器之和。
+    const PerfCounterSet* counters = nullptr;
+
+    /// @brief 下层所有叶子的内存分配统计，以及容器的常驻内存。
+    const AllocationStats* allocations = nullptr;
+
+    /// @brief 下层所有叶子的 A/B 比较数据。
+    const ComparisonStats* comparison = nullptr;
+
+    /// @brief 附加的统计信息。
+    const std::vector<std::string>* summaryInfo = nullptr;
+
+    /// @brief 容器自身的错误信息（不带样式），不包括叶子的错误信息。
+    std::vector<std::string> errors;
+};
+
+/**
+ * @brief 写入报告的一个叶子测试。
+ */
+struct LeafReport {
+    /// @brief 叶子测试的状态。
+    enum class Status {
+        PASSED,
+        FAILED,
+        SKIPPED,    // 没有写入结果，例如被中止的测试
+        CACHED      // 在此前的运行中已经通过，见 `ResultCache`
+    };
+
+    uint32_t testIndex = 0;
+    Status status = Status::SKIPPED;
+
+    /// @brief 运行时间（纳秒）。
+    uint64_t runTime = 0;
+
+    /// @brief 错误信息（不带样式），只有失败的叶子才会生成。
+    std::vector<std::string> errors;
+
+    static const char* statusName(Status status) {
+        return status == Status::PASSED ? "passed" : (status == Status::FAILED ? "failed" : (status == Status::CACHED ? "cached" : "skipped"));
+    }
+};
+
+/**
+ * @brief 报告格式的基类。
+ *
+ * 每个容器结束时，`ResultReporter` 依次调用 `beginContainer()`、对其中的每个叶子调用 `writeLeaf()`、最后调用 `endContainer()`；
+ * 容器按结束的先后顺序写入，因此子容器总是先于父容器出现。所有调用都在 `ResultReporter` 的锁中进行。
+ */
+class ResultWriter {
+public:
+    virtual ~ResultWriter() {}
+
+    virtual void beginContainer(const ContainerReport& container) { (void)container; }
+    virtual void writeLeaf(const ContainerReport& container, const LeafReport& leaf) = 0;
+    virtual void endContainer(const ContainerReport& container) = 0;
+
+    /// @brief 将缓冲的内容写入文件，不写入结尾。
+    virtual void flush() {}
+
+    /// @brief 写入结尾并刷新缓冲区，之后不会再被调用。
+    virtual void close() = 0;
+};
+
+/**
+ * @brief JSON Lines 格式的报告。
+ *
+ * 每行一个 JSON 对象，每个叶子一行（`"type":"test"`），随后是其所在容器的一行（`"type":"container"`）：
+ * ```
+ * {"type":"test","container":"ShowCase.ExampleTest.test-0","index":3,"status":"failed","time_ns":75123,"messages":["..."]}
+ * {"type":"container","name":"ShowCase.ExampleTest.test-0","status":"failed","tests":50,"finished":50,"failures":1,"time_ns":...,
+ *  "latency_ns":{"p50":...,"p90":...,"p99":...,"p99.9":...,"max":...},"counters":{...},"allocations":{...},"comparison":{...},"info":[...],"messages":[...]}
+ * ```
+ * `counters` 和 `allocations` 分别只在启用 `PerfCounters` 和 `AllocationTracker` 时出现，`cached` 只在有叶子的结果来自 `ResultCache` 时出现，
+ * `comparison` 只在下层有 `ComparisonExecutorClass` 的叶子时出现。
+ * 写到一半中断的文件只会缺少末尾的记录，已经写入的每一行都是完整的。
+ */
+class JsonLinesWriter : public ResultWriter {
+public:
+    explicit JsonLinesWriter(const std::string& path) : out(path) {}
+
+    void writeLeaf(const ContainerReport& container, const LeafReport& leaf) override {
+        out.append("{\"type\":\"test\",\"container\":");
+        appendJsonString(out, container.name);
+        out.append(",\"index\":");
+        out.appendNumber(leaf.testIndex);
+        out.append(",\"status\":\"");
+        out.append(LeafReport::statusName(leaf.status));
+        out.append("\",\"time_ns\":");
+        out.appendNumber(leaf.runTime);
+        out.append(",\"messages\":");
+        appendArray(leaf.errors);
+        out.append("}\n");
+    }
+
+    void endContainer(const ContainerReport& container) override {
+        out.append("{\"type\":\"container\",\"name\":");
+        appendJsonString(out, container.name);
+        out.append(container.passed ? ",\"status\":\"passed\"" : ",\"status\":\"failed\"");
+        appendField("tests", container.total);
+        appendField("finished", container.finished);
+        appendField("failures", container.failed);
+        if (container.cached != 0)
+        {
+            appendField("cached", container.cached);
+        }
+        appendField("time_ns", container.runTime);
+        if (container.latency != nullptr && container.latency->count() != 0)
+        {
+            out.append(",\"latency_ns\":{\"p50\":");
+            out.appendNumber(container.latency->percentile(50));
+            out.append(",\"p90\":");
+            out.appendNumber(container.latency->percentile(90));
+            out.append(",\"p99\":");
+            out.appendNumber(container.latency->percentile(99));
+            out.append(",\"p99.9\":");
+            out.appendNumber(container.latency->percentile(99.9));
+            out.append(",\"max\":");
+            out.appendNumber(container.latency->max());
+            out.append('}');
+        }
+        if (container.counters != nullptr && !container.counters->empty())
+        {
+            out.append(",\"counters\":{");
+            bool first = true;
+            for (size_t i = 0; i < PerfCounterSet::COUNTER_COUNT; i++)
+            {
+                PerfCounter counter = static_cast<PerfCounter>(i);
+                if (container.counters->has(counter))
+                {
+                    out.append(first ? "\"" : ",\"");
+                    out.append(counterKey(counter));
+                    out.append("\":");
+                    out.appendNumber((*container.counters)[counter]);
+                    first = false;
+                }
+            }
+            out.append('}');
+        }
+        if (container.allocations != nullptr && !container.allocations->empty())
+        {
+            const AllocationStats& allocations = *container.allocations;
+            out.append(",\"allocations\":{\"tests\":");
+            out.appendNumber(allocations.tests);
+            appendField("count", allocations.allocations);
+            appendField("frees", allocations.frees);
+            appendField("bytes", allocations.bytesAllocated);
+            appendField("peak_live_bytes", allocations.peakLiveBytes);
+            if (allocations.residentEnd != 0)
+            {
+                appendField("rss_start_bytes", allocations.residentStart);
+                appendField("rss_end_bytes", allocations.residentEnd);
+            }
+            out.append('}');
+        }
+        if (container.comparison != nullptr && !container.comparison->empty())
+        {
+            const ComparisonStats& comparison = *container.comparison;
+            ComparisonStats::Interval interval = comparison.confidenceInterval();
+            out.append(",\"comparison\":{\"inputs\":");
+            out.appendNumber(comparison.inputs());
+            appendField("faster_inputs", comparison.fasterInputs());
+            appendRatio("speedup", comparison.speedup());
+            appendRatio("ci_low", interval.low);
+            appendRatio("ci_high", interval.high);
+            out.append('}');
+        }
+        out.append(",\"info\":");
+        appendArray(container.summaryInfo == nullptr ? std::vector<std::string>() : *container.summaryInfo);
+        out.append(",\"messages\":");
+        appendArray(container.errors);
+        out.append("}\n");
+    }
+
+    void flush() override { out.flush(); }
+
+    void close() override { out.flush(); }
+
+private:
+    BufferedWriter out;
+
+    static const char* counterKey(PerfCounter counter) {
+        static const char* keys[] = {"cycles", "instructions", "cache_misses", "branch_misses", "task_clock_ns", "page_faults", "context_switches"};
+        return keys[static_cast<size_t>(counter)];
+    }
+
+    void appendField(const char* name, uint64_t value) {
+        out.append(",\"");
+        out.append(name);
+        out.append("\":");
+        out.appendNumber(value);
+    }
+
+    void appendRatio(const char* name, double value) {
+        char digits[32];
+        int length = std::snprintf(digits, sizeof(digits), "%.4f", value);
+        out.append(",\"");
+        out.append(name);
+        out.append("\":");
+        out.append(digits, static_cast<size_t>(length));
+    }
+
+    void appendArray(const std::vector<std::string>& values) {
+        out.append('[');
+        for (size_t i = 0; i < values.size(); i++)
+        {
+            if (i != 0)
+            {
+                out.append(',');
+            }
+            appendJsonString(out, values[i]);
+        }
+        out.append(']');
+    }
+};
+
+/**
+ * @brief JUnit XML 格式的报告。
+ *
+ * 每个叶子节点的父节点对应一个 `<testsuite>`，其中每个叶子对应一个 `<testcase>`，失败的叶子带有 `<failure>`，
+ * 没有写入结果的叶子带有 `<skipped/>`；容器的附加统计信息写入 `<system-out>`。
+ * 容器自身的错误信息（例如模糊测试发现的失败输入）写入一个与容器同名的 `<testcase>`，
+ * 没有叶子记录的叶子节点父节点总是写入这样一个 `<testcase>`，使其结果不会被忽略。
+ * 其余的容器不单独写入，它们的结果已经体现在下层的 `<testsuite>` 中。
+ *
+ * 每个 `<testsuite>` 在其容器结束时立即写入，`close()` 写入结尾的 `</testsuites>`。
+ */
+class JUnitWriter : public ResultWriter {
+public:
+    explicit JUnitWriter(const std::string& path) : out(path) {
+        out.append("<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<testsuites>\n");
+    }
+
+    void beginContainer(const ContainerReport& container) override {
+        if (!container.isParentOfLeaf)
+        {
+            return;
+        }
+        out.append("  <testsuite name=\"");
+        appendXmlText(out, container.name);
+        out.append("\" tests=\"");
+        out.appendNumber(container.total);
+        out.append("\" failures=\"");
+        out.appendNumber(container.failed);
+        out.append("\" errors=\"0\" skipped=\"");
+        out.appendNumber((container.total > container.finished ? container.total - container.finished : 0) + container.cached);
+        out.append("\" time=\"");
+        appendSeconds(container.runTime);
+        out.append("\">\n");
+    }
+
+    void writeLeaf(const ContainerReport& container, const LeafReport& leaf) override {
+        leafCount++;
+        out.append("    <testcase classname=\"");
+        appendXmlText(out, container.name);
+        out.append("\" name=\"Test ");
+        out.appendNumber(leaf.testIndex);
+        out.append("\" time=\"");
+        appendSeconds(leaf.runTime);
+        if (leaf.status == LeafReport::Status::PASSED)
+        {
+            out.append("\"/>\n");
+            return;
+        }
+        out.append("\">\n");
+        if (leaf.status == LeafReport::Status::SKIPPED)
+        {
+            out.append("      <skipped/>\n");
+        }
+        else if (leaf.status == LeafReport::Status::CACHED)
+        {
+            out.append("      <skipped message=\"passed in a cached run\"/>\n");
+        }
+        else
+        {
+            appendFailure(leaf.errors);
+        }
+        out.append("    </testcase>\n");
+    }
+
+    void endContainer(const ContainerReport& container) override {
+        if (!container.isParentOfLeaf)
+        {
+            return;
+        }
+        if (leafCount == 0 || !container.errors.empty())
+        {
+            writeContainerCase(container);
+        }
+        if (container.summaryInfo != nullptr && !container.summaryInfo->empty())
+        {
+            out.append("    <system-out>");
+            for (const auto& line : *container.summaryInfo)
+            {
+                appendXmlText(out, line);
+                out.append("&#10;");
+            }
+            out.append("</system-out>\n");
+        }
+        out.append("  </testsuite>\n");
+        leafCount = 0;
+    }
+
+    void flush() override { out.flush(); }
+
+    void close() override {
+        if (!closed)
+        {
+            out.append("</testsuites>\n");
+            out.flush();
+            closed = true;
+        }
+    }
+
+private:
+    BufferedWriter out;
+    size_t leafCount = 0;
+    bool closed = false;
+
+    void appendSeconds(uint64_t nanoseconds) {
+        char seconds[32];
+        int length = std::snprintf(seconds, sizeof(seconds), "%.9f", static_cast<double>(nanoseconds) / 1e9);
+        out.append(seconds, static_cast<size_t>(length));
+    }
+
+    void appendFailure(const std::vector<std::string>& errors) {
+        out.append("      <failure message=\"");
+        appendXmlText(out, errors.empty() ? std::string("failed") : errors.front());
+        out.append("\">");
+        for (const auto& error : errors)
+        {
+            appendXmlText(out, error);
+            out.append("&#10;");
+        }
+        out.append("</failure>\n");
+    }
+
+    void writeContainerCase(const ContainerReport& container) {
+        out.append("    <testcase classname=\"");
+        appendXmlText(out, container.name);
+        out.append("\" name=\"");
+        appendXmlText(out, container.name);
+        out.append("\" time=\"");
+        appendSeconds(container.runTime);
+        if (container.passed)
+        {
+            out.append("\"/>\n");
+            return;
+        }
+        out.append("\">\n");
+        appendFailure(container.errors);
+        out.append("    </testcase>\n");
+    }
+};
+
+/**
+ * @brief 机器可读的结果报告。
+ *
+ * 每个容器结束时（叶子节点的父节点在 `finishSubtestBatch()` 中，其余容器在 `ProceedTest()` 返回前），
+ * 其汇总数据和其中每个叶子的记录会立即交给所有启用的报告格式，经过缓冲后写入文件。
+ * 叶子记录直接从 `ResultStore` 读取，错误信息在写入时才生成，且不带任何样式，
+ * 因此报告不依赖完整的 `TestResult` 树，写入的内存开销只与单条记录的大小有关。
+ *
+ * 示例：
+ * ```cpp
+ * ResultReporter::instance().writeJsonLines("results.jsonl");
+ * ResultReporter::instance().writeJUnit("results.xml");
+ * rootClass.ProceedTest("ShowCase");
+ * ResultReporter::instance().close();
+ * ```
+ */
+class ResultReporter {
+public:
+    /// @brief 全局唯一的报告。
+    static ResultReporter& instance() {
+        static ResultReporter reporter;
+        return reporter;
+    }
+
+    ~ResultReporter() { close(); }
+
+    /// @brief 是否启用了任何报告格式。
+    bool isActive() const { return active.load(std::memory_order_relaxed); }
+
+    /// @brief 以 JSON Lines 格式写入 path。文件无法打开时抛出 `std::runtime_error`。
+    void writeJsonLines(const std::string& path) { addWriter(std::unique_ptr<ResultWriter>(new JsonLinesWriter(path))); }
+
+    /// @brief 以 JUnit XML 格式写入 path。文件无法打开时抛出 `std::runtime_error`。
+    void writeJUnit(const std::string& path) { addWriter(std::unique_ptr<ResultWriter>(new JUnitWriter(path))); }
+
+    /// @brief 添加一个自定义的报告格式。
+    void addWriter(std::unique_ptr<ResultWriter> writer) {
+        std::lock_guard<std::mutex> guard(lock);
+        writers.push_back(std::move(writer));
+        active = true;
+    }
+
+    /**
+     * @brief 写入一个容器及其叶子记录。
+     *
+     * 由 `TestResult::reportContainer()` 调用。
+     *
+     * @param container 容器的汇总数据。
+     * @param leaves 容器的叶子记录，不是叶子节点的父节点时为 nullptr。
+     */
+    void report(const ContainerReport& container, const LeafRange* leaves) {
+        std::lock_guard<std::mutex> guard(lock);
+        for (auto& writer : writers)
+        {
+            writer->beginContainer(container);
+        }
+        if (leaves != nullptr && leaves->valid())
+        {
+            const ResultStore& records = leaves->records();
+            LeafReport leaf;
+            for (size_t i = 0; i < leaves->size(); i++)
+            {
+                size_t id = leaves->id(i);
+                leaf.testIndex = static_cast<uint32_t>(i);
+                leaf.runTime = 0;
+                leaf.status = LeafReport::Status::SKIPPED;
+                leaf.errors.clear();
+                if (records.isDone(id))
+                {
+                    leaf.runTime = records.runTime(id);
+                    leaf.status = records.passed(id) ? (records.isCached(id) ? LeafReport::Status::CACHED : LeafReport::Status::PASSED) : LeafReport::Status::FAILED;
+                    if (leaf.status == LeafReport::Status::FAILED)
+                    {
+                        leaf.errors = records.errors(id);
+                    }
+                }
+                for (auto& writer : writers)
+                {
+                    writer->writeLeaf(container, leaf);
+                }
+            }
+        }
+        for (auto& writer : writers)
+        {
+            writer->endContainer(container);
+        }
+    }
+
+    /// @brief 写入所有报告的结尾并刷新缓冲区，之后的结果不再写入。
+    void close() {
+        std::lock_guard<std::mutex> guard(lock);
+        for (auto& writer : writers)
+        {
+            writer->close();
+        }
+        writers.clear();
+        active = false;
+    }
+
+    /// @brief 将所有报告中缓冲的内容写入文件，不写入结尾。
+    void flush() {
+        std::lock_guard<std::mutex> guard(lock);
+        for (auto& writer : writers)
+        {
+            writer->flush();
+        }
+    }
+
+    /**
+     * @brief fork 之后在子进程中丢弃从父进程继承的报告。
+     *
+     * 继承的缓冲区和文件属于父进程：不刷新也不关闭，以免子进程退出时析构函数把父进程缓冲的记录和结尾再写一遍。
+     * fork 时其他线程可能正持有锁，因此重新构造锁。
+     */
+    void abandonAfterFork() {
+        new (&lock) std::mutex();
+        for (auto& writer : writers)
+        {
+            writer.release();
+        }
+        writers.clear();
+        active = false;
+    }
+
+private:
+    ResultReporter() {}
+
+    std::mutex lock;
+    std::atomic<bool> active{false};
+    std::vector<std::unique_ptr<ResultWriter>> writers;
+};
+
+#endif
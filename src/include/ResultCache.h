@@ -0,0 +1,269 @@
+#ifndef RESULT_CACHE_H
+#define RESULT_CACHE_H
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <mutex>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+#include <InputFiles.h>
+
+/**
+ * 结果缓存文件格式（所有整数均为小端序）：
+ * ```
+ * 0   "FTSCACHE"         8 字节魔数
+ * 8   uint32 版本号
+ * 12  uint32 保留
+ * 16  uint64 构建标识的哈希值
+ * 24  uint64 槽位数量（2 的幂）
+ * 32  uint64 有效键的数量
+ * 40  uint64 槽位[槽位数量]  开放寻址的哈希表，0 表示空槽位
+ * ```
+ */
+static constexpr char RESULT_CACHE_MAGIC[8] = {'F', 'T', 'S', 'C', 'A', 'C', 'H', 'E'};
+static constexpr uint32_t RESULT_CACHE_VERSION = 1;
+
+/**
+ * @brief 增量测试的结果缓存。
+ *
+ * 记录在同一构建下已经通过的叶子测试，再次运行时直接跳过它们，只执行新增、变化或此前失败的输入。
+ * 键是 `容器名称 + 输入字节` 的 FNV-1a 哈希值，并以构建标识（例如 git 提交号或被测程序的哈希）为种子，
+ * 因此构建变化后所有条目自动失效：打开构建标识不同的缓存文件时从空缓存开始。
+ *
+ * 缓存文件是一张只保存 64 位键的开放寻址哈希表，打开时整个映射到内存中，查询无需加锁，也不会在启动时读入整个文件。
+ * 本次运行中新通过的键在 `save()` 时与原有的键合并，写入临时文件后再替换原文件；本次运行中失败过的键不会写入。
+ *
+ * 缓存只对通过 `CachedExecutorClass` 执行的叶子测试生效，命中的叶子测试记为通过，在汇总和报告中标记为 cached。
+ * 多个进程（例如多个分片）同时写入同一个缓存文件时，最后一次 `save()` 的结果生效。
+ *
+ * 示例：
+ * ```cpp
+ * ResultCache::instance().open("results.cache", BUILD_ID);
+ * rootClass.ProceedTest("ShowCase");
+ * ResultCache::instance().save();
+ * ```
+ */
+class ResultCache {
+public:
+    /// @brief 全局唯一的结果缓存。
+    static ResultCache& instance() {
+        static ResultCache cache;
+        return cache;
+    }
+
+    /**
+     * @brief 启用缓存并映射 path 中的缓存文件。
+     *
+     * 文件不存在、格式不正确或构建标识不同时从空缓存开始。必须在开始执行测试之前调用。
+     *
+     * @param path 缓存文件路径，`save()` 时写入同一路径。
+     * @param buildId 构建标识，不同的构建标识之间不共享缓存条目。
+     */
+    void open(const std::string& path, const std::string& buildId) {
+        unmap();
+        cachePath = path;
+        buildHash = fnv1aHash(buildId);
+        enabled = true;
+
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+        {
+            return;
+        }
+        struct stat info;
+        if (fstat(fd, &info) != 0 || info.st_size < static_cast<off_t>(HEADER_SIZE))
+        {
+            close(fd);
+            return;
+        }
+        size_t length = static_cast<size_t>(info.st_size);
+        void* mapping = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+        if (mapping == MAP_FAILED)
+        {
+            return;
+        }
+        const char* base = static_cast<const char*>(mapping);
+        uint32_t version;
+        uint64_t fileBuildHash;
+        uint64_t capacity;
+        std::memcpy(&version, base + 8, sizeof(version));
+        std::memcpy(&fileBuildHash, base + 16, sizeof(fileBuildHash));
+        std::memcpy(&capacity, base + 24, sizeof(capacity));
+        bool valid = std::memcmp(base, RESULT_CACHE_MAGIC, 8) == 0 && version == RESULT_CACHE_VERSION && fileBuildHash == buildHash &&
+                     capacity != 0 && (capacity & (capacity - 1)) == 0 && capacity <= (length - HEADER_SIZE) / sizeof(uint64_t);
+        if (!valid)
+        {
+            munmap(mapping, length);
+            return;
+        }
+        mapped = mapping;
+        mappedLength = length;
+        slots = reinterpret_cast<const uint64_t*>(base + HEADER_SIZE);
+        slotMask = capacity - 1;
+    }
+
+    /// @brief 是否启用了缓存。
+    bool isEnabled() const { return enabled; }
+
+    /**
+     * @brief 计算一个叶子测试的缓存键。
+     *
+     * @param containerName 叶子节点的父节点的完整名称。
+     * @param input 输入的字节表示。
+     * @return 返回非零的缓存键。
+     */
+    uint64_t key(std::string_view containerName, std::string_view input) const {
+        uint64_t hash = fnv1aHash(input, fnv1aHash(std::string_view("\0", 1), fnv1aHash(containerName, buildHash)));
+        return hash != 0 ? hash : 1;
+    }
+
+    /// @brief 键是否在此前的运行中通过。此方法是线程安全的。
+    bool contains(uint64_t key) const {
+        if (slots == nullptr)
+        {
+            return false;
+        }
+        uint64_t slot = key & slotMask;
+        for (uint64_t probe = 0; probe <= slotMask; probe++, slot = (slot + 1) & slotMask)
+        {
+            if (slots[slot] == key)
+            {
+                hitCount.fetch_add(1, std::memory_order_relaxed);
+                return true;
+            }
+            if (slots[slot] == 0)
+            {
+                return false;
+            }
+        }
+        return false;
+    }
+
+    /// @brief 记录一个叶子测试的执行结果，通过的键在 `save()` 时写入缓存。此方法是线程安全的。
+    void record(uint64_t key, bool passed) {
+        std::lock_guard<std::mutex> guard(lock);
+        (passed ? passedKeys : failedKeys).push_back(key);
+    }
+
+    /// @brief 本次运行中命中缓存的叶子测试数量。
+    uint64_t hits() const { return hitCount.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief 将原有的键和本次运行中新通过的键写入缓存文件。
+     *
+     * 未启用缓存时不做任何处理。文件无法写入时抛出 `std::runtime_error`。
+     */
+    void save() {
+        if (!enabled)
+        {
+            return;
+        }
+        std::vector<uint64_t> keys;
+        std::vector<uint64_t> failed;
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            keys = passedKeys;
+            failed = failedKeys;
+        }
+        for (uint64_t slot = 0; slots != nullptr && slot <= slotMask; slot++)
+        {
+            if (slots[slot] != 0)
+            {
+                keys.push_back(slots[slot]);
+            }
+        }
+        std::sort(keys.begin(), keys.end());
+        keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+        std::sort(failed.begin(), failed.end());
+        keys.erase(std::remove_if(keys.begin(), keys.end(), [&](uint64_t key) { return std::binary_search(failed.begin(), failed.end(), key); }),
+                   keys.end());
+
+        // 装载因子不超过 1/2，保证线性探测的探测长度较短
+        uint64_t capacity = 64;
+        while (capacity < keys.size() * 2)
+        {
+            capacity <<= 1;
+        }
+        std::vector<uint64_t> table(capacity, 0);
+        for (uint64_t key : keys)
+        {
+            uint64_t slot = key & (capacity - 1);
+            while (table[slot] != 0)
+            {
+                slot = (slot + 1) & (capacity - 1);
+            }
+            table[slot] = key;
+        }
+
+        std::string temporaryPath = cachePath + ".tmp." + std::to_string(getpid());
+        FILE* file = std::fopen(temporaryPath.c_str(), "wb");
+        if (file == nullptr)
+        {
+            throw std::runtime_error("ResultCache: cannot create " + temporaryPath);
+        }
+        uint32_t header32[2] = {RESULT_CACHE_VERSION, 0};
+        uint64_t header64[3] = {buildHash, capacity, static_cast<uint64_t>(keys.size())};
+        bool written = std::fwrite(RESULT_CACHE_MAGIC, 1, 8, file) == 8 && std::fwrite(header32, sizeof(header32), 1, file) == 1 &&
+                       std::fwrite(header64, sizeof(header64), 1, file) == 1 && std::fwrite(table.data(), sizeof(uint64_t), capacity, file) == capacity;
+        written = std::fclose(file) == 0 && written;
+        if (!written || std::rename(temporaryPath.c_str(), cachePath.c_str()) != 0)
+        {
+            std::remove(temporaryPath.c_str());
+            throw std::runtime_error("ResultCache: cannot write " + cachePath);
+        }
+    }
+
+    /**
+     * @brief fork 之后在子进程中重新构造锁。
+     *
+     * fork 时其他线程可能正持有锁。子进程不调用 `save()`，映射的缓存文件是只读的，析构时只解除子进程自己的映射。
+     */
+    void abandonAfterFork() { new (&lock) std::mutex(); }
+
+    ~ResultCache() { unmap(); }
+
+    ResultCache(const ResultCache&) = delete;
+    ResultCache& operator=(const ResultCache&) = delete;
+
+private:
+    static constexpr size_t HEADER_SIZE = 40;
+
+    ResultCache() = default;
+
+    void unmap() {
+        if (mapped != nullptr)
+        {
+            munmap(mapped, mappedLength);
+        }
+        mapped = nullptr;
+        mappedLength = 0;
+        slots = nullptr;
+        slotMask = 0;
+    }
+
+    bool enabled = false;
+    std::string cachePath;
+    uint64_t buildHash = 0;
+
+    void* mapped = nullptr;
+    size_t mappedLength = 0;
+    const uint64_t* slots = nullptr;
+    uint64_t slotMask = 0;
+
+    mutable std::atomic<uint64_t> hitCount{0};
+    std::mutex lock;
+    std::vector<uint64_t> passedKeys;
+    std::vector<uint64_t> failedKeys;
+};
+
+#endif
@@ -0,0 +1,230 @@
+#ifndef RESULT_STORE_H
+#define RESULT_STORE_H
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <Assertion.h>
+
+/**
+ * @brief 叶子测试结果的列式存储。
+ *
+ * 每个叶子测试只占用一条紧凑记录：通过标记位、缓存标记位、运行时间、索引号，以及指向共享错误信息区的偏移量和数量。
+ * 错误信息区保存的是失败断言的原始记录（见 `AssertionRecord`），只在输出报告时才格式化为文本。
+ * 记录按列分块存放在由 `TestDriverClass` 持有的存储中，父节点只保存指向其中一段连续记录的视图（见 `LeafRange`）
+ * 和汇总数据，而不再保存每个叶子的 `TestResult` 副本。
+ *
+ * 存储按固定大小的块增长，已分配的记录地址永远不会移动，因此不同线程可以无锁地写入各自预留的记录。
+ * 只有预留记录和写入错误信息时需要加锁。
+ */
+class ResultStore {
+public:
+    /// @brief 每个块包含的记录数量（以 2 的幂表示）。
+    static constexpr size_t BLOCK_BITS = 14;
+    static constexpr size_t BLOCK_SIZE = size_t(1) << BLOCK_BITS;
+    /// @brief 块目录的容量，决定了单个存储最多能容纳的记录数量。
+    static constexpr size_t MAX_BLOCKS = size_t(1) << 14;
+
+    ResultStore() {}
+    ResultStore(const ResultStore&) = delete;
+    ResultStore& operator=(const ResultStore&) = delete;
+
+    ~ResultStore() {
+        for (size_t i = 0; i < blockCount; i++)
+        {
+            delete blocks[i];
+        }
+    }
+
+    /**
+     * @brief 预留一段连续的记录。
+     *
+     * @param count 需要预留的记录数量。
+     * @return 返回第一条记录的编号，之后的 count 条记录都属于调用者。
+     */
+    size_t reserve(size_t count) {
+        std::lock_guard<std::mutex> guard(storeLock);
+        size_t base = recordCount;
+        size_t requiredBlocks = (base + count + BLOCK_SIZE - 1) >> BLOCK_BITS;
+        if (requiredBlocks > MAX_BLOCKS)
+        {
+            throw std::length_error("ResultStore: too many leaf records");
+        }
+        while (blockCount < requiredBlocks)
+        {
+            blocks[blockCount++] = new Block();
+        }
+        recordCount += count;
+        return base;
+    }
+
+    /**
+     * @brief 写入一条叶子记录。
+     *
+     * 不同记录可以在不同线程中同时写入。
+     *
+     * @param id 记录编号，必须位于此前 `reserve` 得到的范围内。
+     * @param passed 叶子测试是否通过。
+     * @param runTime 叶子测试的运行时间。
+     * @param testIndex 叶子测试的索引号。
+     * @param failures 叶子测试中失败断言的记录。
+     * @param textPool 失败断言记录所引用的文本池。
+     * @param cached 结果是否来自 `ResultCache`，即叶子测试没有实际执行。
+     */
+    void record(size_t id, bool passed, uint64_t runTime, uint32_t testIndex, const std::vector<AssertionRecord>& failures, const std::string& textPool,
+                bool cached = false) {
+        Block& block = blockOf(id);
+        size_t slot = id & (BLOCK_SIZE - 1);
+        block.runTime[slot] = runTime;
+        block.testIndex[slot] = testIndex;
+        block.errorCount[slot] = static_cast<uint32_t>(failures.size());
+        if (!failures.empty())
+        {
+            std::lock_guard<std::mutex> guard(errorLock);
+            block.errorOffset[slot] = static_cast<uint32_t>(failureRecords.size());
+            uint32_t delta = static_cast<uint32_t>(failureText.size());
+            failureText += textPool;
+            for (AssertionRecord failure : failures)
+            {
+                rebaseAssertion(failure, delta);
+                failureRecords.push_back(failure);
+            }
+        }
+        uint64_t bit = uint64_t(1) << (slot & 63);
+        if (passed)
+        {
+            block.passBits[slot >> 6].fetch_or(bit, std::memory_order_relaxed);
+        }
+        if (cached)
+        {
+            block.cachedBits[slot >> 6].fetch_or(bit, std::memory_order_relaxed);
+        }
+        block.doneBits[slot >> 6].fetch_or(bit, std::memory_order_release);
+    }
+
+    /// @brief 记录是否已经写入。
+    bool isDone(size_t id) const {
+        size_t slot = id & (BLOCK_SIZE - 1);
+        return (blockOf(id).doneBits[slot >> 6].load(std::memory_order_acquire) >> (slot & 63)) & 1;
+    }
+
+    /// @brief 记录对应的叶子测试是否通过。
+    bool passed(size_t id) const {
+        size_t slot = id & (BLOCK_SIZE - 1);
+        return (blockOf(id).passBits[slot >> 6].load(std::memory_order_relaxed) >> (slot & 63)) & 1;
+    }
+
+    /// @brief 记录对应的叶子测试结果是否来自 `ResultCache`。
+    bool isCached(size_t id) const {
+        size_t slot = id & (BLOCK_SIZE - 1);
+        return (blockOf(id).cachedBits[slot >> 6].load(std::memory_order_relaxed) >> (slot & 63)) & 1;
+    }
+
+    /// @brief 记录对应的叶子测试运行时间。
+    uint64_t runTime(size_t id) const { return blockOf(id).runTime[id & (BLOCK_SIZE - 1)]; }
+
+    /// @brief 记录对应的叶子测试索引号。
+    uint32_t testIndex(size_t id) const { return blockOf(id).testIndex[id & (BLOCK_SIZE - 1)]; }
+
+    /**
+     * @brief 统计一段连续记录中已完成和失败的数量。
+     *
+     * 按 64 位一组直接统计标记位，开销与记录数量的 1/64 成正比，适合进度显示等频繁调用的场景。
+     *
+     * @param begin 起始记录编号。
+     * @param end 结束记录编号（不包含）。
+     * @param done 累加已完成的记录数量。
+     * @param failed 累加已完成但未通过的记录数量。
+     */
+    void countRange(size_t begin, size_t end, size_t& done, size_t& failed) const {
+        size_t id = begin;
+        while (id < end)
+        {
+            const Block& block = blockOf(id);
+            size_t slot = id & (BLOCK_SIZE - 1);
+            size_t bit = slot & 63;
+            size_t width = end - id < 64 - bit ? end - id : 64 - bit;
+            uint64_t mask = (width == 64 ? ~uint64_t(0) : ((uint64_t(1) << width) - 1)) << bit;
+            uint64_t doneWord = block.doneBits[slot >> 6].load(std::memory_order_acquire) & mask;
+            uint64_t passWord = block.passBits[slot >> 6].load(std::memory_order_relaxed) & mask;
+            done += __builtin_popcountll(doneWord);
+            failed += __builtin_popcountll(doneWord & ~passWord);
+            id += width;
+        }
+    }
+
+    /// @brief 生成记录对应的所有错误信息（不带样式）。
+    std::vector<std::string> errors(size_t id) const {
+        std::vector<std::string> result;
+        const Block& block = blockOf(id);
+        size_t slot = id & (BLOCK_SIZE - 1);
+        std::lock_guard<std::mutex> guard(errorLock);
+        for (uint32_t i = 0; i < block.errorCount[slot]; i++)
+        {
+            result.push_back(formatAssertion(failureRecords[block.errorOffset[slot] + i], failureText));
+        }
+        return result;
+    }
+
+private:
+    struct Block {
+        std::array<std::atomic<uint64_t>, BLOCK_SIZE / 64> doneBits{};
+        std::array<std::atomic<uint64_t>, BLOCK_SIZE / 64> passBits{};
+        std::array<std::atomic<uint64_t>, BLOCK_SIZE / 64> cachedBits{};
+        uint64_t runTime[BLOCK_SIZE];
+        uint32_t testIndex[BLOCK_SIZE];
+        uint32_t errorOffset[BLOCK_SIZE];
+        uint32_t errorCount[BLOCK_SIZE];
+    };
+
+    Block& blockOf(size_t id) const { return *blocks[id >> BLOCK_BITS]; }
+
+    mutable std::mutex storeLock;
+    std::array<Block*, MAX_BLOCKS> blocks{};
+    size_t blockCount = 0;
+    size_t recordCount = 0;
+
+    mutable std::mutex errorLock;
+    std::string failureText;
+    std::vector<AssertionRecord> failureRecords;
+};
+
+/**
+ * @brief 指向 `ResultStore` 中一段连续叶子记录的视图。
+ *
+ * 叶子节点的父节点通过此视图访问它的全部子测试结果，视图本身的拷贝开销与叶子数量无关。
+ */
+class LeafRange {
+public:
+    LeafRange() {}
+
+    /// @brief 构造函数。
+    /// @param store 叶子记录所在的存储。
+    /// @param count 视图包含的记录数量，会立即在存储中预留。
+    LeafRange(std::shared_ptr<ResultStore> store, size_t count) : store(std::move(store)), count(count) {
+        base = this->store->reserve(count);
+    }
+
+    /// @brief 视图是否有效。
+    bool valid() const { return store != nullptr; }
+
+    /// @brief 视图包含的记录数量。
+    size_t size() const { return count; }
+
+    /// @brief 第 index 条记录在存储中的编号。
+    size_t id(size_t index) const { return base + index; }
+
+    /// @brief 视图所属的存储。
+    ResultStore& records() const { return *store; }
+
+private:
+    std::shared_ptr<ResultStore> store;
+    size_t base = 0;
+    size_t count = 0;
+};
+
+#endif
@@ -0,0 +1,427 @@
+#ifndef SCHEMA_H
+#define SCHEMA_H
+#include <array>
+#include <iterator>
+#include <memory>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include <FuzzTestSchema.h>
+
+/**
+ * 编译期声明的测试层级。
+ *
+ * `TestDriverClass`/`TestContainerClass`/`TestExecutorClass` 在运行时通过 `isParentOfLeaf` 和 `TestResult::isLeaf` 区分各层的行为，
+ * 而 `Schema<Driver, ContainerLevel<Group>, ExecutorLevel<Case>>` 在编译期声明整棵测试树的形状：
+ * 每一层是叶子节点的父节点、普通容器还是叶子，都由 `if constexpr` 在编译期决定，运行时没有按节点类型的分支。
+ * 每一层的输入类型由上一层的元素类型推导，类型不匹配会在编译期报错。
+ *
+ * `runSchemaLeaf` 和 `runSchemaContainer` 也被类型化测试模板（见 `TypedTest.h`）使用。
+ */
+
+/**
+ * @brief 在编译期已知的元素数量。
+ *
+ * `std::array` 和内置数组的元素数量在编译期已知，其余区间为 0，即只能在运行时得到。
+ */
+template <typename Range>
+struct StaticExtent : std::integral_constant<size_t, 0> {};
+
+template <typename T, size_t N>
+struct StaticExtent<std::array<T, N>> : std::integral_constant<size_t, N> {};
+
+template <typename T, size_t N>
+struct StaticExtent<T[N]> : std::integral_constant<size_t, N> {};
+
+/**
+ * @brief 按索引访问区间中的元素。
+ *
+ * 子测试按索引调度（并行时以任意顺序），而 `std::next(first, index)` 对非随机访问的区间（例如 `std::list`、`std::map`）
+ * 是 O(index) 的，整个容器会退化为 O(n²)。随机访问区间直接计算位置；其他区间在构造时遍历一次，保存每个元素的迭代器。
+ */
+template <typename Range>
+class IndexedElements {
+public:
+    using Iterator = decltype(std::begin(std::declval<const Range&>()));
+    static constexpr bool RANDOM_ACCESS = std::is_base_of<std::random_access_iterator_tag, typename std::iterator_traits<Iterator>::iterator_category>::value;
+
+    explicit IndexedElements(const Range& range) : first(std::begin(range)) {
+        if constexpr (!RANDOM_ACCESS)
+        {
+            for (auto it = std::begin(range); it != std::end(range); ++it)
+            {
+                iterators.push_back(it);
+            }
+        }
+    }
+
+    /// @brief 第 index 个元素。
+    decltype(auto) operator[](size_t index) const {
+        if constexpr (RANDOM_ACCESS)
+        {
+            return *(first + static_cast<std::ptrdiff_t>(index));
+        }
+        else
+        {
+            return *iterators[index];
+        }
+    }
+
+private:
+    Iterator first;
+    std::vector<Iterator> iterators;
+};
+
+/// @brief 子测试数量不超过此值时，非叶子子测试的结果可以保存在栈上的 `std::array` 中。
+static constexpr size_t SCHEMA_MAX_ARRAY_EXTENT = 64;
+
+/**
+ * @brief 执行一个叶子测试。
+ *
+ * 负责计时、性能计数器、内存分配统计和看门狗，实际的断言由 body 完成。
+ *
+ * @param testIndex 叶子测试的索引号。
+ * @param body 以 `void(TestResult&)` 的形式调用的测试体。
+ * @return 返回叶子测试结果。
+ */
+template <typename Body>
+TestResult runSchemaLeaf(size_t testIndex, Body&& body) {
+    TestResult result;
+    result.isLeaf = true;
+    result.testIndex = static_cast<u_int32_t>(testIndex);
+    Watchdog::Watch watch(WatchKind::LEAF, [&] { return "test " + std::to_string(testIndex); });
+    PerfSample counterStart = PerfCounters::start();
+    AllocationTracker::Snapshot allocationStart = AllocationTracker::start();
+    START_TIMER;
+    body(result);
+    result.runTime = FINISH_TIMER;
+    AllocationTracker::finish(allocationStart, result.allocations);
+    PerfCounters::finish(counterStart, result.counters);
+    if (watch.finish())
+    {
+        result.recordTimeout(watch);
+    }
+    return result;
+}
+
+/**
+ * @brief 容器的公共部分：看门狗、计时、常驻内存，以及结束时的汇总或报告。
+ *
+ * @tparam IsParentOfLeaf 子测试是否为叶子。
+ * @param count 子测试数量。
+ * @param fullName 容器的完整名称。
+ * @param schedule 以 `void(TestResult&)` 的形式调用，负责执行所有子测试并追加结果。
+ * @return 返回容器的测试结果。
+ */
+template <bool IsParentOfLeaf, typename Schedule>
+TestResult runSchemaFrame(size_t count, const NameType& fullName, Schedule&& schedule) {
+    Watchdog::Watch watch(WatchKind::CONTAINER, [&] { return "container " + fullName; });
+    uint64_t residentStart = AllocationTracker::isEnabled() ? AllocationTracker::residentBytes() : 0;
+    START_TIMER;
+    TestResult result(count, IsParentOfLeaf, fullName);
+    schedule(result);
+    result.runTime = FINISH_TIMER;
+    if (AllocationTracker::isEnabled())
+    {
+        result.allocations.residentStart = residentStart;
+        result.allocations.residentEnd = AllocationTracker::residentBytes();
+    }
+    if (watch.finish())
+    {
+        result.recordTimeout(watch);
+    }
+    if constexpr (IsParentOfLeaf)
+    {
+        result.finishSubtestBatch();
+    }
+    else
+    {
+        result.reportContainer(fullName);
+    }
+    return result;
+}
+
+/**
+ * @brief 执行一个层级在编译期已知的容器。
+ *
+ * 叶子节点的父节点按分片调度叶子、把叶子结果写入 `ResultStore` 并在结束时输出汇总；
+ * 其余容器在结束时写入报告。子测试数量在编译期已知且不超过 `SCHEMA_MAX_ARRAY_EXTENT` 时，
+ * 非叶子子测试的结果先保存在 `std::array` 中，全部完成后再按顺序追加，执行期间无需加锁排序。
+ *
+ * @tparam IsParentOfLeaf 子测试是否为叶子。
+ * @tparam Extent 编译期已知的子测试数量，未知时为 0。
+ * @param count 子测试数量。
+ * @param fullName 容器的完整名称。
+ * @param runChild 以 `TestResult(size_t index)` 的形式调用，执行第 index 个子测试。
+ * @return 返回容器的测试结果。
+ */
+template <bool IsParentOfLeaf, size_t Extent, typename RunChild>
+TestResult runSchemaContainer(size_t count, const NameType& fullName, RunChild&& runChild) {
+    return runSchemaFrame<IsParentOfLeaf>(count, fullName, [&](TestResult& result) {
+        if constexpr (IsParentOfLeaf)
+        {
+            // 分片时只调度属于当前分片的叶子
+            ShardFilter filter = Sharding::filter(fullName);
+            size_t scheduled = filter.ownedCount(count);
+            result.otherShardCount = static_cast<ssize_t>(count - scheduled);
+            parallelFor(TestScheduler::pool(), scheduled, [&](size_t k) {
+                size_t index = filter.leaf(k);
+                if (Watchdog::shouldStop())
+                {
+                    result.skipSubTest();
+                    return;
+                }
+                TestResult leaf = runChild(index);
+                leaf.testIndex = static_cast<u_int32_t>(index);
+                result.appendLeafResult(std::move(leaf));
+            });
+        }
+        else if constexpr (Extent != 0 && Extent <= SCHEMA_MAX_ARRAY_EXTENT)
+        {
+            std::array<TestResult, Extent> children;
+            std::array<bool, Extent> finished{};
+            parallelFor(TestScheduler::pool(), Extent, [&](size_t index) {
+                if (Watchdog::shouldStop())
+                {
+                    return;
+                }
+                children[index] = runChild(index);
+                children[index].testIndex = static_cast<u_int32_t>(index);
+                finished[index] = true;
+            });
+            for (size_t index = 0; index < Extent; index++)
+            {
+                if (finished[index])
+                {
+                    result.appendContainerResult(std::move(children[index]));
+                }
+                else
+                {
+                    result.skipSubTest();
+                }
+            }
+        }
+        else
+        {
+            parallelFor(TestScheduler::pool(), count, [&](size_t index) {
+                if (Watchdog::shouldStop())
+                {
+                    result.skipSubTest();
+                    return;
+                }
+                TestResult child = runChild(index);
+                child.testIndex = static_cast<u_int32_t>(index);
+                result.appendContainerResult(std::move(child));
+            });
+        }
+    });
+}
+
+/**
+ * @brief 声明一个容器层级。
+ *
+ * Group 可以按需提供以下函数（均为可选）：
+ * - `Elements(const Input& input)`：返回需要遍历的元素区间，默认为输入本身。
+ * - `NameType Name(const Input& input)`：返回当前测试集的名称，默认为空。
+ *
+ * @tparam Group 容器层级的策略类型。
+ */
+template <typename Group>
+struct ContainerLevel {
+    using Policy = Group;
+};
+
+/**
+ * @brief 声明叶子层级。
+ *
+ * Case 需要提供 `void RunTest(const Input& input, TestResult& result)`，其中通过 `result.assert...` 进行断言；
+ * 也可以改为提供 `void RunBatch(Span<const Input> inputs, BatchResult& result)`，上一层的元素区间连续（例如 `std::vector`）时
+ * 叶子以批的方式执行，见 `runLeafBatches`。
+ *
+ * @tparam Case 叶子层级的策略类型。
+ */
+template <typename Case>
+struct ExecutorLevel {
+    using Policy = Case;
+};
+
+template <typename T>
+struct IsContainerLevel : std::false_type {};
+
+template <typename Group>
+struct IsContainerLevel<ContainerLevel<Group>> : std::true_type {};
+
+template <typename T>
+struct IsExecutorLevel : std::false_type {};
+
+template <typename Case>
+struct IsExecutorLevel<ExecutorLevel<Case>> : std::true_type {};
+
+/// @brief 判断策略类型是否提供 `Elements(const Input&)`。
+template <typename Policy, typename Input, typename = void>
+struct HasElements : std::false_type {};
+
+template <typename Policy, typename Input>
+struct HasElements<Policy, Input, std::void_t<decltype(std::declval<Policy&>().Elements(std::declval<const Input&>()))>> : std::true_type {};
+
+/// @brief 判断策略类型是否提供 `Name(const Input&)`。
+template <typename Policy, typename Input, typename = void>
+struct HasName : std::false_type {};
+
+template <typename Policy, typename Input>
+struct HasName<Policy, Input, std::void_t<decltype(std::declval<Policy&>().Name(std::declval<const Input&>()))>> : std::true_type {};
+
+/// @brief 判断策略类型是否提供 `TearDown(Data&)`。
+template <typename Policy, typename Data, typename = void>
+struct HasTearDown : std::false_type {};
+
+template <typename Policy, typename Data>
+struct HasTearDown<Policy, Data, std::void_t<decltype(std::declval<Policy&>().TearDown(std::declval<Data&>()))>> : std::true_type {};
+
+/// @brief 判断策略类型是否提供 `RunBatch(Span<const Input>, BatchResult&)`，且元素区间是连续的。
+template <typename Policy, typename Range, typename = void>
+struct HasRunBatch : std::false_type {};
+
+template <typename Policy, typename Range>
+struct HasRunBatch<Policy, Range,
+                   std::void_t<decltype(std::data(std::declval<const Range&>())),
+                               decltype(std::declval<Policy&>().RunBatch(std::declval<Span<const std::remove_pointer_t<decltype(std::data(std::declval<const Range&>()))>>>(),
+                                                                          std::declval<BatchResult&>()))>> : std::true_type {};
+
+/**
+ * @brief 编译期声明的测试树。
+ *
+ * Driver 需要提供 `Data SetUp()`，并可以按需提供 `void TearDown(Data& data)` 以及与 `ContainerLevel` 相同的 `Elements` 和 `Name`。
+ * Levels 是若干个 `ContainerLevel` 和最后一个 `ExecutorLevel`。与 `TestDriverClass` 一样，执行期间 `Schema` 持有下层所有叶子结果的存储。
+ * 各层的策略对象由 `Schema` 持有，并行执行时同一层的函数会在多个线程中同时被调用。
+ *
+ * 示例：
+ * ```cpp
+ * struct Suite
+ * {
+ *     DriverType SetUp() { return generateData(); }
+ *     const DriverDatatype& Elements(const DriverType& data) { return data.first; }
+ * };
+ * struct Group
+ * {
+ *     const ContainerDatatype& Elements(const ContainerType& group) { return group.first; }
+ *     NameType Name(const ContainerType& group) { return group.second; }
+ * };
+ * struct Case
+ * {
+ *     void RunTest(const std::string& input, TestResult& result) { result.assertNE("string length", input.length(), size_t(0)); }
+ * };
+ *
+ * Schema<Suite, ContainerLevel<Group>, ExecutorLevel<Case>> schema;
+ * schema.ProceedTest("ShowCase");
+ * ```
+ *
+ * @tparam Driver 驱动层级的策略类型。
+ * @tparam Levels 下层各层级的声明。
+ */
+template <typename Driver, typename... Levels>
+class Schema {
+    static_assert(sizeof...(Levels) >= 1, "Schema: at least an ExecutorLevel is required");
+
+    /// @brief 叶子层级的深度，驱动层级的深度为 0。
+    static constexpr size_t LEAF_DEPTH = sizeof...(Levels);
+
+    using LevelList = std::tuple<Levels...>;
+
+    template <size_t... I>
+    static constexpr bool containersBeforeLeaf(std::index_sequence<I...>) {
+        return (IsContainerLevel<std::tuple_element_t<I, LevelList>>::value && ...);
+    }
+
+    static_assert(containersBeforeLeaf(std::make_index_sequence<LEAF_DEPTH - 1>()), "Schema: every level but the last must be a ContainerLevel");
+    static_assert(IsExecutorLevel<std::tuple_element_t<LEAF_DEPTH - 1, LevelList>>::value, "Schema: the last level must be an ExecutorLevel");
+
+public:
+    using Data = std::decay_t<decltype(std::declval<Driver&>().SetUp())>;
+
+    Schema() = default;
+
+    /// @brief 使用给定的策略对象构造。
+    explicit Schema(Driver driver, typename Levels::Policy... policies) : policies(std::move(driver), std::move(policies)...) {}
+
+    /// @brief 执行测试。
+    /// @param testName 测试的名称。
+    /// @return 返回测试结果。
+    TestResult ProceedTest(NameType testName) {
+        Driver& driver = std::get<0>(policies);
+        TestContext context = TestContext::current();
+        context.resultStore = std::make_shared<ResultStore>();
+        TestContext::Scope scope(context);
+        Data data = driver.SetUp();
+        TestResult result;
+        {
+            ForkServer::Session isolation;
+            result = RunLevel<0>(data, testName);
+        }
+        if constexpr (HasTearDown<Driver, Data>::value)
+        {
+            driver.TearDown(data);
+        }
+        return result;
+    }
+
+private:
+    template <typename Policy, typename Input>
+    static decltype(auto) ElementsOf(Policy& policy, const Input& input) {
+        if constexpr (HasElements<Policy, Input>::value)
+        {
+            return policy.Elements(input);
+        }
+        else
+        {
+            return (input);
+        }
+    }
+
+    template <size_t Depth, typename Input>
+    TestResult RunLevel(const Input& input, const NameType& testName) {
+        auto& policy = std::get<Depth>(policies);
+        using Policy = std::decay_t<decltype(policy)>;
+        const auto& elements = ElementsOf(policy, input);
+        constexpr size_t extent = StaticExtent<std::decay_t<decltype(elements)>>::value;
+        size_t count = extent != 0 ? extent : static_cast<size_t>(std::distance(std::begin(elements), std::end(elements)));
+        NameType subTestName;
+        if constexpr (HasName<Policy, Input>::value)
+        {
+            subTestName = policy.Name(input);
+        }
+        NameType fullName = subTestName.empty() ? testName : testName + "." + subTestName;
+
+        if constexpr (Depth + 1 == LEAF_DEPTH && HasRunBatch<std::tuple_element_t<LEAF_DEPTH, decltype(policies)>, std::decay_t<decltype(elements)>>::value)
+        {
+            // 叶子层级提供了 RunBatch，叶子以批的方式执行
+            using ElementType = std::remove_pointer_t<decltype(std::data(elements))>;
+            auto& leafPolicy = std::get<LEAF_DEPTH>(policies);
+            return runSchemaFrame<true>(count, fullName, [&](TestResult& result) {
+                runLeafBatches(result, Span<const ElementType>(std::data(elements), count), DEFAULT_BATCH_SIZE,
+                               [&](Span<const ElementType> batch, BatchResult& batchResult) { leafPolicy.RunBatch(batch, batchResult); });
+            });
+        }
+        else
+        {
+            IndexedElements<std::decay_t<decltype(elements)>> indexed(elements);
+            return runSchemaContainer<Depth + 1 == LEAF_DEPTH, extent>(count, fullName, [&](size_t index) {
+                const auto& element = indexed[index];
+                if constexpr (Depth + 1 == LEAF_DEPTH)
+                {
+                    auto& leafPolicy = std::get<LEAF_DEPTH>(policies);
+                    return runSchemaLeaf(index, [&](TestResult& result) { leafPolicy.RunTest(element, result); });
+                }
+                else
+                {
+                    return RunLevel<Depth + 1>(element, fullName);
+                }
+            });
+        }
+    }
+
+    std::tuple<Driver, typename Levels::Policy...> policies;
+};
+
+#endif
@@ -0,0 +1,451 @@
+#ifndef SHARDING_H
+#define SHARDING_H
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <TestResult.h>
+#include <InputFiles.h>
+
+/**
+ * @brief 一个叶子节点的父节点在当前分片中的叶子。
+ *
+ * 第 i 个叶子属于第 `(i + offset) % count` 个分片，其中 offset 由容器名称的哈希值决定。
+ * 因此每个分片分到每个容器中 ⌊n/count⌋ 或 ⌈n/count⌉ 个叶子，同一容器中各个叶子的开销相近，
+ * 不同分片的总开销自然是均衡的；余下的叶子按容器名称错开，不会总是落在前几个分片上。
+ */
+struct ShardFilter {
+    size_t index = 0;
+    size_t count = 1;
+    size_t offset = 0;
+
+    /// @brief 第 testIndex 个叶子是否属于当前分片。
+    bool owns(size_t testIndex) const { return count <= 1 || (testIndex + offset) % count == index; }
+
+    /// @brief 共 leafCount 个叶子时，属于当前分片的叶子数量。
+    size_t ownedCount(size_t leafCount) const {
+        size_t begin = first();
+        return begin >= leafCount ? 0 : (leafCount - begin - 1) / count + 1;
+    }
+
+    /// @brief 属于当前分片的第 k 个叶子的 `testIndex`。
+    size_t leaf(size_t k) const { return first() + k * count; }
+
+private:
+    /// @brief 属于当前分片的第一个叶子的 `testIndex`。
+    size_t first() const { return count <= 1 ? 0 : (index + count - offset) % count; }
+};
+
+/**
+ * @brief 在多个进程或多台机器之间划分叶子测试。
+ *
+ * 每个分片都完整地执行驱动类的 `SetUp()` 并遍历整棵测试树，但在叶子节点的父节点中只执行属于自己的叶子（见 `ShardFilter`）。
+ * 划分只取决于容器名称和 `testIndex`，与线程数、执行顺序和机器无关，因此同一个叶子总是由同一个分片执行。
+ *
+ * 分片参数可以通过命令行 `--shard-index <i> --shard-count <n>` 或环境变量
+ * `FUZZ_TEST_SHARD_INDEX` 和 `FUZZ_TEST_SHARD_COUNT` 指定，命令行优先。
+ * 每个分片用 `writePartialResults` 写入部分结果文件，再由 `ShardMerger`（即 `FuzzTestSchemaShardMerge` 工具）合并。
+ *
+ * 示例：
+ * ```cpp
+ * Sharding::configure(argc, argv);
+ * Sharding::writePartialResults("shard-" + std::to_string(Sharding::config().index) + ".txt");
+ * rootClass.ProceedTest("ShowCase");
+ * ResultReporter::instance().close();
+ * ```
+ */
+class Sharding {
+public:
+    /// @brief 分片参数。
+    struct Config {
+        size_t index = 0;
+        size_t count = 1;
+    };
+
+    /**
+     * @brief 设置分片参数。
+     *
+     * 参数不合法时抛出 `std::invalid_argument`。
+     */
+    static void configure(size_t index, size_t count) {
+        if (count == 0 || index >= count)
+        {
+            throw std::invalid_argument("Sharding: shard index " + std::to_string(index) + " is out of range for " + std::to_string(count) + " shards");
+        }
+        storage().index = index;
+        storage().count = count;
+    }
+
+    /**
+     * @brief 从环境变量和命令行读取分片参数。
+     *
+     * 都没有指定时不分片。参数不合法时抛出 `std::invalid_argument`。
+     */
+    static void configure(int argc, char** argv) {
+        Config config = storage();
+        const char* index = std::getenv("FUZZ_TEST_SHARD_INDEX");
+        const char* count = std::getenv("FUZZ_TEST_SHARD_COUNT");
+        if (index != nullptr && count != nullptr)
+        {
+            config.index = parse(index);
+            config.count = parse(count);
+        }
+        for (int i = 1; i + 1 < argc; i++)
+        {
+            if (std::string(argv[i]) == "--shard-index")
+            {
+                config.index = parse(argv[i + 1]);
+            }
+            else if (std::string(argv[i]) == "--shard-count")
+            {
+                config.count = parse(argv[i + 1]);
+            }
+        }
+        configure(config.index, config.count);
+    }
+
+    /// @brief 当前的分片参数。
+    static const Config& config() { return storage(); }
+
+    /// @brief 是否分为多于一个分片。
+    static bool isActive() { return storage().count > 1; }
+
+    /// @brief 名为 containerName 的叶子节点的父节点在当前分片中的叶子。
+    static ShardFilter filter(const std::string& containerName) {
+        ShardFilter filter;
+        filter.index = storage().index;
+        filter.count = storage().count;
+        filter.offset = filter.count <= 1 ? 0 : static_cast<size_t>(fnv1aHash(containerName) % filter.count);
+        return filter;
+    }
+
+    /**
+     * @brief 将当前分片的结果写入部分结果文件。
+     *
+     * 文件无法打开时抛出 `std::runtime_error`。写入在 `ResultReporter::instance().close()` 时完成。
+     */
+    static void writePartialResults(const std::string& path);
+
+private:
+    static Config& storage() {
+        static Config config;
+        return config;
+    }
+
+    static size_t parse(const std::string& text) {
+        size_t end = 0;
+        unsigned long long value = 0;
+        try
+        {
+            value = std::stoull(text, &end);
+        }
+        catch (const std::exception&)
+        {
+            end = 0;
+        }
+        if (end == 0 || end != text.size())
+        {
+            throw std::invalid_argument("Sharding: invalid shard number \"" + text + "\"");
+        }
+        return static_cast<size_t>(value);
+    }
+};
+
+/**
+ * @brief 部分结果文件的格式。
+ *
+ * 文本格式，每行以一个字母开头，字段之间以制表符分隔，字段中的反斜杠、制表符和换行符被转义：
+ * ```
+ * FUZZ_TEST_SCHEMA_SHARD<TAB>1<TAB>分片索引<TAB>分片数量
+ * C<TAB>容器名称<TAB>叶子总数          叶子节点的父节点
+ * L<TAB>testIndex<TAB>P、F 或 C（来自缓存）<TAB>纳秒  本分片执行的叶子
+ * E<TAB>错误信息                      上一个叶子的错误信息
+ * X<TAB>错误信息                      容器自身的错误信息
+ * ```
+ */
+struct ShardFileFormat {
+    static constexpr const char* MAGIC = "FUZZ_TEST_SCHEMA_SHARD";
+    static constexpr int VERSION = 1;
+
+    static std::string escape(const std::string& text) {
+        std::string escaped;
+        escaped.reserve(text.size());
+        for (char c : text)
+        {
+            switch (c)
+            {
+            case '\\': escaped += "\\\\"; break;
+            case '\t': escaped += "\\t"; break;
+            case '\n': escaped += "\\n"; break;
+            case '\r': escaped += "\\r"; break;
+            default: escaped += c;
+            }
+        }
+        return escaped;
+    }
+
+    static std::string unescape(const std::string& text) {
+        std::string plain;
+        plain.reserve(text.size());
+        for (size_t i = 0; i < text.size(); i++)
+        {
+            if (text[i] != '\\' || i + 1 == text.size())
+            {
+                plain += text[i];
+                continue;
+            }
+            char c = text[++i];
+            plain += c == 't' ? '\t' : (c == 'n' ? '\n' : (c == 'r' ? '\r' : c));
+        }
+        return plain;
+    }
+
+    static std::vector<std::string> split(const std::string& line) {
+        std::vector<std::string> fields;
+        size_t begin = 0;
+        for (size_t end = line.find('\t'); end != std::string::npos; end = line.find('\t', begin))
+        {
+            fields.push_back(line.substr(begin, end - begin));
+            begin = end + 1;
+        }
+        fields.push_back(line.substr(begin));
+        return fields;
+    }
+};
+
+/**
+ * @brief 写入部分结果文件的报告格式。
+ *
+ * 只写入叶子节点的父节点（名称、子测试数量和容器本身的错误信息）和本分片实际执行的叶子（通过与否、运行时间和错误信息）。
+ * 驱动类和中间层的容器不写入，因此合并后的结果中没有它们；性能计数器、内存分配和 A/B 比较的数据同样不写入。
+ */
+class ShardFileWriter : public ResultWriter {
+public:
+    ShardFileWriter(const std::string& path, const Sharding::Config& config) : out(path) {
+        out.append(ShardFileFormat::MAGIC);
+        out.append('\t');
+        out.appendNumber(ShardFileFormat::VERSION);
+        out.append('\t');
+        out.appendNumber(config.index);
+        out.append('\t');
+        out.appendNumber(config.count);
+        out.append('\n');
+    }
+
+    void beginContainer(const ContainerReport& container) override {
+        if (!container.isParentOfLeaf)
+        {
+            return;
+        }
+        out.append("C\t");
+        out.append(ShardFileFormat::escape(container.name));
+        out.append('\t');
+        out.appendNumber(container.total);
+        out.append('\n');
+        for (const auto& error : container.errors)
+        {
+            out.append("X\t");
+            out.append(ShardFileFormat::escape(error));
+            out.append('\n');
+        }
+    }
+
+    void writeLeaf(const ContainerReport& container, const LeafReport& leaf) override {
+        if (!container.isParentOfLeaf || leaf.status == LeafReport::Status::SKIPPED)
+        {
+            return;
+        }
+        out.append("L\t");
+        out.appendNumber(leaf.testIndex);
+        out.append(leaf.status == LeafReport::Status::PASSED ? "\tP\t" : (leaf.status == LeafReport::Status::CACHED ? "\tC\t" : "\tF\t"));
+        out.appendNumber(leaf.runTime);
+        out.append('\n');
+        for (const auto& error : leaf.errors)
+        {
+            out.append("E\t");
+            out.append(ShardFileFormat::escape(error));
+            out.append('\n');
+        }
+    }
+
+    void endContainer(const ContainerReport& container) override { (void)container; }
+
+    void close() override { out.flush(); }
+
+private:
+    BufferedWriter out;
+};
+
+inline void Sharding::writePartialResults(const std::string& path) {
+    ResultReporter::instance().addWriter(std::unique_ptr<ResultWriter>(new ShardFileWriter(path, config())));
+}
+
+/**
+ * @brief 合并各个分片的部分结果。
+ *
+ * 对每个叶子节点的父节点，把所有分片中的叶子依次追加到一个新的 `TestResult` 中，再调用 `finishSubtestBatch`，
+ * 因此这些容器的通过与失败、运行时间直方图、控制台汇总以及 `ResultReporter` 中的记录都与在单个进程中执行时相同。
+ * 部分结果文件中没有驱动类和中间层的容器，合并后的报告只包含叶子节点的父节点。
+ * 任何分片中都没有出现的叶子计为跳过。
+ *
+ * 示例：
+ * ```cpp
+ * ShardMerger merger;
+ * merger.load("shard-0.txt");
+ * merger.load("shard-1.txt");
+ * return merger.merge();
+ * ```
+ */
+class ShardMerger {
+public:
+    /**
+     * @brief 载入一个部分结果文件。
+     *
+     * 文件无法打开、格式不正确、分片数量不一致或同一个分片重复出现时抛出 `std::runtime_error`。
+     */
+    void load(const std::string& path) {
+        std::ifstream file(path);
+        std::string line;
+        if (!file || !std::getline(file, line))
+        {
+            throw std::runtime_error("ShardMerger: cannot read " + path);
+        }
+        std::vector<std::string> header = ShardFileFormat::split(line);
+        if (header.size() != 4 || header[0] != ShardFileFormat::MAGIC || header[1] != std::to_string(ShardFileFormat::VERSION))
+        {
+            throw std::runtime_error("ShardMerger: " + path + " is not a partial result file");
+        }
+        size_t index = std::stoull(header[2]);
+        size_t count = std::stoull(header[3]);
+        if (shardCount != 0 && count != shardCount)
+        {
+            throw std::runtime_error("ShardMerger: " + path + " belongs to a run with " + header[3] + " shards, expected " + std::to_string(shardCount));
+        }
+        shardCount = count;
+        if (index >= count || !loadedShards.insert(index).second)
+        {
+            throw std::runtime_error("ShardMerger: shard " + header[2] + " in " + path + " is invalid or was already loaded");
+        }
+
+        Container* container = nullptr;
+        Leaf* leaf = nullptr;
+        while (std::getline(file, line))
+        {
+            std::vector<std::string> fields = ShardFileFormat::split(line);
+            if (fields[0] == "C" && fields.size() == 3)
+            {
+                container = &find(ShardFileFormat::unescape(fields[1]));
+                container->total = std::stoull(fields[2]);
+                leaf = nullptr;
+            }
+            else if (fields[0] == "X" && fields.size() == 2 && container != nullptr)
+            {
+                container->errors.push_back(ShardFileFormat::unescape(fields[1]));
+            }
+            else if (fields[0] == "L" && fields.size() == 4 && container != nullptr)
+            {
+                container->leaves.emplace_back();
+                leaf = &container->leaves.back();
+                leaf->testIndex = static_cast<uint32_t>(std::stoul(fields[1]));
+                leaf->passed = fields[2] == "P" || fields[2] == "C";
+                leaf->cached = fields[2] == "C";
+                leaf->runTime = std::stoull(fields[3]);
+            }
+            else if (fields[0] == "E" && fields.size() == 2 && leaf != nullptr)
+            {
+                leaf->errors.push_back(ShardFileFormat::unescape(fields[1]));
+            }
+            else
+            {
+                throw std::runtime_error("ShardMerger: invalid line in " + path + ": " + line);
+            }
+        }
+    }
+
+    /// @brief 缺少的分片数量。
+    size_t missingShards() const { return shardCount - loadedShards.size(); }
+
+    /**
+     * @brief 合并并输出所有容器的结果。
+     *
+     * @return 返回进程的退出码：有失败的测试或缺少分片时返回 1，否则返回 0。
+     */
+    int merge() {
+        bool passed = missingShards() == 0;
+        if (!passed)
+        {
+            printStyledText("Merged " + std::to_string(loadedShards.size()) + " of " + std::to_string(shardCount) + " shards, results are incomplete",
+                            TextColor::YELLOW, TextStyle::BOLD, true);
+        }
+        TestContext context = TestContext::current();
+        context.resultStore = std::make_shared<ResultStore>();
+        TestContext::Scope scope(context);
+        for (Container& container : containers)
+        {
+            TestResult result(static_cast<ssize_t>(container.total), true, container.name);
+            for (const Leaf& leaf : container.leaves)
+            {
+                TestResult leafResult;
+                leafResult.isLeaf = true;
+                leafResult.testIndex = leaf.testIndex;
+                leafResult.success = leaf.passed;
+                leafResult.cached = leaf.cached;
+                leafResult.failedCount = leaf.passed ? 0 : 1;
+                leafResult.runTime = leaf.runTime;
+                leafResult.errorInfo = leaf.errors;
+                result.appendSubTestResult(std::move(leafResult));
+            }
+            result.skippedCount = static_cast<ssize_t>(container.total) - result.finishedCount;
+            for (const auto& error : container.errors)
+            {
+                result.errorInfo.push_back(error);
+                result.success = false;
+            }
+            result.finishSubtestBatch();
+            passed = passed && result.success;
+        }
+        return passed ? 0 : 1;
+    }
+
+private:
+    struct Leaf {
+        uint32_t testIndex = 0;
+        bool passed = true;
+        bool cached = false;
+        uint64_t runTime = 0;
+        std::vector<std::string> errors;
+    };
+
+    struct Container {
+        std::string name;
+        uint64_t total = 0;
+        std::vector<Leaf> leaves;
+        std::vector<std::string> errors;
+    };
+
+    size_t shardCount = 0;
+    std::set<size_t> loadedShards;
+
+    /// @brief 按第一次出现的顺序保存的容器，`containerIndex` 用于按名称查找。
+    std::vector<Container> containers;
+    std::map<std::string, size_t> containerIndex;
+
+    Container& find(const std::string& name) {
+        auto found = containerIndex.find(name);
+        if (found != containerIndex.end())
+        {
+            return containers[found->second];
+        }
+        containerIndex.emplace(name, containers.size());
+        containers.emplace_back();
+        containers.back().name = name;
+        return containers.back();
+    }
+};
+
+#endif
@@ -0,0 +1,152 @@
+#ifndef SHARED_FIXTURE_H
+#define SHARED_FIXTURE_H
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <utility>
+
+/**
+ * @brief 在多个驱动类之间共享的测试夹具。
+ *
+ * 测试图中的多个驱动类（例如同一个分组下的兄弟驱动类）常常需要同一份构造代价很高的数据。
+ * 每个驱动类在构造时通过 `share()` 取得一个 `Handle`，即登记为一个使用者；
+ * 第一个调用 `Handle::get()` 的使用者构造夹具，其余使用者等待构造完成后直接使用同一份数据；
+ * 最后一个使用者调用 `Handle::release()`（或 `Handle` 被析构）时清理夹具。
+ * 因此无论驱动类是先后执行还是并行执行，夹具都只构造一次，并在不再需要时立即释放。
+ *
+ * 夹具构造完成后可能在多个线程中同时被读取，使用者不应修改它。
+ *
+ * 示例：
+ * ```cpp
+ * SharedFixture<Dataset> dataset([] { return std::unique_ptr<Dataset>(new Dataset(loadDataset())); });
+ *
+ * class RegionDriverClass : public TestDriverClass
+ * {
+ * public:
+ *     explicit RegionDriverClass(SharedFixture<Dataset>& dataset) : dataset(dataset.share()) {}
+ *
+ * protected:
+ *     void SetUp() override { this->dataPtr = &dataset.get(); }
+ *     void TearDown() override { dataset.release(); }
+ *
+ * private:
+ *     SharedFixture<Dataset>::Handle dataset;
+ * };
+ * ```
+ *
+ * @tparam T 夹具的类型。
+ */
+template <typename T>
+class SharedFixture {
+    struct State {
+        std::mutex lock;
+        std::function<std::unique_ptr<T>()> setUp;
+        std::function<void(T&)> tearDown;
+        std::unique_ptr<T> value;
+        size_t users = 0;
+        size_t builds = 0;
+    };
+
+public:
+    /**
+     * @brief 一个使用者持有的引用。
+     *
+     * 只能移动，不能复制；析构时若尚未释放则自动释放。
+     */
+    class Handle {
+    public:
+        Handle() {}
+
+        Handle(Handle&& other) noexcept : state(std::move(other.state)) {}
+
+        Handle& operator=(Handle&& other) noexcept {
+            if (this != &other)
+            {
+                release();
+                state = std::move(other.state);
+            }
+            return *this;
+        }
+
+        Handle(const Handle&) = delete;
+        Handle& operator=(const Handle&) = delete;
+
+        ~Handle() { release(); }
+
+        /// @brief 取得夹具，尚未构造时在此构造。此方法是线程安全的。
+        T& get() {
+            std::lock_guard<std::mutex> guard(state->lock);
+            if (state->value == nullptr)
+            {
+                state->value = state->setUp();
+                state->builds++;
+            }
+            return *state->value;
+        }
+
+        T& operator*() { return get(); }
+        T* operator->() { return &get(); }
+
+        /// @brief 释放引用，最后一个使用者释放时清理夹具。重复调用不做任何处理。
+        void release() {
+            if (state == nullptr)
+            {
+                return;
+            }
+            {
+                std::lock_guard<std::mutex> guard(state->lock);
+                if (--state->users == 0 && state->value != nullptr)
+                {
+                    if (state->tearDown)
+                    {
+                        state->tearDown(*state->value);
+                    }
+                    state->value.reset();
+                }
+            }
+            state.reset();
+        }
+
+    private:
+        friend class SharedFixture;
+
+        explicit Handle(std::shared_ptr<State> state) : state(std::move(state)) {}
+
+        std::shared_ptr<State> state;
+    };
+
+    /**
+     * @brief 构造函数。
+     *
+     * @param setUp 构造夹具的函数。
+     * @param tearDown 清理夹具的函数，可以为空；夹具对象本身总会在清理后被销毁。
+     */
+    explicit SharedFixture(std::function<std::unique_ptr<T>()> setUp, std::function<void(T&)> tearDown = nullptr) : state(std::make_shared<State>()) {
+        state->setUp = std::move(setUp);
+        state->tearDown = std::move(tearDown);
+    }
+
+    /// @brief 登记一个使用者。此方法是线程安全的。
+    Handle share() {
+        std::lock_guard<std::mutex> guard(state->lock);
+        state->users++;
+        return Handle(state);
+    }
+
+    /// @brief 当前登记的使用者数量。
+    size_t users() const {
+        std::lock_guard<std::mutex> guard(state->lock);
+        return state->users;
+    }
+
+    /// @brief 夹具被构造的次数。
+    size_t builds() const {
+        std::lock_guard<std::mutex> guard(state->lock);
+        return state->builds;
+    }
+
+private:
+    std::shared_ptr<State> state;
+};
+
+#endif
@@ -1,7 +1,8 @@
 #ifndef STYLE_PRINT_H
 #define STYLE_PRINT_H
-#include <iostream>
 #include <string>
+#include <string_view>
+#include <OutputSink.h>
 
 // 文本颜色
 enum class TextColor {
@@ -27,11 +28,85 @@ enum class TextStyle {
     HIDDEN = 8         // 隐藏
 };
 
+/// @brief 一个转义序列，形如 `\033[<样式>;<颜色>m`。
+struct EscapeSequence {
+    char text[8];
+    size_t length;
+};
+
+static constexpr int STYLE_COUNT = 9;   // 样式 0 ~ 8
+static constexpr int COLOR_COUNT = 10;  // 颜色 30 ~ 39
+
+/// @brief 所有样式和颜色组合的转义序列表。
+struct EscapeTable {
+    EscapeSequence sequences[STYLE_COUNT][COLOR_COUNT];
+};
+
+constexpr EscapeTable makeEscapeTable() {
+    EscapeTable table{};
+    for (int style = 0; style < STYLE_COUNT; style++)
+    {
+        for (int color = 0; color < COLOR_COUNT; color++)
+        {
+            EscapeSequence& sequence = table.sequences[style][color];
+            sequence.text[0] = '\033';
+            sequence.text[1] = '[';
+            sequence.text[2] = static_cast<char>('0' + style);
+            sequence.text[3] = ';';
+            sequence.text[4] = '3';
+            sequence.text[5] = static_cast<char>('0' + color);
+            sequence.text[6] = 'm';
+            sequence.length = 7;
+        }
+    }
+    return table;
+}
+
+/// @brief 编译期生成的转义序列表，格式化文本时只需查表，不再逐次拼接数字。
+static constexpr EscapeTable ESCAPE_TABLE = makeEscapeTable();
+
+/// @brief 重置样式的转义序列。
+static constexpr std::string_view RESET_SEQUENCE = "\033[0m";
+
+/// @brief 取得某个样式和颜色组合的转义序列。
+inline std::string_view escapeSequence(TextColor color, TextStyle style) {
+    const EscapeSequence& sequence = ESCAPE_TABLE.sequences[static_cast<int>(style)][static_cast<int>(color) - 30];
+    return std::string_view(sequence.text, sequence.length);
+}
+
+/**
+ * @brief 在原有字符串末尾追加带有颜色和样式的文本。
+ *
+ * 此函数用于在原有的字符串末尾追加一段带有特定颜色和样式的文本。追加的文本将以 ANSI 转义码格式化，
+ * 以便在支持此类转义码的终端中显示带有指定样式和颜色的文本。
+ *
+ * @param original 原始字符串，将在其末尾追加格式化后的文本。
+ * @param text 要追加的文本内容。
+ * @param color 文本的颜色，默认为默认颜色（无颜色）。
+ * @param style 文本的样式，默认为普通样式。
+ *
+ * 示例：
+ * 假设 `std::string original = "Original text";`，调用 `appendStyledText(original, "Bold Text", TextColor::GREEN, TextStyle::BOLD);`
+ * 将使 `original` 变为 `"Original text\033[1;32mBold Text\033[0m"`，其中 "Bold Text" 部分将以绿色高亮加粗形式显示。
+ */
+inline void appendStyledText(std::string& original, std::string_view text, TextColor color = TextColor::DEFAULT, TextStyle style = TextStyle::NORMAL) {
+    if (!OutputSink::instance().colorEnabled())
+    {
+        original += text;
+        return;
+    }
+    std::string_view prefix = escapeSequence(color, style);
+    original.reserve(original.size() + prefix.size() + text.size() + RESET_SEQUENCE.size());
+    original.append(prefix.data(), prefix.size());
+    original += text;
+    original.append(RESET_SEQUENCE.data(), RESET_SEQUENCE.size());
+}
 
 /**
  * @brief 打印带有颜色和样式的文本。
  *
  * 此函数用于在控制台上打印带有特定颜色和样式的文本。支持自定义文本颜色和样式，并可选择是否在文本后换行。
+ * 文本写入 `OutputSink`，在换行或 `OutputSink::Block` 结束时写出；输出不支持颜色时只打印文本本身。
  *
  * @param text 要打印的文本内容。
  * @param color 文本的颜色，默认为默认颜色（无颜色）。
@@ -41,8 +116,14 @@ enum class TextStyle {
  * 示例：
  * 调用 `printStyledText("Hello World", TextColor::GREEN, TextStyle::BOLD, true)` 将以绿色高亮加粗的形式打印 "Hello World" 并换行。
  */
-void printStyledText(const std::string& text, TextColor color = TextColor::DEFAULT, TextStyle style = TextStyle::NORMAL, bool newLine = false) {
-    std::cout << "\033[" << static_cast<int>(style) << ';' << static_cast<int>(color) << 'm' << text << "\033[0m" << (newLine ? "\n" : "");
+inline void printStyledText(const std::string& text, TextColor color = TextColor::DEFAULT, TextStyle style = TextStyle::NORMAL, bool newLine = false) {
+    std::string styled;
+    appendStyledText(styled, text, color, style);
+    if (newLine)
+    {
+        styled += '\n';
+    }
+    OutputSink::instance().write(styled);
 }
 
 /**
@@ -55,15 +136,15 @@ void printStyledText(const std::string& text, TextColor color = TextColor::DEFAU
  * 假设控制台上有一行文本 "Previous line"，调用 `deleteLastLine()` 之后，
  * 控制台上的这一行将被清空。
  */
-void deleteLastLine() {
-    std::cout << "\033[A" << "\033[2K";
+inline void deleteLastLine() {
+    OutputSink::instance().write("\033[A\033[2K");
 }
 
 /**
  * @brief 获取带有颜色和样式的文本字符串。
  *
  * 此函数用于生成带有特定颜色和样式的文本字符串。返回的字符串可以直接打印到支持 ANSI 转义码的终端中，
- * 以显示带有指定样式和颜色的文本。
+ * 以显示带有指定样式和颜色的文本。`OutputSink` 禁用了颜色时（例如设置了 `NO_COLOR` 或输出不是终端）返回文本本身。
  *
  * @param text 要格式化的文本内容。
  * @param color 文本的颜色，默认为默认颜色（无颜色）。
@@ -75,26 +156,10 @@ void deleteLastLine() {
  * 示例：
  * 调用 `getStyledText("Hello World", TextColor::GREEN, TextStyle::BOLD)` 将返回一个带有绿色高亮加粗格式的字符串。
  */
-std::string getStyledText(const std::string& text, TextColor color = TextColor::DEFAULT, TextStyle style = TextStyle::NORMAL) {
-    return "\033[" + std::to_string(static_cast<int>(style)) + ';' + std::to_string(static_cast<int>(color)) + 'm' + text + "\033[0m";
+inline std::string getStyledText(const std::string& text, TextColor color = TextColor::DEFAULT, TextStyle style = TextStyle::NORMAL) {
+    std::string styled;
+    appendStyledText(styled, text, color, style);
+    return styled;
 }
 
-/**
- * @brief 在原有字符串末尾追加带有颜色和样式的文本。
- *
- * 此函数用于在原有的字符串末尾追加一段带有特定颜色和样式的文本。追加的文本将以 ANSI 转义码格式化，
- * 以便在支持此类转义码的终端中显示带有指定样式和颜色的文本。
- *
- * @param original 原始字符串，将在其末尾追加格式化后的文本。
- * @param text 要追加的文本内容。
- * @param color 文本的颜色，默认为默认颜色（无颜色）。
- * @param style 文本的样式，默认为普通样式。
- *
- * 示例：
- * 假设 `std::string original = "Original text";`，调用 `appendStyledText(original, "Bold Text", TextColor::GREEN, TextStyle::BOLD);`
- * 将使 `original` 变为 `"Original text\033[1;32mBold Text\033[0m"`，其中 "Bold Text" 部分将以绿色高亮加粗形式显示。
- */
-void appendStyledText(std::string& original, const std::string& text, TextColor color = TextColor::DEFAULT, TextStyle style = TextStyle::NORMAL) {
-    original += getStyledText(text, color, style);
-}
 #endif
\ No newline at end of file
@@ -0,0 +1,347 @@
+#ifndef TASK_SCHEDULER_H
+#define TASK_SCHEDULER_H
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <TestContext.h>
+
+/**
+ * @brief 可拷贝的互斥锁包装。
+ *
+ * `TestResult` 等结果对象需要按值传递，而 `std::mutex` 不可拷贝。此包装在拷贝时
+ * 为新对象创建一把全新的锁，而不复制锁的状态，从而让持有它的类保持可拷贝。
+ */
+class CopyableMutex {
+public:
+    CopyableMutex() {}
+    CopyableMutex(const CopyableMutex&) {}
+    CopyableMutex& operator=(const CopyableMutex&) { return *this; }
+
+    void lock() { mutex.lock(); }
+    void unlock() { mutex.unlock(); }
+
+private:
+    std::mutex mutex;
+};
+
+/**
+ * @brief 工作窃取线程池。
+ *
+ * 每个工作线程持有一个独立的双端队列：线程从自己队列的尾部取任务（后进先出，保持局部性），
+ * 空闲时从其他线程队列的头部窃取任务（先进先出，优先偷走较大的子树）。
+ * 在工作线程内提交的任务会进入该线程自己的队列，因此容器内部展开的叶子任务会优先由
+ * 执行该容器的线程消化，其余线程再按需窃取。
+ *
+ * 注意：
+ * 等待任务完成的线程（见 `TaskGroup::wait`）会主动帮忙执行队列中的任务，
+ * 因此嵌套展开子树不会因为线程全部阻塞而死锁。
+ */
+class WorkStealingPool {
+public:
+    using Task = std::function<void()>;
+
+    /// @brief 构造函数。
+    /// @param threadCount 工作线程数量，至少为 1。
+    explicit WorkStealingPool(size_t threadCount) {
+        threadCount = threadCount == 0 ? 1 : threadCount;
+        for (size_t i = 0; i < threadCount; i++)
+        {
+            queues.emplace_back(new WorkerQueue());
+        }
+        for (size_t i = 0; i < threadCount; i++)
+        {
+            threads.emplace_back([this, i] { workerLoop(i); });
+        }
+    }
+
+    /// @brief 析构函数，等待所有工作线程退出。
+    ~WorkStealingPool() {
+        {
+            std::lock_guard<std::mutex> guard(sleepLock);
+            stopping = true;
+        }
+        wakeUp.notify_all();
+        for (auto& thread : threads)
+        {
+            thread.join();
+        }
+    }
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    /// @brief 工作线程数量。
+    size_t threadCount() const { return threads.size(); }
+
+    /**
+     * @brief 提交一个任务。
+     *
+     * 在本线程池的工作线程中调用时，任务进入当前线程的队列尾部；否则轮流分发到各个队列。
+     *
+     * @param task 待执行的任务。
+     */
+    void submit(Task task) {
+        size_t target = currentPool == this ? currentWorker : nextQueue++ % queues.size();
+        {
+            std::lock_guard<std::mutex> guard(sleepLock);
+            pendingCount++;
+        }
+        {
+            std::lock_guard<std::mutex> guard(queues[target]->lock);
+            queues[target]->tasks.push_back(std::move(task));
+        }
+        wakeUp.notify_one();
+    }
+
+    /**
+     * @brief 尝试执行一个待处理的任务。
+     *
+     * 供等待中的线程调用以协助推进任务。工作线程优先取自己的队列，外部线程直接窃取。
+     *
+     * @return 若执行了一个任务则返回 true。
+     */
+    bool runPendingTask() {
+        Task task;
+        size_t self = currentPool == this ? currentWorker : queues.size();
+        if (!takeTask(self, task))
+        {
+            return false;
+        }
+        task();
+        return true;
+    }
+
+private:
+    struct WorkerQueue {
+        std::mutex lock;
+        std::deque<Task> tasks;
+    };
+
+    std::vector<std::unique_ptr<WorkerQueue>> queues;
+    std::vector<std::thread> threads;
+    std::atomic<size_t> nextQueue{0};
+
+    std::mutex sleepLock;
+    std::condition_variable wakeUp;
+    size_t pendingCount = 0;
+    bool stopping = false;
+
+    inline static thread_local WorkStealingPool* currentPool = nullptr;
+    inline static thread_local size_t currentWorker = 0;
+
+    bool takeTask(size_t self, Task& task) {
+        if (self < queues.size())
+        {
+            std::lock_guard<std::mutex> guard(queues[self]->lock);
+            if (!queues[self]->tasks.empty())
+            {
+                task = std::move(queues[self]->tasks.back());
+                queues[self]->tasks.pop_back();
+                onTaskTaken();
+                return true;
+            }
+        }
+        for (size_t offset = 1; offset <= queues.size(); offset++)
+        {
+            size_t victim = (self + offset) % queues.size();
+            if (victim == self)
+            {
+                continue;
+            }
+            std::lock_guard<std::mutex> guard(queues[victim]->lock);
+            if (!queues[victim]->tasks.empty())
+            {
+                task = std::move(queues[victim]->tasks.front());
+                queues[victim]->tasks.pop_front();
+                onTaskTaken();
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void onTaskTaken() {
+        std::lock_guard<std::mutex> guard(sleepLock);
+        pendingCount--;
+    }
+
+    void workerLoop(size_t id) {
+        currentPool = this;
+        currentWorker = id;
+        while (true)
+        {
+            Task task;
+            if (takeTask(id, task))
+            {
+                task();
+                continue;
+            }
+            std::unique_lock<std::mutex> guard(sleepLock);
+            wakeUp.wait(guard, [this] { return stopping || pendingCount > 0; });
+            if (stopping && pendingCount == 0)
+            {
+                return;
+            }
+        }
+    }
+};
+
+/**
+ * @brief 一组相关任务的同步点。
+ *
+ * 通过 `run` 提交的任务全部完成后 `wait` 才会返回。等待期间当前线程会协助执行线程池中的任务。
+ * 任务中抛出的第一个异常会在 `wait` 中重新抛出。任务在提交线程的 `TestContext` 下执行。
+ */
+class TaskGroup {
+public:
+    /// @brief 构造函数。
+    /// @param pool 执行任务的线程池，为 nullptr 时任务在当前线程中立即执行。
+    explicit TaskGroup(WorkStealingPool* pool) : pool(pool) {}
+
+    /// @brief 析构函数，保证所有任务在对象销毁前完成。
+    ~TaskGroup() {
+        try
+        {
+            wait();
+        }
+        catch (...)
+        {
+        }
+    }
+
+    /// @brief 提交一个任务。
+    template <typename Function>
+    void run(Function&& function) {
+        if (pool == nullptr)
+        {
+            function();
+            return;
+        }
+        outstanding++;
+        pool->submit([this, context = TestContext::current(), function = std::forward<Function>(function)]() mutable {
+            try
+            {
+                TestContext::Scope scope(context);
+                function();
+            }
+            catch (...)
+            {
+                std::lock_guard<std::mutex> guard(errorLock);
+                if (!firstError)
+                {
+                    firstError = std::current_exception();
+                }
+            }
+            outstanding--;
+        });
+    }
+
+    /// @brief 等待所有已提交的任务完成。
+    void wait() {
+        while (outstanding.load() > 0)
+        {
+            if (!pool->runPendingTask())
+            {
+                std::this_thread::yield();
+            }
+        }
+        std::lock_guard<std::mutex> guard(errorLock);
+        if (firstError)
+        {
+            auto error = firstError;
+            firstError = nullptr;
+            std::rethrow_exception(error);
+        }
+    }
+
+private:
+    WorkStealingPool* pool;
+    std::atomic<size_t> outstanding{0};
+    std::mutex errorLock;
+    std::exception_ptr firstError;
+};
+
+/**
+ * @brief 全局测试调度配置。
+ *
+ * 默认情况下所有子测试串行执行。调用 `enableParallel` 后，`GenericTestClass::RunSubTests`
+ * 会把叶子节点和整个容器子树分发到工作窃取线程池中执行。
+ *
+ * 示例：
+ * 在 `main` 中调用 `TestScheduler::enableParallel(8)` 即可用 8 个线程执行整棵测试树。
+ */
+class TestScheduler {
+public:
+    /// @brief 启用并行模式。
+    /// @param threadCount 工作线程数量，为 0 时使用硬件线程数。
+    static void enableParallel(size_t threadCount = 0) {
+        if (threadCount == 0)
+        {
+            threadCount = std::thread::hardware_concurrency();
+        }
+        poolStorage().reset(new WorkStealingPool(threadCount));
+    }
+
+    /// @brief 关闭并行模式并回收线程池。
+    static void disableParallel() { poolStorage().reset(); }
+
+    /// @brief 是否处于并行模式。
+    static bool isParallel() { return poolStorage() != nullptr; }
+
+    /// @brief 当前的线程池，串行模式下为 nullptr。
+    static WorkStealingPool* pool() { return poolStorage().get(); }
+
+    /// @brief 在 fork 出的子进程中丢弃线程池。
+    /// @details 子进程中没有线程池的工作线程，析构线程池会永远等待下去，因此只能放弃这个对象而不析构它。
+    static void abandonAfterFork() { (void)poolStorage().release(); }
+
+private:
+    static std::unique_ptr<WorkStealingPool>& poolStorage() {
+        static std::unique_ptr<WorkStealingPool> storage;
+        return storage;
+    }
+};
+
+/**
+ * @brief 在线程池上并行执行 `[0, count)` 范围内的函数调用。
+ *
+ * 范围会被切分为若干连续的小块提交，以摊薄单个任务的调度开销。
+ * 当 `pool` 为 nullptr 时按顺序在当前线程执行。
+ *
+ * @param pool 线程池。
+ * @param count 调用次数。
+ * @param function 形如 `void(size_t)` 的函数。
+ */
+template <typename Function>
+void parallelFor(WorkStealingPool* pool, size_t count, Function&& function) {
+    if (pool == nullptr || count <= 1)
+    {
+        for (size_t i = 0; i < count; i++)
+        {
+            function(i);
+        }
+        return;
+    }
+    size_t grain = count / (pool->threadCount() * 8);
+    grain = grain == 0 ? 1 : grain;
+    TaskGroup group(pool);
+    for (size_t begin = 0; begin < count; begin += grain)
+    {
+        size_t end = begin + grain < count ? begin + grain : count;
+        group.run([&function, begin, end] {
+            for (size_t i = begin; i < end; i++)
+            {
+                function(i);
+            }
+        });
+    }
+    group.wait();
+}
+
+#endif
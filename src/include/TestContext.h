@@ -0,0 +1,102 @@
+#ifndef TEST_CONTEXT_H
+#define TEST_CONTEXT_H
+#include <atomic>
+#include <memory>
+
+class ResultStore;
+
+/**
+ * @brief 协作式的取消标记。
+ *
+ * 标记可以有上一级标记，上一级被取消时下一级也视为被取消，因此取消一个容器会同时取消其中所有正在执行的测试。
+ * 空的标记永远不会被取消。
+ */
+class CancellationToken {
+public:
+    CancellationToken() {}
+
+    /// @brief 创建一个以当前标记为上一级的新标记。
+    CancellationToken child() const {
+        CancellationToken token;
+        token.state = std::make_shared<State>();
+        token.state->parent = state;
+        return token;
+    }
+
+    /// @brief 当前标记或任意一级上级标记是否已被取消。
+    bool isCancelled() const {
+        for (const State* current = state.get(); current != nullptr; current = current->parent.get())
+        {
+            if (current->cancelled.load(std::memory_order_relaxed))
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /// @brief 取消当前标记，空的标记不做任何处理。
+    void cancel() const {
+        if (state != nullptr)
+        {
+            state->cancelled.store(true, std::memory_order_relaxed);
+        }
+    }
+
+    /// @brief 是否为空的标记。
+    bool empty() const { return state == nullptr; }
+
+private:
+    struct State {
+        std::atomic<bool> cancelled{false};
+        std::shared_ptr<State> parent;
+    };
+
+    std::shared_ptr<State> state;
+};
+
+/**
+ * @brief 当前线程的测试上下文。
+ *
+ * 保存测试树在执行过程中需要向下传递、但不适合逐层作为参数传递的状态，例如当前驱动类持有的结果存储。
+ * 上下文是线程局部的，`TaskGroup` 在提交任务时会捕获提交线程的上下文，并在执行任务的线程中恢复，
+ * 因此并行模式下子测试看到的上下文与串行模式下一致。
+ */
+struct TestContext {
+    /// @brief 最近一层 `TestDriverClass` 持有的叶子结果存储。
+    std::shared_ptr<ResultStore> resultStore;
+
+    /// @brief 当前测试的取消标记，由 `Watchdog` 在测试超出时间预算时取消。
+    CancellationToken cancellation;
+
+    /**
+     * @brief 当前线程正在执行的测试是否已被取消。
+     *
+     * 可能陷入长时间运行的测试可以在循环中检查此函数，被取消后尽快返回。返回之后测试仍会被记录为超时失败。
+     */
+    static bool isCancelled() { return current().cancellation.isCancelled(); }
+
+    /// @brief 当前线程的上下文。
+    static TestContext& current() {
+        static thread_local TestContext context;
+        return context;
+    }
+
+    class Scope;
+};
+
+/**
+ * @brief 在作用域内替换当前线程的上下文，离开作用域时恢复。
+ */
+class TestContext::Scope {
+public:
+    explicit Scope(TestContext context) : saved(current()) { current() = std::move(context); }
+    ~Scope() { current() = std::move(saved); }
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+
+private:
+    TestContext saved;
+};
+
+#endif
@@ -3,9 +3,25 @@
 #include <StyledPrint.h>
 #include <vector>
 #include <string>
+#include <string_view>
 #include <chrono>
 #include <limits>
+#include <mutex>
+#include <algorithm>
 #include <Macros.h>
+#include <TaskScheduler.h>
+#include <Assertion.h>
+#include <ResultStore.h>
+#include <ProgressRenderer.h>
+#include <TestContext.h>
+#include <LatencyHistogram.h>
+#include <Baseline.h>
+#include <Reporter.h>
+#include <PerfCounters.h>
+#include <AllocationTracker.h>
+#include <Watchdog.h>
+#include <BatchResult.h>
+#include <ComparisonStats.h>
 
 /**
  * @brief 测试结果类。
@@ -15,9 +31,9 @@
  */
 class TestResult {
 private:
-    /// @brief 标记是否首次输出测试信息。
-    /// @details 在第一次输出测试信息之前设置为 true，用于控制输出格式。
-    bool firstOutput = false;
+    /// @brief 保护子测试结果集合的锁。
+    /// @details 并行模式下多个子测试会同时向同一个父结果追加结果。
+    CopyableMutex resultMutex;
 
 public:
     /// @brief 测试是否成功。
@@ -32,6 +48,14 @@ public:
     /// @details 如果为 true，则当前测试有一个或多个子测试。
     bool isParentOfLeaf = false;
 
+    /// @brief 标记当前叶子测试的结果是否来自 `ResultCache`。
+    /// @details 为 true 时叶子测试没有实际执行，结果为通过，运行时间为 0。
+    bool cached = false;
+
+    /// @brief 标记当前叶子测试的 `runTime` 是否为实际测得的运行时间。
+    /// @details 为 false 时（例如 A/B 比较的输出不一致、没有进行测量）运行时间不计入直方图。
+    bool measured = true;
+
     /// @brief 当前测试的索引号。
     /// @details 用于标识测试序列中的位置。
     u_int32_t testIndex = 0;
@@ -44,34 +68,96 @@ public:
     /// @details 记录当前测试中失败的子测试数量。
     ssize_t failedCount = 0;
 
+    /// @brief 因时间预算耗尽而没有执行的子测试数量。
+    ssize_t skippedCount = 0;
+
+    /// @brief 属于其他分片、没有在当前进程中执行的叶子数量，见 `Sharding`。
+    ssize_t otherShardCount = 0;
+
+    /// @brief 结果来自 `ResultCache`、没有实际执行的叶子数量（对非叶子子测试按其下层累加），它们也计入 `finishedCount`。
+    ssize_t cachedCount = 0;
+
     /// @brief 测试的名称。
     /// @details 描述当前测试的名称。
     std::string testName;
 
     /// @brief 子测试结果的集合。
-    /// @details 包含当前测试的所有子测试结果。
+    /// @details 包含当前测试的所有非叶子子测试结果。叶子子测试的结果保存在 `leafResults` 中。
     std::vector<TestResult> subTestResults;
 
-    /// @brief 详细的测试输出信息。
-    /// @details 包含测试过程中的详细输出信息，如进度符号等。
-    std::vector<std::string> testVerboseOutput;
+    /// @brief 叶子子测试结果的视图。
+    /// @details 仅对叶子节点的父节点有效。叶子结果直接写入驱动类持有的 `ResultStore`，这里只保存对应区段的视图。
+    LeafRange leafResults;
 
-    /// @brief 错误信息集合。
-    /// @details 收集测试过程中遇到的所有错误信息。
+    /// @brief 自定义错误信息集合。
+    /// @details 断言产生的错误信息不保存在这里，而是在输出报告时由 `formatErrors()` 生成。
     std::vector<std::string> errorInfo;
 
-    uint64_t runTime;
+    /// @brief 运行时间（纳秒）。
+    uint64_t runTime = 0;
+
+    /// @brief 附加的统计信息。
+    /// @details 由特定的测试类型（例如模糊测试、基准测试）填写，输出汇总时逐行打印在汇总信息之后。
+    /// 叶子结果的附加统计信息在追加到父节点时以 `Test N: ` 为前缀转移到父节点。
+    std::vector<std::string> summaryInfo;
+
+    /// @brief 已完成的子测试数量。
+    ssize_t finishedCount = 0;
+
+    /// @brief 下层所有叶子测试运行时间（纳秒）的直方图。
+    /// @details 叶子结果追加时记录其运行时间，非叶子结果追加时合并其直方图，因此沿测试树逐层向上汇总；
+    /// 无论通过与否都会记录，内存占用与叶子的数量无关。
+    LatencyHistogram latency;
+
+    /// @brief 性能计数器。
+    /// @details 启用 `PerfCounters` 时，叶子结果记录运行测试期间本线程的计数器，追加到父节点时逐层累加。
+    PerfCounterSet counters;
+
+    /// @brief 内存分配统计。
+    /// @details 启用 `AllocationTracker` 时，叶子结果记录运行测试期间本线程的分配情况，追加到父节点时逐层累加；
+    /// 容器结果另外记录开始和结束时的常驻内存。
+    AllocationStats allocations;
+
+    /// @brief A/B 比较数据。
+    /// @details 由 `ComparisonExecutorClass` 的叶子结果记录每个输入的加速比，追加到父节点时逐层合并。
+    ComparisonStats comparison;
+
+    /// @brief 进度计数。
+    /// @details 仅对叶子节点的父节点有效，由 `ProgressRenderer` 在后台线程中采样绘制；
+    /// 渲染器只持有弱引用，结果（及其所有副本）被销毁时自动停止跟踪。
+    std::shared_ptr<ProgressCounter> progress;
 
     /**
      * 喂给自动构造器的空构造函数
      * 除非明确在调用后手动初始化变量，否则不应当手动调用这个方法
      */
     TestResult(){}
+
+    /**
+     * @brief 复制构造函数。
+     *
+     * 测试返回结果时会复制 `TestResult`，复制产生的内存分配不应计入叶子的统计，
+     * 因此整个复制过程处于一个 `AllocationTracker::Suppress` 临时对象的作用范围内，任何成员的复制抛出异常时同样会离开该范围。
+     */
+    TestResult(const TestResult& other) : TestResult(other, AllocationTracker::Suppress()) {}
+
+    TestResult(TestResult&& other) = default;
+
+    /// @brief 复制赋值，复制产生的内存分配不计入叶子的统计。
+    TestResult& operator=(const TestResult& other) {
+        AllocationTracker::Suppress suppress;
+        TestResult copy(other);
+        *this = std::move(copy);
+        return *this;
+    }
+
+    TestResult& operator=(TestResult&& other) = default;
     
     /**
     * @brief 初始化 TestResult 对象。
     *
     * 此构造函数用于创建一个新的 TestResult 实例，并根据是否为叶子节点的父节点来初始化相关属性。
+    * 对于叶子节点的父节点，会在当前驱动类持有的结果存储中预留 subTestCount 条叶子记录。
     *
     * @param subTestCount 子测试的数量。
     * @param isParentOfLeaf 是否为叶子节点的父节点。
@@ -83,11 +169,13 @@ public:
         this->testName = testName;
         if (isParentOfLeaf)
         {
-            for (ssize_t i = 0; i < subTestCount; i++)
+            std::shared_ptr<ResultStore> store = TestContext::current().resultStore;
+            if (store == nullptr)
             {
-                std::string initResult = getStyledText("[?]",TextColor::YELLOW, TextStyle::BOLD);
-                testVerboseOutput.push_back(initResult);
+                store = std::make_shared<ResultStore>();
             }
+            leafResults = LeafRange(store, subTestCount);
+            progress = ProgressRenderer::instance().track(testName, leafResults);
         }
     }
 
@@ -100,105 +188,307 @@ public:
      *
      * 注意：这是内部使用的方法，不建议外部调用。
      */
-    void finishSubtestBatch(bool isParentOfLeaf){
-        if (isParentOfLeaf)
+    void finishSubtestBatch(){
+        std::lock_guard<CopyableMutex> guard(resultMutex);
+        OutputSink::Block outputBlock;
+        if (progress != nullptr)
         {
-            deleteLastLine();
-            deleteLastLine();
+            ProgressRenderer::instance().untrack(progress);
         }
+        ProgressRenderer::instance().clearLiveArea();
         
-        for (auto subtestRes : this->subTestResults)
+        for (const auto& subtestRes : this->subTestResults)
         {
-            this->success = this->success ? subtestRes.success : this->success;
-            for (auto subErrorInfo : subtestRes.errorInfo)
+            for (const auto& subErrorInfo : subtestRes.formatErrors())
             {
                 this->errorInfo.push_back(subErrorInfo);
             }
-            this->failedCount += subtestRes.failedCount;
         }
-        
-        if (this->success)
+
+        if (PerformanceBaseline::instance().isActive() && leafResults.valid())
         {
-            uint64_t longestRunTime = 0;
-            uint64_t shortestRunTime = std::numeric_limits<uint64_t>::max();
-            uint64_t averageRunTime = 0;
-            for (size_t i = 0; i < this->subTestResults.size(); i++)
+            std::vector<uint64_t> samples;
+            samples.reserve(leafResults.size());
+            for (size_t i = 0; i < leafResults.size(); i++)
+            {
+                size_t id = leafResults.id(i);
+                if (leafResults.records().isDone(id) && !leafResults.records().isCached(id))
+                {
+                    samples.push_back(leafResults.records().runTime(id));
+                }
+            }
+            std::string comparison = PerformanceBaseline::instance().observe(testName, std::move(samples));
+            if (!comparison.empty())
             {
-                auto subtestTime = this->subTestResults.at(i).runTime;
-                longestRunTime = subtestTime > longestRunTime ? subtestTime : longestRunTime;
-                shortestRunTime = subtestTime < shortestRunTime ? subtestTime : shortestRunTime;
-                averageRunTime = i == 0 ? subtestTime : (int64_t)averageRunTime + ((int64_t)subtestTime - (int64_t)averageRunTime) / (int64_t)(i + 1);
+                summaryInfo.push_back(comparison);
             }
+        }
+
+        if (!counters.empty())
+        {
+            summaryInfo.push_back("Counters: " + counters.summary());
+        }
+        if (!comparison.empty())
+        {
+            summaryInfo.push_back("Comparison: " + comparison.summary());
+        }
+        if (otherShardCount != 0)
+        {
+            summaryInfo.push_back("Sharded: " + std::to_string(subTestCount - otherShardCount) + " of " + std::to_string(subTestCount) +
+                                  " tests belong to this shard");
+        }
+        if (cachedCount != 0)
+        {
+            summaryInfo.push_back("Cached: " + std::to_string(cachedCount) + " tests passed in an earlier run of this build and were not run");
+        }
+        if (skippedCount != 0)
+        {
+            std::string reason = !Watchdog::instance().isEnabled() ? "" : (Watchdog::instance().runExhausted() ? " because the run time budget was exhausted" :
+                                                                                                               " because the container time budget was exhausted");
+            summaryInfo.push_back("Skipped: " + std::to_string(skippedCount) + " tests were not run" + reason);
+        }
+        if (AllocationTracker::isEnabled())
+        {
+            summaryInfo.push_back("Allocations: " + (AllocationTracker::hooksInstalled() ? allocations.summary() :
+                                  "operator new is not hooked, define FUZZ_TEST_SCHEMA_ALLOCATION_TRACKING in one source file"));
+        }
+
+        reportContainer(testName);
 
-            std::string longestRunTimeStr = formatTime(longestRunTime);
-            std::string shortestRunTimeStr = formatTime(shortestRunTime);
-            std::string averageRunTimeStr = formatTime(averageRunTime);
-            
-            printStyledText("Test: " + testName + "  SUCCEED(" + std::to_string(subTestCount) + " passed)", TextColor::GREEN, TextStyle::NORMAL, false);
-            printStyledText(" : Average running time: " + averageRunTimeStr + ", Longest running time: " + longestRunTimeStr + ", Shortest running time: " + shortestRunTimeStr + ".", TextColor::CYAN, TextStyle::NORMAL, true);
+        if (this->success)
+        {
+            // 缓存命中的叶子没有执行，单独计数而不计入通过的数量
+            printStyledText("Test: " + testName + "  SUCCEED(" + std::to_string(subTestCount - skippedCount - otherShardCount - cachedCount) + " passed" +
+                            (cachedCount != 0 ? ", " + std::to_string(cachedCount) + " cached" : "") +
+                            (skippedCount != 0 ? ", " + std::to_string(skippedCount) + " skipped)" : ")"), TextColor::GREEN, TextStyle::NORMAL, false);
+            printStyledText(runningTimeText(), TextColor::CYAN, TextStyle::NORMAL, true);
+            printSummaryInfo();
         }else{
-            printStyledText("Test: " + testName + "  FAILED(" + std::to_string(subTestCount) + " passed, " + std::to_string(failedCount) + " failed)", TextColor::RED, TextStyle::BOLD, true);
-            for (auto error : errorInfo)
+            printStyledText("Test: " + testName + "  FAILED(" + std::to_string(finishedCount - failedCount - cachedCount) + " passed, " +
+                            (cachedCount != 0 ? std::to_string(cachedCount) + " cached, " : "") + std::to_string(failedCount) + " failed)",
+                            TextColor::RED, TextStyle::BOLD, false);
+            printStyledText(runningTimeText(), TextColor::CYAN, TextStyle::NORMAL, true);
+            printSummaryInfo();
+            for (const auto& error : errorInfo)
             {
                 printStyledText(error, TextColor::RED, TextStyle::ITALIC, true);
             }
-            
+            for (size_t i = 0; i < leafResults.size(); i++)
+            {
+                size_t id = leafResults.id(i);
+                if (!leafResults.records().isDone(id) || leafResults.records().passed(id))
+                {
+                    continue;
+                }
+                for (const auto& error : leafResults.records().errors(id))
+                {
+                    printStyledText(error, TextColor::RED, TextStyle::ITALIC, true);
+                }
+            }
         } 
     }
 
+    /**
+    * @brief 将当前测试作为一个容器写入 `ResultReporter`。
+    *
+    * 叶子节点的父节点会同时写入它的每一条叶子记录。未启用任何报告格式时不做任何处理。
+    * 叶子节点的父节点在 `finishSubtestBatch()` 中自动调用此方法，其余容器在 `ProceedTest()` 返回前调用。
+    *
+    * @param name 写入报告的完整测试名称。
+    */
+    void reportContainer(const std::string& name) const {
+        if (!ResultReporter::instance().isActive())
+        {
+            return;
+        }
+        ContainerReport report;
+        report.name = name;
+        report.passed = success;
+        report.isParentOfLeaf = isParentOfLeaf;
+        // 驱动类的结果不预先设置子测试数量
+        report.total = static_cast<uint64_t>(subTestCount != 0 ? subTestCount : finishedCount + skippedCount);
+        report.finished = static_cast<uint64_t>(finishedCount);
+        report.failed = static_cast<uint64_t>(failedCount);
+        report.cached = static_cast<uint64_t>(cachedCount);
+        report.runTime = runTime;
+        report.latency = &latency;
+        report.summaryInfo = &summaryInfo;
+        report.counters = &counters;
+        report.allocations = &allocations;
+        report.comparison = &comparison;
+        report.errors = formatErrors();
+        ResultReporter::instance().report(report, leafResults.valid() ? &leafResults : nullptr);
+    }
+
     /**
     * @brief 向测试结果集合中追加子测试结果。
     *
-    * 此方法用于将一个新的子测试结果添加到测试结果集合中，并在子测试是叶子节点时刷新输出状态。
+    * 此方法用于将一个新的子测试结果添加到测试结果集合中，并在子测试是叶子节点时更新进度计数。
+    * 此方法是线程安全的。子测试结果始终按照 `testIndex` 排序存放，与完成的先后顺序无关。
+    * 此方法不会输出任何内容，进度由 `ProgressRenderer` 以固定帧率异步绘制。
+    *
+    * 叶子子测试的结果会被压缩为 `ResultStore` 中的一条记录，传入的 `TestResult` 对象随即被丢弃；
+    * 其余子测试结果仍然保存在 `subTestResults` 中，但它们本身只携带汇总数据。
+    * 按 `isLeaf` 分别交给 `appendLeafResult()` 或 `appendContainerResult()` 处理；层级在编译期已知时（见 `Schema`）可以直接调用这两个方法。
     *
     * @param subTestRes 子测试结果对象。
     *
     * 注意：这是内部使用的方法，外部调用可能会破坏测试状态。
     */
     void appendSubTestResult(TestResult subTestRes){
-        subTestResults.push_back(subTestRes);
         if (subTestRes.isLeaf)
         {
-            refreshOutput();
+            appendLeafResult(std::move(subTestRes));
+        }
+        else
+        {
+            appendContainerResult(std::move(subTestRes));
         }
     }
 
     /**
-    * @brief 更新测试输出状态。
+    * @brief 追加一个叶子子测试的结果。
     *
-    * 此方法用于更新控制台中的测试状态显示，包括清除旧行、打印测试名称和子测试结果符号。
-    * 成功的子测试会显示绿色的 "[√]"，失败的子测试会显示红色的 "[X]"，正在进行的子测试会显示蓝色的 "[|]"。
+    * 此方法是线程安全的。
     *
-    * 注意：这是内部使用的方法，外部调用可能会破坏测试状态。
+    * @param leaf 叶子测试结果对象。
     */
-    void refreshOutput(){
-        if(firstOutput)
-        {
-            deleteLastLine();
-        }else{
-            printStyledText("Test: " + testName + "  RUNNING", TextColor::BLUE, TextStyle::NORMAL, true);
-        }
-        this->firstOutput = true;
-        for (size_t i = 0; i < this->subTestResults.size(); i++)
+    void appendLeafResult(TestResult leaf){
+        bool storedAsRecord = leafResults.valid() && leaf.testIndex < leafResults.size();
+        if (storedAsRecord)
         {
-            if (subTestResults.at(i).success)
+            for (const auto& message : leaf.errorInfo)
             {
-                testVerboseOutput[i] = getStyledText("[√]", TextColor::GREEN, TextStyle::BOLD);
+                leaf.pushMessageRecord(message);
             }
-            else
+            leafResults.records().record(leafResults.id(leaf.testIndex), leaf.success, leaf.runTime, leaf.testIndex, leaf.assertionFailures, leaf.assertionText, leaf.cached);
+        }
+
+        std::lock_guard<CopyableMutex> guard(resultMutex);
+        this->success = this->success ? leaf.success : this->success;
+        this->failedCount += leaf.success ? 0 : 1;
+        this->finishedCount++;
+        this->cachedCount += leaf.cached ? 1 : 0;
+        this->counters += leaf.counters;
+        this->allocations += leaf.allocations;
+        this->comparison += leaf.comparison;
+        // 缓存命中和没有测量的叶子没有运行时间，不计入直方图
+        if (!leaf.cached && leaf.measured)
+        {
+            this->latency.record(leaf.runTime);
+        }
+        for (const auto& line : leaf.summaryInfo)
+        {
+            this->summaryInfo.push_back("Test " + std::to_string(leaf.testIndex) + ": " + line);
+        }
+
+        bool success = leaf.success;
+        if (!storedAsRecord)
+        {
+            insertSubTestResult(std::move(leaf));
+        }
+        if (progress != nullptr)
+        {
+            progress->completed.fetch_add(1, std::memory_order_relaxed);
+            if (!success)
             {
-                testVerboseOutput[i] = getStyledText("[X]", TextColor::RED, TextStyle::BOLD);
+                progress->failed.fetch_add(1, std::memory_order_relaxed);
             }
         }
-        if (this->subTestResults.size() < this->testVerboseOutput.size())
+    }
+
+    /**
+    * @brief 追加一批叶子子测试的结果。
+    *
+    * 通过的叶子直接写入 `ResultStore`，汇总数据在一次加锁中累加；失败的叶子（通常很少）逐个按 `appendLeafResult()` 追加，
+    * 附带的错误信息以 `Test N: ` 为前缀。每个叶子的运行时间记为整批运行时间的平均值。
+    * 此方法是线程安全的。
+    *
+    * @param batch 一批叶子的结果。
+    * @param indexOf 形如 `size_t(size_t offset)` 的函数，返回批中第 offset 个叶子的 `testIndex`。
+    */
+    template <typename IndexOf>
+    void appendLeafBatch(const BatchResult& batch, const IndexOf& indexOf){
+        size_t count = batch.size();
+        if (count == 0)
         {
-            testVerboseOutput[this->subTestResults.size()] = getStyledText("[|]", TextColor::BLUE, TextStyle::BOLD);
+            return;
         }
-        for (size_t i = 0; i < this->testVerboseOutput.size(); i++)
+        uint64_t perLeaf = batch.runTime / count;
+        std::vector<BatchResult::Failure> failures = batch.failures();
+        std::stable_sort(failures.begin(), failures.end(),
+            [](const BatchResult::Failure& lhs, const BatchResult::Failure& rhs) { return lhs.offset < rhs.offset; });
+        auto failure = failures.begin();
+
+        static const std::vector<AssertionRecord> noFailures;
+        static const std::string noText;
+        uint64_t passedCount = 0;
+        for (size_t offset = 0; offset < count; offset++)
+        {
+            size_t index = indexOf(offset);
+            if (batch.passed(offset) && leafResults.valid() && index < leafResults.size())
+            {
+                leafResults.records().record(leafResults.id(index), true, perLeaf, static_cast<uint32_t>(index), noFailures, noText);
+                passedCount++;
+                continue;
+            }
+            TestResult leaf;
+            leaf.isLeaf = true;
+            leaf.testIndex = static_cast<u_int32_t>(index);
+            leaf.success = batch.passed(offset);
+            leaf.runTime = perLeaf;
+            for (; failure != failures.end() && failure->offset == offset; ++failure)
+            {
+                leaf.errorInfo.push_back("Test " + std::to_string(index) + ": " + failure->message);
+            }
+            if (!leaf.success && leaf.errorInfo.empty())
+            {
+                leaf.errorInfo.push_back("Test " + std::to_string(index) + ": failed");
+            }
+            appendLeafResult(std::move(leaf));
+        }
+
+        std::lock_guard<CopyableMutex> guard(resultMutex);
+        this->finishedCount += static_cast<ssize_t>(passedCount);
+        this->latency.record(perLeaf, passedCount);
+        this->counters += batch.counters;
+        this->allocations += batch.allocations;
+        if (progress != nullptr)
         {
-            std::cout << this->testVerboseOutput.at(i);
+            progress->completed.fetch_add(passedCount, std::memory_order_relaxed);
         }
-        std::cout << std::endl;
+    }
+
+    /**
+    * @brief 追加一个非叶子子测试的结果，其汇总数据累加到当前测试。
+    *
+    * 此方法是线程安全的。
+    *
+    * @param child 子测试结果对象。
+    */
+    void appendContainerResult(TestResult child){
+        std::lock_guard<CopyableMutex> guard(resultMutex);
+        this->success = this->success ? child.success : this->success;
+        this->failedCount += child.failedCount;
+        this->finishedCount++;
+        this->cachedCount += child.cachedCount;
+        this->counters += child.counters;
+        this->allocations += child.allocations;
+        this->comparison += child.comparison;
+        this->latency.merge(child.latency);
+        insertSubTestResult(std::move(child));
+    }
+
+    /**
+    * @brief 立即重绘测试进度。
+    *
+    * 进度通常由 `ProgressRenderer` 按固定帧率自动绘制，此方法用于在需要时立即绘制一帧。
+    * 成功的子测试会显示绿色的 "[√]"，失败的子测试会显示红色的 "[X]"，正在进行的子测试会显示蓝色的 "[|]"，
+    * 尚未开始的子测试会显示黄色的 "[?]"；子测试较多时改为显示分段进度条。
+    */
+    void refreshOutput(){
+        OutputSink::Block outputBlock;
+        ProgressRenderer::instance().renderFrame();
     }
 
     /**
@@ -206,19 +496,30 @@ public:
     *
     * 此函数用于比较两个同类型的值（lhs 和 rhs），如果它们不相等，则记录一条错误信息，
     * 并更新测试的成功状态。此函数不会中断测试执行。
+    * 断言通过时不会产生任何内存分配；失败时只保存原始操作数，错误信息在输出报告时才生成。
+    * 非算术类型（如字符串和容器）的操作数通过 `ValueFormatter` 格式化。
     *
-    * @param variableName 变量名字符串，用于在错误信息中标识比较对象。
+    * @param variableName 变量名字符串，用于在错误信息中标识比较对象。失败时复制到文本池中。
     * @param lhs 左手边表达式的值。
     * @param rhs 右手边表达式的期望值。
     *
     */
     template <typename T>
-    void assertEQ(std::string variableName, T lhs, T rhs){
-        this->success = success ? lhs == rhs : success;
-        if (lhs != rhs)
+    void assertEQ(const char* variableName, const T& lhs, const T& rhs){
+        if (__builtin_expect(lhs == rhs, 1))
         {
-            this->errorInfo.push_back(getStyledText("Test " + std::to_string(this->testIndex) +": Expect " + variableName + " = " + std::to_string(lhs) + ", but get: " + std::to_string(rhs) + ".", TextColor::RED, TextStyle::NORMAL));
-        }   
+            return;
+        }
+        recordAssertion(AssertionKind::EQ, variableName, lhs, rhs, rhs);
+    }
+
+    template <typename T>
+    void assertEQ(const std::string& variableName, const T& lhs, const T& rhs){
+        if (__builtin_expect(lhs == rhs, 1))
+        {
+            return;
+        }
+        recordAssertion(AssertionKind::EQ, variableName, lhs, rhs, rhs);
     }
 
     /**
@@ -237,13 +538,21 @@ public:
     * 假设 `tolerance` 的值为 0.001，则调用 `assertFEQ("value", 0.1, 0.10001)` 将被视为通过。
     */
     template <typename T>
-    void assertFEQ(std::string variableName, T lhs, T rhs, T tolerance = FP_TOLERANCE){
-        this->success = success ? ABS(lhs, rhs) <= tolerance : success;
-        this->failedCount = !success ? failedCount + 1 : failedCount;
-        if (lhs != rhs)
+    void assertFEQ(const char* variableName, const T& lhs, const T& rhs, const T& tolerance = FP_TOLERANCE){
+        if (__builtin_expect(ABS(lhs, rhs) <= tolerance, 1))
         {
-            this->errorInfo.push_back(getStyledText("Test " + std::to_string(this->testIndex) +": Expect " + variableName + " = " + std::to_string(lhs) + " with fp_tolerance of " + std::to_string(tolerance) + ", but get: " + std::to_string(rhs) + ".", TextColor::RED, TextStyle::NORMAL));
-        }  
+            return;
+        }
+        recordAssertion(AssertionKind::FEQ, variableName, lhs, rhs, tolerance);
+    }
+
+    template <typename T>
+    void assertFEQ(const std::string& variableName, const T& lhs, const T& rhs, const T& tolerance = FP_TOLERANCE){
+        if (__builtin_expect(ABS(lhs, rhs) <= tolerance, 1))
+        {
+            return;
+        }
+        recordAssertion(AssertionKind::FEQ, variableName, lhs, rhs, tolerance);
     }
 
     /**
@@ -261,14 +570,21 @@ public:
     * 调用 `assertNE("value", 1, 1)` 将被视为失败。
     */
     template <typename T>
-    void assertNE(std::string variableName, T lhs, T rhs){
-        this->success = success ? lhs != rhs : success;
-        this->failedCount = !success ? failedCount + 1 : failedCount;
-        if (lhs == rhs)
+    void assertNE(const char* variableName, const T& lhs, const T& rhs){
+        if (__builtin_expect(lhs != rhs, 1))
         {
-            this->errorInfo.push_back(getStyledText("Test " + std::to_string(this->testIndex) +": Expect " + variableName + " ≠ " + std::to_string(lhs) + ", but get: " + std::to_string(rhs) + ".", TextColor::RED, TextStyle::NORMAL));
+            return;
         }
-        
+        recordAssertion(AssertionKind::NE, variableName, lhs, rhs, rhs);
+    }
+
+    template <typename T>
+    void assertNE(const std::string& variableName, const T& lhs, const T& rhs){
+        if (__builtin_expect(lhs != rhs, 1))
+        {
+            return;
+        }
+        recordAssertion(AssertionKind::NE, variableName, lhs, rhs, rhs);
     }
 
     /**
@@ -288,13 +604,156 @@ public:
     * 因为两个值在容差范围内被认为是相等的。
     */
     template <typename T>
-    void assertFNE(std::string variableName, T lhs, T rhs, T tolerance = FP_TOLERANCE){
-        this->success = success ? ABS(lhs, rhs) <= tolerance : success;
-        this->failedCount = !success ? failedCount + 1 : failedCount;
-        if (lhs != rhs)
+    void assertFNE(const char* variableName, const T& lhs, const T& rhs, const T& tolerance = FP_TOLERANCE){
+        if (__builtin_expect(ABS(lhs, rhs) > tolerance, 1))
+        {
+            return;
+        }
+        recordAssertion(AssertionKind::FNE, variableName, lhs, rhs, tolerance);
+    }
+
+    template <typename T>
+    void assertFNE(const std::string& variableName, const T& lhs, const T& rhs, const T& tolerance = FP_TOLERANCE){
+        if (__builtin_expect(ABS(lhs, rhs) > tolerance, 1))
+        {
+            return;
+        }
+        recordAssertion(AssertionKind::FNE, variableName, lhs, rhs, tolerance);
+    }
+
+    /**
+    * @brief 记录一个因时间预算耗尽而没有执行的子测试。
+    *
+    * 此方法是线程安全的。
+    */
+    void skipSubTest(){
+        std::lock_guard<CopyableMutex> guard(resultMutex);
+        this->skippedCount++;
+    }
+
+    /**
+    * @brief 记录超时失败。
+    *
+    * 叶子测试记为一条带索引号的错误信息，容器则只标记为失败并附加错误信息，不改变失败的子测试数量。
+    *
+    * @param watch 超时的监视范围。
+    * @param input 输入的可读形式，为空时不输出。
+    */
+    void recordTimeout(const Watchdog::Watch& watch, const std::string& input = ""){
+        std::string message = watch.describe() + (input.empty() ? "" : ", input: " + input);
+        if (this->isLeaf)
+        {
+            recordMessage("Test " + std::to_string(this->testIndex) + ": " + message);
+            return;
+        }
+        this->success = false;
+        this->errorInfo.push_back("Test: " + this->testName + ": " + message);
+    }
+
+    /**
+    * @brief 记录一条自定义的错误信息，并将当前测试标记为失败。
+    *
+    * @param message 错误信息。
+    */
+    void recordMessage(const std::string& message){
+        this->success = false;
+        this->failedCount++;
+        pushMessageRecord(message);
+    }
+
+    /**
+    * @brief 生成当前测试的所有错误信息（不带样式）。
+    *
+    * 包括失败断言的错误信息和 `errorInfo` 中的自定义错误信息。
+    *
+    * @return 返回错误信息列表。
+    */
+    std::vector<std::string> formatErrors() const {
+        std::vector<std::string> errors;
+        for (const auto& failure : assertionFailures)
+        {
+            errors.push_back(formatAssertion(failure, assertionText));
+        }
+        errors.insert(errors.end(), errorInfo.begin(), errorInfo.end());
+        return errors;
+    }
+
+private:
+    /// @brief 单个测试最多保存的失败断言记录数量，超出部分只计数不保存。
+    static constexpr size_t MAX_RECORDED_ASSERTIONS = 32;
+
+    /// @brief 失败断言的记录。
+    std::vector<AssertionRecord> assertionFailures;
+
+    /// @brief 失败断言记录所引用的文本池，保存运行时变量名和非算术类型的操作数。
+    std::string assertionText;
+
+    /// @brief 按 `testIndex` 有序地插入 `subTestResults`，调用者需要持有 `resultMutex`。
+    void insertSubTestResult(TestResult subTestRes){
+        auto position = std::upper_bound(subTestResults.begin(), subTestResults.end(), subTestRes.testIndex,
+            [](u_int32_t index, const TestResult& existing) { return index < existing.testIndex; });
+        subTestResults.insert(position, std::move(subTestRes));
+    }
+
+    template <typename T>
+    __attribute__((noinline)) void recordAssertion(AssertionKind kind, std::string_view variableName, const T& lhs, const T& rhs, const T& tolerance){
+        this->success = false;
+        this->failedCount++;
+        if (assertionFailures.size() >= MAX_RECORDED_ASSERTIONS)
         {
-            this->errorInfo.push_back(getStyledText("Test " + std::to_string(this->testIndex) +": Expect " + variableName + " ≠ " + std::to_string(lhs) + " with fp_tolerance of " + std::to_string(tolerance) + ", but get: " + std::to_string(rhs) + ".", TextColor::RED, TextStyle::NORMAL));
-        }  
+            return;
+        }
+        AllocationTracker::Suppress suppress;
+        AssertionRecord record;
+        record.nameOffset = static_cast<uint32_t>(assertionText.size());
+        record.nameLength = static_cast<uint32_t>(variableName.size());
+        assertionText += variableName;
+        record.testIndex = this->testIndex;
+        record.kind = kind;
+        record.lhs = captureOperand(lhs, record.operandKind, assertionText);
+        record.rhs = captureOperand(rhs, record.operandKind, assertionText);
+        record.tolerance = kind == AssertionKind::FEQ || kind == AssertionKind::FNE ? captureOperand(tolerance, record.operandKind, assertionText) : AssertionOperand();
+        assertionFailures.push_back(record);
+    }
+
+    /// @brief 汇总行中的运行时间部分；所有叶子都来自缓存或没有测量时直方图为空，不输出百分位数。
+    std::string runningTimeText() const {
+        return latency.count() == 0 ? " : No measured tests." : " : Running time " + latency.summary() + ".";
+    }
+
+    void printSummaryInfo() const {
+        for (const auto& line : summaryInfo)
+        {
+            printStyledText("  " + line, TextColor::CYAN, TextStyle::NORMAL, true);
+        }
+    }
+
+    void pushMessageRecord(const std::string& message){
+        if (assertionFailures.size() >= MAX_RECORDED_ASSERTIONS)
+        {
+            return;
+        }
+        AllocationTracker::Suppress suppress;
+        AssertionRecord record = AssertionRecord();
+        record.nameOffset = static_cast<uint32_t>(assertionText.size());
+        record.nameLength = static_cast<uint32_t>(message.size());
+        record.testIndex = this->testIndex;
+        record.kind = AssertionKind::MESSAGE;
+        record.operandKind = OperandKind::SIGNED;
+        assertionText += message;
+        assertionFailures.push_back(record);
+    }
+
+    /// @brief 在 suppress 的作用范围内逐个复制成员，供复制构造函数委托。
+    TestResult(const TestResult& other, const AllocationTracker::Suppress& suppress)
+        : resultMutex(other.resultMutex), success(other.success), isLeaf(other.isLeaf), isParentOfLeaf(other.isParentOfLeaf), cached(other.cached),
+          measured(other.measured), testIndex(other.testIndex), subTestCount(other.subTestCount), failedCount(other.failedCount),
+          skippedCount(other.skippedCount), otherShardCount(other.otherShardCount), cachedCount(other.cachedCount), testName(other.testName),
+          subTestResults(other.subTestResults), leafResults(other.leafResults), errorInfo(other.errorInfo), runTime(other.runTime),
+          summaryInfo(other.summaryInfo), finishedCount(other.finishedCount), latency(other.latency), counters(other.counters),
+          allocations(other.allocations), comparison(other.comparison), progress(other.progress), assertionFailures(other.assertionFailures),
+          assertionText(other.assertionText) {
+        (void)suppress;
     }
 };
 
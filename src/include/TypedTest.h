@@ -0,0 +1,209 @@
+#ifndef TYPED_TEST_H
+#define TYPED_TEST_H
+#include <iterator>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <FuzzTestSchema.h>
+#include <Schema.h>
+
+/**
+ * 类型化测试模板。
+ *
+ * 与 `TestDriverClass`/`TestContainerClass`/`TestExecutorClass` 通过 `void* dataPtr` 传递数据、通过虚函数调度不同，
+ * 这里的模板使用 CRTP 静态分发：数据以 `const Input&` 的形式逐层向下传递，无需为了获得稳定地址而拷贝；
+ * 叶子测试的调用可以被编译器内联；上下层之间的数据类型不匹配会在编译期报错。
+ */
+
+template <typename Derived, typename Input>
+class TestExecutor;
+
+/// @brief 判断一个类型是否为 `TestExecutor` 的派生类。
+template <typename T, typename = void>
+struct IsTestExecutor : std::false_type {};
+
+template <typename T>
+struct IsTestExecutor<T, std::void_t<typename T::InputType>>
+    : std::integral_constant<bool, std::is_base_of<TestExecutor<T, typename T::InputType>, T>::value> {};
+
+/**
+ * @brief 类型化测试执行者模板。
+ *
+ * 派生类需要实现 `void RunTest(const Input& input, TestResult& result)`，其中通过 `result.assert...` 进行断言。
+ *
+ * 示例：
+ * ```cpp
+ * class LengthExecutor : public TestExecutor<LengthExecutor, std::string>
+ * {
+ * public:
+ *     void RunTest(const std::string& input, TestResult& result)
+ *     {
+ *         result.assertNE("string length", input.length(), size_t(0));
+ *     }
+ * };
+ * ```
+ *
+ * @tparam Derived 派生类自身。
+ * @tparam Input 单个测试输入的类型。
+ */
+template <typename Derived, typename Input>
+class TestExecutor {
+public:
+    using InputType = Input;
+
+    /// @brief 执行测试。
+    /// @param input 测试输入。
+    /// @param testIndex 当前测试的索引号。
+    /// @return 返回测试结果。
+    TestResult ProceedTest(const Input& input, size_t testIndex) {
+        return runSchemaLeaf(testIndex, [&](TestResult& result) { static_cast<Derived*>(this)->RunTest(input, result); });
+    }
+};
+
+/**
+ * @brief 类型化测试容器模板。
+ *
+ * 遍历输入中的每个元素，并交给下层的 `Child` 执行。`Child` 可以是 `TestExecutor`（此时本容器是叶子节点的父节点），
+ * 也可以是另一个 `TestContainer`。元素类型必须能够转换为 `Child::InputType`，否则编译失败。
+ * 元素区间可以是任意前向区间（例如 `std::list`、`std::map`），按索引访问元素总是 O(1)，见 `IndexedElements`。
+ *
+ * 派生类可以按需提供以下函数（均为可选）：
+ * - `const auto& Elements(const Range& input)`：返回需要遍历的元素区间，默认为输入本身。
+ * - `NameType Name(const Range& input)`：返回当前测试集的名称，默认为空。
+ *
+ * 示例：
+ * ```cpp
+ * class LengthContainer : public TestContainer<LengthContainer, LengthExecutor, ContainerType>
+ * {
+ * public:
+ *     const ContainerDatatype& Elements(const ContainerType& input) { return input.first; }
+ *     NameType Name(const ContainerType& input) { return input.second; }
+ * };
+ * ```
+ *
+ * @tparam Derived 派生类自身。
+ * @tparam Child 下层测试类型。
+ * @tparam Range 当前测试输入的类型。
+ */
+template <typename Derived, typename Child, typename Range>
+class TestContainer {
+public:
+    using InputType = Range;
+
+    /// @brief 默认的元素区间，即输入本身。
+    const Range& Elements(const Range& input) { return input; }
+
+    /// @brief 默认的测试集名称。
+    NameType Name(const Range& input) {
+        (void)input;
+        return "";
+    }
+
+    /// @brief 执行测试。
+    /// @param input 测试输入。
+    /// @param testName 上层测试的名称。
+    /// @return 返回测试结果。
+    TestResult ProceedTest(const Range& input, NameType testName) {
+        Derived& self = *static_cast<Derived*>(this);
+        const auto& elements = self.Elements(input);
+        using ElementType = std::decay_t<decltype(*std::begin(elements))>;
+        static_assert(std::is_convertible<const ElementType&, const typename Child::InputType&>::value,
+                      "TestContainer: element type does not match Child::InputType");
+
+        NameType subTestName = self.Name(input);
+        NameType fullName = subTestName.empty() ? testName : testName + "." + subTestName;
+        constexpr bool isParentOfLeaf = IsTestExecutor<Child>::value;
+        constexpr size_t extent = StaticExtent<std::decay_t<decltype(elements)>>::value;
+        size_t count = static_cast<size_t>(std::distance(std::begin(elements), std::end(elements)));
+
+        IndexedElements<std::decay_t<decltype(elements)>> indexed(elements);
+        return runSchemaContainer<isParentOfLeaf, extent>(count, fullName, [&](size_t index) {
+            const typename Child::InputType& element = indexed[index];
+            Child child;
+            if constexpr (isParentOfLeaf)
+            {
+                return child.ProceedTest(element, index);
+            }
+            else
+            {
+                return child.ProceedTest(element, fullName);
+            }
+        });
+    }
+};
+
+/**
+ * @brief 类型化测试驱动模板。
+ *
+ * 派生类需要实现 `Data SetUp()` 用于读取或生成测试数据，并可以选择实现 `void TearDown(Data& data)`。
+ * 与 `TestDriverClass` 一样，执行期间驱动模板持有下层所有叶子结果的存储。
+ * 与 `TestContainer` 一样，派生类可以提供 `Elements` 和 `Name` 函数。
+ *
+ * @tparam Derived 派生类自身。
+ * @tparam Child 下层测试类型，通常是一个 `TestContainer`。
+ * @tparam Data 测试数据的类型。
+ */
+template <typename Derived, typename Child, typename Data>
+class TestDriver : public TestContainer<Derived, Child, Data> {
+public:
+    /// @brief 默认的清理函数，不做任何处理。
+    void TearDown(Data& data) { (void)data; }
+
+    /// @brief 执行测试。
+    /// @param testName 测试的名称。
+    /// @return 返回测试结果。
+    TestResult ProceedTest(NameType testName) {
+        Derived& self = *static_cast<Derived*>(this);
+        TestContext context = TestContext::current();
+        context.resultStore = std::make_shared<ResultStore>();
+        TestContext::Scope scope(context);
+        Data data = self.SetUp();
+        TestResult result;
+        {
+            ForkServer::Session isolation;
+            result = TestContainer<Derived, Child, Data>::ProceedTest(data, testName);
+        }
+        self.TearDown(data);
+        return result;
+    }
+};
+
+/**
+ * @brief 将类型化测试执行者适配为 `TestExecutorClass`。
+ *
+ * 使现有的基于 `void* dataPtr` 的测试树可以直接调度类型化的执行者，`dataPtr` 需要指向 `Executor::InputType`。
+ */
+template <typename Executor>
+class TypedExecutorAdapter : public TestExecutorClass {
+public:
+    using TestExecutorClass::TestExecutorClass;
+
+    TestResult RunTest(NameType testName) override {
+        (void)testName;
+        return executor.ProceedTest(*DATA_PTR(const typename Executor::InputType), this->testIndex);
+    }
+
+private:
+    Executor executor;
+};
+
+/**
+ * @brief 将类型化测试容器适配为 `TestContainerClass`。
+ *
+ * 使现有的基于 `void* dataPtr` 的测试树可以直接调度类型化的容器，`dataPtr` 需要指向 `Container::InputType`。
+ * 汇总输出由类型化容器自身负责，因此 `isParentOfLeaf` 应当传入 false。
+ */
+template <typename Container>
+class TypedContainerAdapter : public TestContainerClass {
+public:
+    using TestContainerClass::TestContainerClass;
+
+    TestResult RunTest(NameType testName) override {
+        return container.ProceedTest(*DATA_PTR(const typename Container::InputType), testName);
+    }
+
+private:
+    Container container;
+};
+
+#endif
@@ -0,0 +1,422 @@
+#ifndef WATCHDOG_H
+#define WATCHDOG_H
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+#include <Macros.h>
+#include <StyledPrint.h>
+#include <ProgressRenderer.h>
+#include <TestContext.h>
+
+/**
+ * @brief 受监视的测试种类，决定使用哪一项时间预算。
+ */
+enum class WatchKind {
+    LEAF,        // 叶子测试
+    CONTAINER    // 容器（包括叶子节点的父节点）
+};
+
+/**
+ * @brief 一个正在执行的测试的截止时间。
+ */
+struct WatchEntry {
+    /// @brief 测试的取消标记。
+    CancellationToken token;
+
+    /// @brief 开始时间和截止时间（`steady_clock` 纳秒）。
+    uint64_t start = 0;
+    uint64_t deadline = 0;
+
+    /// @brief 截止时间所在的时间轮刻度。
+    uint64_t tick = 0;
+
+    /// @brief 测试的名称，超时时输出。
+    std::string label;
+
+    /// @brief 超时时在看门狗线程中调用，例如杀死执行测试的工作进程。
+    std::function<void()> onExpire;
+
+    /// @brief 条目的状态，只能从 `RUNNING` 变为 `DONE` 或 `EXPIRED` 之一。
+    enum State : int { RUNNING, DONE, EXPIRED };
+    std::atomic<int> state{RUNNING};
+
+    /// @brief 尝试将状态从 `RUNNING` 变为 to，返回是否成功。
+    bool transition(State to) {
+        int expected = RUNNING;
+        return state.compare_exchange_strong(expected, to, std::memory_order_acq_rel);
+    }
+};
+
+/**
+ * @brief 哈希时间轮。
+ *
+ * 截止时间按刻度散列到固定数量的槽中，登记和注销都是 O(1)；每个刻度只需要检查一个槽。
+ * 截止时间超出一圈的条目留在槽中，直到转到对应的那一圈才到期。
+ * 已完成的条目不会立即从槽中删除，而是在下一次检查这个槽时顺带删除，因此测试结束时无需加锁。
+ *
+ * 此类不是线程安全的，由 `Watchdog` 加锁保护。
+ */
+class TimingWheel {
+public:
+    /// @brief 槽的数量。
+    static constexpr size_t SLOT_COUNT = 512;
+
+    /// @param tickNanoseconds 每个刻度的长度（纳秒）。
+    /// @param now 当前时间（纳秒）。
+    TimingWheel(uint64_t tickNanoseconds, uint64_t now) : tickLength(tickNanoseconds), currentTick(now / tickNanoseconds) {}
+
+    /// @brief 登记一个条目。
+    void insert(std::shared_ptr<WatchEntry> entry) {
+        // 向上取整，保证不会早于截止时间到期
+        uint64_t tick = (entry->deadline + tickLength - 1) / tickLength;
+        entry->tick = tick <= currentTick ? currentTick + 1 : tick;
+        slots[entry->tick % SLOT_COUNT].push_back(std::move(entry));
+        count++;
+    }
+
+    /**
+     * @brief 推进到 now，将到期的条目移入 expired。
+     *
+     * @param now 当前时间（纳秒）。
+     * @param expired 到期的条目。
+     */
+    void advance(uint64_t now, std::vector<std::shared_ptr<WatchEntry>>& expired) {
+        uint64_t target = now / tickLength;
+        // 长时间没有推进时，每个槽最多检查一次
+        uint64_t first = target - currentTick > SLOT_COUNT ? target - SLOT_COUNT : currentTick;
+        for (uint64_t tick = first; tick <= target; tick++)
+        {
+            std::vector<std::shared_ptr<WatchEntry>>& slot = slots[tick % SLOT_COUNT];
+            size_t kept = 0;
+            for (size_t i = 0; i < slot.size(); i++)
+            {
+                if (slot[i]->state.load(std::memory_order_acquire) != WatchEntry::RUNNING)
+                {
+                    continue;
+                }
+                if (slot[i]->tick <= target)
+                {
+                    expired.push_back(std::move(slot[i]));
+                    continue;
+                }
+                slot[kept++] = std::move(slot[i]);
+            }
+            count -= slot.size() - kept;
+            slot.resize(kept);
+        }
+        currentTick = target;
+    }
+
+    /// @brief 槽中的条目数量，包括尚未删除的已完成条目。
+    size_t size() const { return count; }
+
+    /// @brief 下一个刻度的开始时间（纳秒）。
+    uint64_t nextTick() const { return (currentTick + 1) * tickLength; }
+
+private:
+    uint64_t tickLength;
+    uint64_t currentTick;
+    size_t count = 0;
+    std::array<std::vector<std::shared_ptr<WatchEntry>>, SLOT_COUNT> slots;
+};
+
+/**
+ * @brief 测试的时间预算看门狗。
+ *
+ * 可以分别为每个叶子测试、每个容器和整次运行设置墙钟时间预算，预算为 0 表示不限制。
+ * 设置了任意一项预算后，看门狗线程启动，用 `TimingWheel` 跟踪所有正在执行的叶子和容器的截止时间：
+ * - 叶子超时：取消它的 `CancellationToken`，测试代码可以通过 `TestContext::isCancelled()` 得知并尽快返回；
+ *   测试返回后被记录为超时失败，错误信息包括实际运行时间和输入。
+ *   隔离执行（见 `ForkServer`）时，看门狗直接杀死执行该测试的工作进程，即使测试陷入死循环也能继续。
+ * - 容器超时：取消容器的标记，容器不再调度新的子测试，正在执行的子测试也会看到取消；容器被记录为超时失败。
+ * - 整次运行超时：所有容器都不再调度新的子测试，未执行的测试在汇总中计为跳过。
+ *
+ * 没有隔离执行时，看门狗无法强行中止一个不检查取消标记的测试，只能在超时时输出一行提示，指出仍在运行的测试。
+ * 整次运行的预算从调用 `setRunBudget` 时开始计算。
+ *
+ * 示例：
+ * ```cpp
+ * Watchdog::instance().setLeafBudget(std::chrono::seconds(1));
+ * Watchdog::instance().setContainerBudget(std::chrono::seconds(30));
+ * Watchdog::instance().setRunBudget(std::chrono::minutes(10));
+ * rootClass.ProceedTest("ShowCase");
+ * ```
+ */
+class Watchdog {
+public:
+    /// @brief 时间轮每个刻度的长度，也是超时检测的精度。
+    static constexpr std::chrono::milliseconds TICK{10};
+
+    /**
+     * @brief 监视一个测试的作用范围。
+     *
+     * 构造时为测试创建一个新的取消标记（以当前上下文中的标记为上一级）并替换当前线程的上下文，
+     * 对应种类设置了预算时登记截止时间；析构时注销并恢复上下文。看门狗未启用时不做任何处理。
+     */
+    class Watch {
+    public:
+        /**
+         * @param kind 测试的种类。
+         * @param label 测试的名称，只在启用时求值。
+         * @param onExpire 超时时在看门狗线程中调用的函数，可以为空。
+         */
+        template <typename Label>
+        Watch(WatchKind kind, Label&& label, std::function<void()> onExpire = nullptr) {
+            Watchdog& watchdog = Watchdog::instance();
+            if (!watchdog.isEnabled())
+            {
+                return;
+            }
+            TestContext context = TestContext::current();
+            CancellationToken parent = context.cancellation.empty() ? watchdog.runToken : context.cancellation;
+            context.cancellation = parent.child();
+            uint64_t budget = watchdog.budgetOf(kind);
+            if (budget != 0)
+            {
+                entry = std::make_shared<WatchEntry>();
+                entry->token = context.cancellation;
+                entry->start = Watchdog::now();
+                entry->deadline = entry->start + budget;
+                entry->label = label();
+                entry->onExpire = std::move(onExpire);
+                watchdog.watch(entry);
+            }
+            scope.emplace(std::move(context));
+        }
+
+        ~Watch() { finish(); }
+
+        Watch(const Watch&) = delete;
+        Watch& operator=(const Watch&) = delete;
+
+        /**
+         * @brief 结束监视。
+         *
+         * 此后看门狗不会再因为这个测试调用 `onExpire`。析构时会自动调用，需要在超时处理与后续操作之间建立先后关系时可以提前调用。
+         *
+         * @return 返回测试是否已经超时。
+         */
+        bool finish() {
+            if (entry != nullptr && elapsedTime == 0)
+            {
+                entry->transition(WatchEntry::DONE);
+                elapsedTime = Watchdog::now() - entry->start;
+            }
+            return timedOut();
+        }
+
+        /// @brief 测试是否已经超时。
+        bool timedOut() const { return entry != nullptr && entry->state.load(std::memory_order_acquire) == WatchEntry::EXPIRED; }
+
+        /// @brief 自开始以来经过的时间（纳秒），结束监视后固定为结束时的值。
+        uint64_t elapsed() const {
+            if (entry == nullptr)
+            {
+                return 0;
+            }
+            return elapsedTime != 0 ? elapsedTime : Watchdog::now() - entry->start;
+        }
+
+        /// @brief 测试的时间预算（纳秒），未设置时为 0。
+        uint64_t budget() const { return entry == nullptr ? 0 : entry->deadline - entry->start; }
+
+        /// @brief 超时信息，例如 "Timed out after 1.200000 s (budget 1 s)"。
+        std::string describe() const { return "Timed out after " + formatTime(elapsed()) + " (budget " + formatTime(budget()) + ")"; }
+
+    private:
+        std::shared_ptr<WatchEntry> entry;
+        uint64_t elapsedTime = 0;
+        std::optional<TestContext::Scope> scope;
+    };
+
+    /// @brief 全局唯一的看门狗。
+    static Watchdog& instance() {
+        static Watchdog watchdog;
+        return watchdog;
+    }
+
+    ~Watchdog() {
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            stopping = true;
+        }
+        wakeUp.notify_all();
+        if (worker.joinable())
+        {
+            worker.join();
+        }
+    }
+
+    /// @brief 设置每个叶子测试的时间预算。
+    void setLeafBudget(std::chrono::nanoseconds budget) { setBudget(leafBudget, budget); }
+
+    /// @brief 设置每个容器的时间预算。
+    void setContainerBudget(std::chrono::nanoseconds budget) { setBudget(containerBudget, budget); }
+
+    /// @brief 设置整次运行的时间预算，从调用此函数时开始计算。
+    void setRunBudget(std::chrono::nanoseconds budget) {
+        auto entry = std::make_shared<WatchEntry>();
+        entry->token = runToken;
+        entry->start = now();
+        entry->deadline = entry->start + static_cast<uint64_t>(budget.count());
+        entry->label = "the whole run";
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            if (runEntry != nullptr)
+            {
+                runEntry->transition(WatchEntry::DONE);
+            }
+            runEntry = budget.count() > 0 ? entry : nullptr;
+        }
+        if (budget.count() > 0)
+        {
+            enabled.store(true, std::memory_order_relaxed);
+            watch(entry);
+        }
+    }
+
+    /// @brief 是否设置了任意一项预算。
+    bool isEnabled() const { return enabled.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief 当前线程是否应当停止调度新的测试。
+     *
+     * 当前容器或整次运行超出预算时返回 true。未启用时只有一次原子读取。
+     */
+    static bool shouldStop() {
+        Watchdog& watchdog = instance();
+        return watchdog.isEnabled() && (watchdog.runToken.isCancelled() || TestContext::isCancelled());
+    }
+
+    /// @brief 整次运行的预算是否已经耗尽。
+    bool runExhausted() const { return runToken.isCancelled(); }
+
+    /**
+     * @brief 在 fork 出的子进程中停用看门狗。
+     *
+     * 子进程中没有看门狗线程，父进程中被其他线程持有的锁也不会被释放，因此重新构造锁和线程句柄并停用看门狗。
+     * 子进程中的测试由父进程中的看门狗负责监视。
+     */
+    void abandonAfterFork() {
+        new (&lock) std::mutex();
+        new (&wakeUp) std::condition_variable();
+        new (&worker) std::thread();
+        new (&wheel) std::unique_ptr<TimingWheel>();
+        enabled.store(false, std::memory_order_relaxed);
+        stopping = true;
+    }
+
+    /// @brief 当前时间（`steady_clock` 纳秒）。
+    static uint64_t now() {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+
+private:
+    Watchdog() { runToken = CancellationToken().child(); }
+
+    std::atomic<bool> enabled{false};
+    std::atomic<uint64_t> leafBudget{0};
+    std::atomic<uint64_t> containerBudget{0};
+
+    /// @brief 整次运行的取消标记，是所有测试的取消标记的最上一级。
+    CancellationToken runToken;
+    std::shared_ptr<WatchEntry> runEntry;
+
+    std::mutex lock;
+    std::condition_variable wakeUp;
+    std::thread worker;
+    std::unique_ptr<TimingWheel> wheel;
+    bool stopping = false;
+
+    void setBudget(std::atomic<uint64_t>& target, std::chrono::nanoseconds budget) {
+        target.store(budget.count() > 0 ? static_cast<uint64_t>(budget.count()) : 0, std::memory_order_relaxed);
+        if (budget.count() > 0)
+        {
+            enabled.store(true, std::memory_order_relaxed);
+        }
+    }
+
+    uint64_t budgetOf(WatchKind kind) const {
+        return (kind == WatchKind::LEAF ? leafBudget : containerBudget).load(std::memory_order_relaxed);
+    }
+
+    /// @brief 登记一个条目，第一次登记时启动看门狗线程。
+    void watch(std::shared_ptr<WatchEntry> entry) {
+        std::lock_guard<std::mutex> guard(lock);
+        if (stopping)
+        {
+            return;
+        }
+        if (wheel == nullptr)
+        {
+            wheel.reset(new TimingWheel(static_cast<uint64_t>(std::chrono::nanoseconds(TICK).count()), now()));
+        }
+        bool wasIdle = wheel->size() == 0;
+        wheel->insert(std::move(entry));
+        if (!worker.joinable())
+        {
+            worker = std::thread([this] { watchLoop(); });
+        }
+        else if (wasIdle)
+        {
+            wakeUp.notify_one();
+        }
+    }
+
+    void watchLoop() {
+        std::vector<std::shared_ptr<WatchEntry>> expired;
+        std::unique_lock<std::mutex> guard(lock);
+        while (!stopping)
+        {
+            if (wheel->size() == 0)
+            {
+                wakeUp.wait(guard);
+                continue;
+            }
+            auto next = std::chrono::steady_clock::time_point(std::chrono::nanoseconds(wheel->nextTick()));
+            wakeUp.wait_until(guard, next);
+            wheel->advance(now(), expired);
+            if (expired.empty())
+            {
+                continue;
+            }
+            guard.unlock();
+            for (const auto& entry : expired)
+            {
+                expire(*entry);
+            }
+            expired.clear();
+            guard.lock();
+        }
+    }
+
+    /// @brief 处理一个到期的条目。
+    static void expire(WatchEntry& entry) {
+        if (!entry.transition(WatchEntry::EXPIRED))
+        {
+            return;
+        }
+        entry.token.cancel();
+        if (entry.onExpire)
+        {
+            entry.onExpire();
+            return;
+        }
+        OutputSink::Block outputBlock;
+        ProgressRenderer::instance().clearLiveArea();
+        printStyledText("Watchdog: " + entry.label + " exceeded its budget of " + formatTime(entry.deadline - entry.start) + ", cancellation requested",
+                        TextColor::YELLOW, TextStyle::BOLD, true);
+    }
+};
+
+#endif
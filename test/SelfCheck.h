@@ -0,0 +1,46 @@
+#ifndef SELF_CHECK_H
+#define SELF_CHECK_H
+#include <cmath>
+#include <cstddef>
+#include <string>
+#include <StyledPrint.h>
+
+/**
+ * 自检程序共用的检查函数。
+ *
+ * 自检程序在已知的输入上检查框架中不经过示例程序就无法验证的计算（统计检验、分片划分、报告转义等），
+ * 由 ctest 执行：每个失败的检查输出一行位置和表达式，`checkExitCode()` 在有失败时返回 1。
+ */
+
+/// @brief 失败的检查数量。
+inline size_t& checkFailures() {
+    static size_t failures = 0;
+    return failures;
+}
+
+/// @brief 记录一次检查，失败时输出位置和描述。
+inline void checkCondition(bool condition, const std::string& description, const char* file, int line) {
+    if (!condition)
+    {
+        checkFailures()++;
+        printStyledText(std::string(file) + ":" + std::to_string(line) + ": check failed: " + description, TextColor::RED, TextStyle::BOLD, true);
+    }
+}
+
+/// @brief 进程的退出码，有失败的检查时输出失败的数量并返回 1。
+inline int checkExitCode(const std::string& name) {
+    if (checkFailures() != 0)
+    {
+        printStyledText(name + ": " + std::to_string(checkFailures()) + " checks failed", TextColor::RED, TextStyle::BOLD, true);
+        return 1;
+    }
+    printStyledText(name + ": all checks passed", TextColor::GREEN, TextStyle::BOLD, true);
+    return 0;
+}
+
+#define CHECK(condition) checkCondition((condition), #condition, __FILE__, __LINE__)
+
+#define CHECK_NEAR(actual, expected, tolerance) \
+    checkCondition(std::fabs((actual) - (expected)) <= (tolerance), #actual " == " #expected " (actual " + std::to_string(actual) + ")", __FILE__, __LINE__)
+
+#endif
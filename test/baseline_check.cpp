@@ -0,0 +1,81 @@
+#include "FuzzTestSchema.h"
+#include "SelfCheck.h"
+#include <cstdio>
+#include <fstream>
+#include <numeric>
+
+/**
+ * 基线比较的自检：在已知 U 值和 p 值的样本上检查 `mannWhitneyPValue` 和 `PerformanceBaseline::compare` 的结论。
+ *
+ * 参考值按带结校正和连续性校正的正态近似计算，与 R 的 `wilcox.test(exact = FALSE, correct = TRUE)` 相同。
+ */
+
+std::vector<uint64_t> range(uint64_t first, uint64_t last)
+{
+    std::vector<uint64_t> values(last - first + 1);
+    std::iota(values.begin(), values.end(), first);
+    return values;
+}
+
+int main()
+{
+    PerformanceBaseline& baseline = PerformanceBaseline::instance();
+    baseline.setThresholds(0.01, 0.05, 8);
+
+    // 相同的样本：U 等于其均值，p = 1
+    std::vector<uint64_t> same = range(1, 10);
+    CHECK_NEAR(mannWhitneyPValue(same, same), 1.0, 1e-12);
+    BaselineComparison identical = baseline.compare(same, same);
+    CHECK(identical.verdict == BaselineComparison::Verdict::UNCHANGED);
+    CHECK_NEAR(identical.relativeChange, 0.0, 1e-12);
+
+    // 全部相同的值：方差为 0，p = 1
+    std::vector<uint64_t> ties(12, 500);
+    CHECK_NEAR(mannWhitneyPValue(ties, ties), 1.0, 1e-12);
+    CHECK(baseline.compare(ties, ties).verdict == BaselineComparison::Verdict::UNCHANGED);
+
+    // 完全分开的两组：U = 100，z = 49.5 / sqrt(175)，p = 1.8267e-4
+    std::vector<uint64_t> low = range(1, 10);
+    std::vector<uint64_t> high = range(11, 20);
+    CHECK_NEAR(mannWhitneyPValue(low, high), 1.826717911e-4, 1e-12);
+    CHECK_NEAR(mannWhitneyPValue(high, low), 1.826717911e-4, 1e-12);
+    BaselineComparison slower = baseline.compare(low, high);
+    CHECK(slower.verdict == BaselineComparison::Verdict::SLOWER);
+    CHECK_NEAR(slower.relativeChange, 15.5 / 5.5 - 1, 1e-12);
+    CHECK(baseline.compare(high, low).verdict == BaselineComparison::Verdict::FASTER);
+
+    // 带结的样本：U = 56.5，结的校正项为 120，方差为 88，p = 0.010515
+    std::vector<uint64_t> tiedBaseline = {1, 2, 2, 3, 3, 3, 4, 5};
+    std::vector<uint64_t> tiedCurrent = {3, 4, 4, 5, 5, 6, 6, 7};
+    CHECK_NEAR(mannWhitneyPValue(tiedBaseline, tiedCurrent), 0.010515245936, 1e-10);
+    // p 略高于 0.01，不判定为变化
+    CHECK(baseline.compare(tiedBaseline, tiedCurrent).verdict == BaselineComparison::Verdict::UNCHANGED);
+
+    // 显著但中位数的变化低于阈值：不判定为变化
+    std::vector<uint64_t> base = range(1000, 1019);
+    std::vector<uint64_t> shifted = range(1010, 1029);
+    CHECK(mannWhitneyPValue(base, shifted) < 0.01);
+    CHECK(baseline.compare(base, shifted).verdict == BaselineComparison::Verdict::UNCHANGED);
+
+    // 样本不足
+    CHECK(baseline.compare(range(1, 7), range(11, 20)).verdict == BaselineComparison::Verdict::INSUFFICIENT);
+    CHECK_NEAR(mannWhitneyPValue({}, same), 1.0, 1e-12);
+
+    // 比较模式：observe() 中的显著变慢决定退出码
+    std::string path = "baseline_check_" + std::to_string(getpid()) + ".txt";
+    {
+        std::ofstream file(path);
+        file << "Suite.group\t10\t1 2 3 4 5 6 7 8 9 10\n";
+    }
+    baseline.compareWith(path);
+    std::remove(path.c_str());
+    CHECK(baseline.exitCode() == 0);
+    CHECK(baseline.observe("Suite.other", high).empty());
+    CHECK(baseline.observe("Suite.group", same).find("no significant change") != std::string::npos);
+    CHECK(baseline.regressionCount() == 0);
+    CHECK(baseline.observe("Suite.group", high).find("REGRESSION") != std::string::npos);
+    CHECK(baseline.regressionCount() == 1);
+    CHECK(baseline.exitCode() == 1);
+
+    return checkExitCode("baseline_check");
+}
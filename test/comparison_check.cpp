@@ -0,0 +1,67 @@
+#include "FuzzTestSchema.h"
+#include "SelfCheck.h"
+#include <cmath>
+
+/**
+ * A/B 比较汇总数据的自检：检查 `ComparisonStats` 逐层合并后的输入数量、几何平均加速比，
+ * 以及输入数量超过样本上限时置信区间的中心和宽度。
+ */
+
+int main()
+{
+    // 少量输入：全部保留，几何平均值精确
+    ComparisonStats small;
+    small.add(std::log(2.0));
+    small.add(std::log(0.5));
+    small.add(std::log(4.0));
+    CHECK(small.inputs() == 3);
+    CHECK(small.fasterInputs() == 2);
+    CHECK_NEAR(small.speedup(), std::cbrt(4.0), 1e-12);
+    ComparisonStats::Interval smallInterval = small.confidenceInterval();
+    CHECK(smallInterval.low <= small.speedup() && small.speedup() <= smallInterval.high);
+    CHECK_NEAR(small.confidenceInterval().low, smallInterval.low, 0.0);
+
+    // 空数据合并不改变结果
+    ComparisonStats unchanged = small;
+    unchanged += ComparisonStats();
+    CHECK(unchanged.inputs() == 3);
+    CHECK_NEAR(unchanged.speedup(), std::cbrt(4.0), 1e-12);
+
+    // 三层合并 200 x 100 个输入：对数加速比在 [0, 0.2) 内均匀分布，均值 0.1，标准差 0.2 / sqrt(12)
+    const size_t containers = 200;
+    const size_t leaves = 100;
+    ComparisonStats driver;
+    double sum = 0;
+    for (size_t group = 0; group < 2; group++)
+    {
+        ComparisonStats middle;
+        for (size_t c = 0; c < containers / 2; c++)
+        {
+            ComparisonStats container;
+            for (size_t leaf = 0; leaf < leaves; leaf++)
+            {
+                size_t index = (group * containers / 2 + c) * leaves + leaf;
+                double value = 0.2 * static_cast<double>((index * 7919) % 10000) / 10000.0;
+                sum += value;
+                ComparisonStats single;
+                single.add(value);
+                container += single;
+            }
+            middle += container;
+        }
+        driver += middle;
+    }
+    size_t total = containers * leaves;
+    CHECK(driver.inputs() == total);
+    CHECK(driver.fasterInputs() == total - 2);
+    CHECK_NEAR(std::log(driver.speedup()), sum / static_cast<double>(total), 1e-12);
+
+    // 区间以精确的均值为中心，半宽接近 1.96 * sigma / sqrt(n)
+    ComparisonStats::Interval interval = driver.confidenceInterval();
+    double halfWidth = 1.959964 * (0.2 / std::sqrt(12.0)) / std::sqrt(static_cast<double>(total));
+    CHECK(interval.low < driver.speedup() && driver.speedup() < interval.high);
+    CHECK_NEAR((std::log(interval.high) - std::log(interval.low)) / 2, halfWidth, halfWidth * 0.2);
+    CHECK_NEAR((std::log(interval.high) + std::log(interval.low)) / 2, std::log(driver.speedup()), halfWidth * 0.2);
+
+    return checkExitCode("ComparisonCheck");
+}
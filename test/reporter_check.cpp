@@ -0,0 +1,69 @@
+#include "FuzzTestSchema.h"
+#include "SelfCheck.h"
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+
+/**
+ * 报告转义的自检：检查 `appendJsonString` 和 `appendXmlText` 对特殊字符、控制字节和不合法的 UTF-8 的处理。
+ */
+
+/// @brief 用 append 写入 text，返回写入文件的内容。
+template <typename Append>
+std::string render(Append append, const std::string& text)
+{
+    std::string path = "reporter_check_" + std::to_string(getpid()) + ".txt";
+    {
+        BufferedWriter out(path);
+        append(out, text);
+    }
+    std::ifstream file(path, std::ios::binary);
+    std::string contents((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    std::remove(path.c_str());
+    return contents;
+}
+
+std::string json(const std::string& text)
+{
+    return render(appendJsonString, text);
+}
+
+std::string xml(const std::string& text)
+{
+    return render(appendXmlText, text);
+}
+
+int main()
+{
+    // JSON：引号、反斜杠和控制字符
+    CHECK(json("") == "\"\"");
+    CHECK(json("a\"b\\c") == "\"a\\\"b\\\\c\"");
+    CHECK(json("\n\t") == "\"\\n\\t\"");
+    CHECK(json(std::string("\x01\x1f\x7f", 3)) == "\"\\u0001\\u001f\\u007f\"");
+    CHECK(json(std::string("a\0b", 3)) == "\"a\\u0000b\"");
+
+    // JSON：合法的多字节字符原样保留
+    CHECK(json("\xe4\xb8\xad\xe6\x96\x87") == "\"\xe4\xb8\xad\xe6\x96\x87\"");
+    CHECK(json("\xf0\x9f\x98\x80") == "\"\xf0\x9f\x98\x80\"");
+
+    // JSON：不合法的 UTF-8 的每个字节替换为 U+FFFD
+    CHECK(json("\xff") == "\"\\ufffd\"");
+    CHECK(json("\xc0\xaf") == "\"\\ufffd\\ufffd\"");               // 过长编码
+    CHECK(json("\xed\xa0\x80") == "\"\\ufffd\\ufffd\\ufffd\"");    // 代理区码点
+    CHECK(json("\xf4\x90\x80\x80") == "\"\\ufffd\\ufffd\\ufffd\\ufffd\""); // 超出 U+10FFFF
+    CHECK(json("ok\xe4\xb8") == "\"ok\\ufffd\\ufffd\"");           // 截断的字符
+    CHECK(json("\x80x") == "\"\\ufffdx\"");                         // 单独的后续字节
+
+    // XML：特殊字符和换行
+    CHECK(xml("<a & \"b\">") == "&lt;a &amp; &quot;b&quot;&gt;");
+    CHECK(xml("\n\r\t") == "&#10;&#13;\t");
+
+    // XML：XML 1.0 不允许的字符和不合法的 UTF-8
+    CHECK(xml(std::string("\x01\x00", 2)) == "&#xFFFD;&#xFFFD;");
+    CHECK(xml("\xef\xbf\xbe\xef\xbf\xbf") == "&#xFFFD;&#xFFFD;");
+    CHECK(xml("\xef\xbf\xbd") == "\xef\xbf\xbd");
+    CHECK(xml("\xff\xc3") == "&#xFFFD;&#xFFFD;");
+    CHECK(xml("\xe4\xb8\xad") == "\xe4\xb8\xad");
+
+    return checkExitCode("reporter_check");
+}
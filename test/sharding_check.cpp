@@ -0,0 +1,74 @@
+#include "FuzzTestSchema.h"
+#include "SelfCheck.h"
+
+/**
+ * 分片划分的自检：与逐个调用 `owns()` 的结果比较 `ShardFilter::ownedCount` 和 `ShardFilter::leaf`，
+ * 并检查所有分片恰好把每个叶子划分一次、各个分片的数量相差不超过 1。
+ */
+
+int main()
+{
+    for (size_t count = 1; count <= 7; count++)
+    {
+        for (size_t offset = 0; offset < count; offset++)
+        {
+            for (size_t leafCount = 0; leafCount <= 30; leafCount++)
+            {
+                std::vector<size_t> owners(leafCount, 0);
+                size_t fewest = leafCount;
+                size_t most = 0;
+                for (size_t index = 0; index < count; index++)
+                {
+                    ShardFilter filter;
+                    filter.index = index;
+                    filter.count = count;
+                    filter.offset = offset;
+                    std::vector<size_t> owned;
+                    for (size_t i = 0; i < leafCount; i++)
+                    {
+                        if (filter.owns(i))
+                        {
+                            owned.push_back(i);
+                            owners[i]++;
+                        }
+                    }
+                    CHECK(filter.ownedCount(leafCount) == owned.size());
+                    for (size_t k = 0; k < owned.size(); k++)
+                    {
+                        CHECK(filter.leaf(k) == owned[k]);
+                    }
+                    fewest = std::min(fewest, owned.size());
+                    most = std::max(most, owned.size());
+                }
+                CHECK(std::all_of(owners.begin(), owners.end(), [](size_t owner) { return owner == 1; }));
+                CHECK(most - fewest <= 1);
+            }
+        }
+    }
+
+    // 划分只取决于容器名称
+    Sharding::configure(2, 5);
+    ShardFilter first = Sharding::filter("Suite.group-0");
+    CHECK(first.index == 2 && first.count == 5 && first.offset < 5);
+    CHECK(Sharding::filter("Suite.group-0").offset == first.offset);
+    CHECK(Sharding::filter("Suite.group-0").ownedCount(1000) == 200);
+
+    // 不合法的分片参数
+    bool rejected = false;
+    try
+    {
+        Sharding::configure(5, 5);
+    }
+    catch (const std::invalid_argument&)
+    {
+        rejected = true;
+    }
+    CHECK(rejected);
+
+    // 部分结果文件中字段的转义
+    std::string field = "name\twith\\tabs\nand\rlines\\";
+    CHECK(ShardFileFormat::unescape(ShardFileFormat::escape(field)) == field);
+    CHECK(ShardFileFormat::escape(field).find_first_of("\t\n\r") == std::string::npos);
+
+    return checkExitCode("sharding_check");
+}
@@ -0,0 +1,46 @@
+#include "FuzzTestSchema.h"
+
+/**
+ * 合并各个分片写入的部分结果文件，输出与在单个进程中执行时相同的汇总。
+ *
+ * 用法：FuzzTestSchemaShardMerge [--report-jsonl <文件>] [--report-junit <文件>] <部分结果文件>...
+ * 有失败的测试或缺少分片时退出码为 1。
+ */
+int main(int argc, char **argv)
+{
+    ShardMerger merger;
+    size_t loaded = 0;
+    try
+    {
+        for (int i = 1; i < argc; i++)
+        {
+            std::string argument = argv[i];
+            if (argument == "--report-jsonl" && i + 1 < argc)
+            {
+                ResultReporter::instance().writeJsonLines(argv[++i]);
+            }
+            else if (argument == "--report-junit" && i + 1 < argc)
+            {
+                ResultReporter::instance().writeJUnit(argv[++i]);
+            }
+            else
+            {
+                merger.load(argument);
+                loaded++;
+            }
+        }
+    }
+    catch (const std::exception& exception)
+    {
+        std::cerr << exception.what() << std::endl;
+        return 2;
+    }
+    if (loaded == 0)
+    {
+        std::cerr << "Usage: " << argv[0] << " [--report-jsonl <file>] [--report-junit <file>] <partial result file>..." << std::endl;
+        return 2;
+    }
+    int exitCode = merger.merge();
+    ResultReporter::instance().close();
+    return exitCode;
+}